@@ -0,0 +1,82 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file AlignedVector.hxx
+///  @brief A std::vector whose storage comes from fftwf_malloc, so it is
+///  always aligned for FFTW's SIMD code.
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <fftw3.h>
+
+namespace SoDa {
+  /**
+   * @class AlignedAllocator
+   *
+   * @brief an allocator that gets its memory from fftwf_malloc.
+   *
+   * FFTW plans are built for buffers with a particular alignment. A
+   * std::vector<std::complex<float>> is usually, but not always, aligned
+   * well enough. When it isn't, FFT::fft and FFT::ifft have to take a slower
+   * path. Buffers built with this allocator always get the fast path.
+   */
+  template<typename T>
+  class AlignedAllocator {
+  public:
+    typedef T value_type;
+
+    AlignedAllocator() noexcept { }
+    template<typename U> AlignedAllocator(const AlignedAllocator<U> &) noexcept { }
+
+    T * allocate(std::size_t n) {
+      void * ret = fftwf_malloc(n * sizeof(T));
+      if((ret == nullptr) && (n != 0)) throw std::bad_alloc();
+      return static_cast<T*>(ret);
+    }
+
+    void deallocate(T * p, std::size_t) noexcept {
+      fftwf_free(p);
+    }
+
+    template<typename U> bool operator==(const AlignedAllocator<U> &) const noexcept { return true; }
+    template<typename U> bool operator!=(const AlignedAllocator<U> &) const noexcept { return false; }
+  };
+
+  /**
+   * @brief a vector that is always aligned for FFTW's SIMD code.
+   */
+  template<typename T>
+  using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+}
@@ -0,0 +1,153 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file BlockQueue.hxx
+///  @brief A queue of finished output blocks, for the streaming
+///  (push/pull) interfaces of the block filters.
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <list>
+#include <algorithm>
+#include "AlignedVector.hxx"
+
+namespace SoDa {
+  /**
+   * @class BlockQueue
+   *
+   * @brief Output blocks waiting to be pulled.
+   *
+   * The overlap-and-save filters produce their output a block at a
+   * time, and only part of each block (from the offset for length
+   * samples, wrapping around the end of the block if need be) is good
+   * output.  Rather than copy the good part into a
+   * ring, the queue trades the filter's output buffer for an empty
+   * one of the same size.  Blocks go back on a spare list when they've
+   * been read, so a stream that is pulled as fast as it is pushed
+   * stops allocating after the first block or two. 
+   */
+  template<typename T>
+  class BlockQueue {
+  public:
+    BlockQueue() : offset(0), length(0), read_pos(0), ready_count(0) { }
+
+    /**
+     * @brief tell the queue where the good samples are in a block
+     *
+     * @param _offset index of the first good sample
+     * @param _length number of good samples in a block
+     */
+    void configure(unsigned int _offset, unsigned int _length) {
+      offset = _offset;
+      length = _length; 
+    }
+
+    /**
+     * @brief queue a finished block
+     *
+     * @param block the filter's output buffer. On return it is an
+     * unused buffer of the same size.
+     */
+    void push(AlignedVector<T> & block) {
+      push(block, offset);
+    }
+
+    /**
+     * @brief queue a finished block whose good samples don't start at
+     * the configured offset
+     *
+     * @param block the filter's output buffer. On return it is an
+     * unused buffer of the same size.
+     * @param block_offset index of the first good sample in this block
+     */
+    void push(AlignedVector<T> & block, unsigned int block_offset) {
+      if(spare.empty()) {
+	spare.emplace_back();
+      }
+      ready.splice(ready.end(), spare, spare.begin());
+      auto & b = ready.back();
+      std::swap(b.buf, block);
+      b.offset = block_offset; 
+      if(block.size() != b.buf.size()) {
+	block.resize(b.buf.size());
+      }
+      ready_count += length; 
+    }
+
+    /**
+     * @brief copy out as many samples as are ready, up to a limit
+     *
+     * @param max_count copy no more than this many samples
+     * @param copy called as copy(src, out_pos, count) for each run of
+     * count samples at src that belong at out_pos in the caller's buffer
+     * @return the number of samples copied
+     */
+    template<typename Op>
+    unsigned int pull(unsigned int max_count, Op copy) {
+      unsigned int out_pos = 0; 
+      while((out_pos < max_count) && !ready.empty()) {
+	auto & b = ready.front(); 
+	unsigned int start = (b.offset + read_pos) % b.buf.size();
+	// don't run off the end of the block
+	unsigned int count = std::min(std::min(max_count - out_pos, length - read_pos), 
+				      (unsigned int) (b.buf.size() - start));
+	copy(b.buf.data() + start, out_pos, count);
+	out_pos += count;
+	read_pos += count;
+	if(read_pos == length) {
+	  spare.splice(spare.end(), ready, ready.begin());
+	  read_pos = 0; 
+	}
+      }
+      ready_count -= out_pos; 
+      return out_pos; 
+    }
+
+    /**
+     * @brief how many samples are waiting to be pulled? 
+     */
+    unsigned int available() const { return ready_count; }
+
+  private:
+    unsigned int offset; ///< first good sample in a block
+    unsigned int length; ///< number of good samples in a block
+    unsigned int read_pos; ///< next sample to read in the first ready block
+    unsigned int ready_count; ///< samples waiting, over all ready blocks
+
+    struct Block {
+      AlignedVector<T> buf; 
+      unsigned int offset; ///< first good sample in buf
+    };
+    std::list<Block> ready; ///< blocks with samples to be read, oldest first
+    std::list<Block> spare; ///< blocks we're done with
+  };
+}
@@ -0,0 +1,255 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file ChannelSynthesizer.hxx
+///  @brief Combine equally spaced channels into one wideband stream with a polyphase filter bank
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <memory>
+#include <complex>
+#include <vector>
+#include <stdexcept>
+#include "FilterSpec.hxx"
+#include "Filter.hxx"
+#include "FFT.hxx"
+#include "AlignedVector.hxx"
+#include "Channelizer.hxx"
+
+namespace SoDa {
+
+  class ChannelSynthesizer;
+  typedef std::shared_ptr<ChannelSynthesizer> ChannelSynthesizerPtr;
+
+  /**
+   * @class ChannelSynthesizer
+   *
+   * @brief A polyphase synthesis filter bank -- the inverse of a Channelizer.
+   *
+   * Building a wideband transmit stream out of M narrowband channels
+   * the obvious way means upsampling each channel, mixing it up to its
+   * slot with an NCO, and adding them all together: M interpolating
+   * filters for every output sample. The synthesis bank does it with
+   * one prototype interpolation filter, split M ways, and one M point
+   * inverse FFT per input frame.
+   *
+   * Channel k lands at k * sample_rate / M for k < M/2 and at (k - M) *
+   * sample_rate / M for the rest, the same FFT bin order that
+   * Channelizer uses. Each channel is upsampled by D (D = M for
+   * CRITICAL, M / 2 for OVERSAMPLED_2X), filtered with the prototype
+   * g, and mixed up:
+   *
+   * x[n] = D sum_k sum_m g[n - m D] y_k[m] exp(j 2 pi k n / M)
+   *
+   * The factor of D makes up for the zeros stuffed in by upsampling, so
+   * a tone in the passband of a channel comes out at the same
+   * amplitude it went in. 
+   *
+   * The default prototype (see getPrototypeSpec) is built to pair with
+   * the default Channelizer prototype. In OVERSAMPLED_2X mode it is
+   * flat across everything the analysis prototype lets through (out to
+   * 3/4 of the channel spacing) and has rolled off by 5/4 of the
+   * channel spacing, where the first upsampling image begins. Since the
+   * analysis channels add up to one, a Channelizer followed by a
+   * ChannelSynthesizer hands back a delayed copy of its input, to
+   * within the ripple of the two prototype designs. CRITICAL mode has
+   * no room between the images for a transition band, so the
+   * reconstruction there is only approximate. 
+   */
+  class ChannelSynthesizer {
+  public:
+    class BadBufferSize : public std::runtime_error {
+    public:
+      BadBufferSize(unsigned int in, unsigned int out, unsigned int interpolation, unsigned int num_channels);
+    };
+
+    class BadChannelCount : public std::runtime_error {
+    public:
+      BadChannelCount(unsigned int num_channels, Channelizer::Mode mode);
+    };
+    
+    /**
+     * @brief constructor -- with the default prototype filter
+     *
+     * @param sample_rate the wideband output sample rate
+     * @param num_channels how many channels (M). This must be even for OVERSAMPLED_2X.
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param taps_per_channel the prototype filter is num_channels * taps_per_channel long
+     * @param window the window for the prototype filter design
+     */
+    ChannelSynthesizer(float sample_rate, unsigned int num_channels, 
+		       Channelizer::Mode mode = Channelizer::OVERSAMPLED_2X, 
+		       unsigned int taps_per_channel = 16, 
+		       Filter::WindowChoice window = Filter::HANN);
+
+    /**
+     * @brief constructor -- with a caller-supplied prototype filter
+     *
+     * @param prototype the low pass prototype (centered on 0 Hz) at the
+     * wideband sample rate, with unity gain in its passband.
+     * It is shifted so that its center tap falls D - 1 samples past a
+     * multiple of num_channels (see the Channelizer constructor), and its tap
+     * count is rounded up to a multiple of num_channels.
+     * @param num_channels how many channels (M). This must be even for OVERSAMPLED_2X.
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param window the window for the prototype filter design
+     */
+    ChannelSynthesizer(FilterSpec & prototype, unsigned int num_channels, 
+		       Channelizer::Mode mode = Channelizer::OVERSAMPLED_2X, 
+		       Filter::WindowChoice window = Filter::HANN);
+
+    /**
+     * @brief make a synthesizer with the default prototype filter
+     *
+     * @param sample_rate the wideband output sample rate
+     * @param num_channels how many channels
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param taps_per_channel the prototype filter is num_channels * taps_per_channel long
+     * @param window the window for the prototype filter design
+     * @return a shared pointer to a ChannelSynthesizer
+     */
+    static ChannelSynthesizerPtr make(float sample_rate, unsigned int num_channels, 
+				      Channelizer::Mode mode = Channelizer::OVERSAMPLED_2X, 
+				      unsigned int taps_per_channel = 16, 
+				      Filter::WindowChoice window = Filter::HANN);
+
+    /**
+     * @brief make a synthesizer with a caller-supplied prototype filter
+     *
+     * @param prototype the low pass prototype at the wideband sample rate
+     * @param num_channels how many channels
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param window the window for the prototype filter design
+     * @return a shared pointer to a ChannelSynthesizer
+     */
+    static ChannelSynthesizerPtr make(FilterSpec & prototype, unsigned int num_channels, 
+				      Channelizer::Mode mode = Channelizer::OVERSAMPLED_2X, 
+				      Filter::WindowChoice window = Filter::HANN);
+    
+    /**
+     * @brief the default prototype filter
+     *
+     * For OVERSAMPLED_2X, flat to 3/4 of the channel spacing, then a linear
+     * ramp down to zero at 5/4 of the channel spacing. For CRITICAL, the
+     * same shape as Channelizer::getPrototypeSpec.
+     *
+     * @param sample_rate the wideband sample rate
+     * @param num_channels the number of channels
+     * @param taps_per_channel the prototype is num_channels * taps_per_channel long
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @return the spec for the prototype filter
+     */
+    static FilterSpec getPrototypeSpec(float sample_rate, unsigned int num_channels, 
+				       unsigned int taps_per_channel,
+				       Channelizer::Mode mode = Channelizer::OVERSAMPLED_2X);
+    
+    /**
+     * @brief combine a block of channel samples into the wideband stream
+     *
+     * @param in the channel inputs, channel major: in[k * F + m] is
+     * sample m of channel k, where F = in.size() / num_channels is the
+     * number of input frames. This is the layout Channelizer::apply produces.
+     * @param out the wideband output. Its length must be F * getInterpolation().
+     * @return the number of input frames (samples per channel)
+     */
+    unsigned int apply(const std::vector<std::complex<float>> & in, 
+		       std::vector<std::complex<float>> & out);
+
+    /**
+     * @brief combine a block of channel samples in caller-owned memory 
+     *
+     * @param in the channel inputs, channel major
+     * @param in_length the number of samples at in -- a multiple of num_channels
+     * @param out the wideband output
+     * @param out_length the number of samples at out -- getInterpolation() * in_length / num_channels
+     * @return the number of input frames (samples per channel)
+     */
+    unsigned int apply(const std::complex<float> * in, unsigned int in_length, 
+		       std::complex<float> * out, unsigned int out_length);
+
+    /// @brief how many channels? 
+    unsigned int getNumChannels() const { return num_channels; }
+
+    /// @brief how many output samples per input frame?
+    unsigned int getInterpolation() const { return interpolation; }
+
+    /// @brief the sample rate of each channel
+    float getInputRate() const { return sample_rate / float(interpolation); }
+
+    /**
+     * @brief where does a channel go?
+     * @param k the channel number
+     * @return the center frequency of channel k (in Hz, from -sample_rate/2 to sample_rate/2)
+     */
+    float getChannelFrequency(unsigned int k) const; 
+
+    /// @brief the length of the prototype filter
+    unsigned int getTaps() const { return prototype.size(); }
+
+    /**
+     * @brief get the prototype filter
+     * @param g resized to getTaps() and filled with the prototype impulse response
+     */
+    void getPrototype(std::vector<float> & g) const { g = prototype; }
+
+    /// @brief forget the partial sums carried over from the last block
+    void clear(); 
+    
+  private:
+    void makeSynthesizer(FilterSpec & proto_spec, unsigned int num_channels, 
+			 Channelizer::Mode mode, Filter::WindowChoice window);
+    
+    float sample_rate; 
+    unsigned int num_channels;
+    unsigned int interpolation; 
+    unsigned int taps_per_channel;
+    
+    std::vector<float> prototype; ///< g[l]
+
+    /// D * g[l], as complex values. Branch p is the stretch from p * M
+    /// to (p + 1) * M, and multiplies the whole inverse FFT output of a frame.
+    AlignedVector<std::complex<float>> branches;
+
+    /// The output sums. The first getTaps() - D samples are the tail carried
+    /// over from the last block.
+    AlignedVector<std::complex<float>> accum;
+
+    AlignedVector<std::complex<float>> Z; ///< the inverse FFT inputs for a block, one frame after another
+    AlignedVector<std::complex<float>> V; ///< the inverse FFT outputs
+
+    /// exp(j 2 pi k m D / M) at the start of each frame -- there are M / D distinct frames.
+    std::vector<std::vector<std::complex<float>>> rotations;
+    uint64_t frame_count; 
+    
+    std::unique_ptr<FFT> fft; 
+  };
+}
@@ -0,0 +1,256 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file Channelizer.hxx
+///  @brief Split a wideband stream into equally spaced channels with a polyphase filter bank
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <memory>
+#include <complex>
+#include <vector>
+#include <stdexcept>
+#include "FilterSpec.hxx"
+#include "Filter.hxx"
+#include "FFT.hxx"
+#include "AlignedVector.hxx"
+
+namespace SoDa {
+
+  class Channelizer;
+  typedef std::shared_ptr<Channelizer> ChannelizerPtr;
+
+  /**
+   * @class Channelizer
+   *
+   * @brief A polyphase analysis filter bank.
+   *
+   * Splitting a stream into M channels with an NCO, an OSFilter, and a
+   * ReSampler per channel costs M filters' worth of work for every
+   * input sample. A polyphase channelizer does the same job with one
+   * prototype low pass filter, split M ways, and one M point FFT per
+   * output frame -- about (taps per channel + log M) operations per
+   * input sample, no matter how many channels there are.
+   *
+   * Channel k is centered at k * sample_rate / M for k < M/2, and at
+   * (k - M) * sample_rate / M for the rest. (That's FFT bin order.)
+   * Each channel is mixed down to baseband, filtered with the
+   * prototype, and decimated by D:
+   *
+   * y_k[m] = sum_l h[l] x[n - l] exp(-j 2 pi k (n - l) / M), n = (m + 1) D - 1
+   *
+   * That is exactly what the NCO + filter + decimate chain would produce,
+   * with the NCO phase referenced to the first input sample.
+   *
+   * - CRITICAL sampling has D = M, so each channel comes out at
+   *   sample_rate / M. Neighboring channels overlap a bit in the
+   *   prototype's transition band, and that overlap aliases. 
+   * - OVERSAMPLED_2X has D = M / 2, so each channel comes out at
+   *   2 * sample_rate / M. The transition band lands well inside the
+   *   output bandwidth, so nothing aliases. This is the mode to use
+   *   with a matching synthesis bank. 
+   *
+   * The default prototype (see getPrototypeSpec) is flat out to 1/4 of the
+   * channel spacing and rolls off linearly to zero at 3/4 of the channel
+   * spacing, so neighboring channels cross at -6 dB and their responses
+   * add up to one.
+   */
+  class Channelizer {
+  public:
+    enum Mode {
+      CRITICAL, ///< decimate by num_channels
+      OVERSAMPLED_2X ///< decimate by num_channels / 2
+    };
+
+    class BadBufferSize : public std::runtime_error {
+    public:
+      BadBufferSize(unsigned int in, unsigned int out, unsigned int decimation, unsigned int num_channels);
+    };
+
+    class BadChannelCount : public std::runtime_error {
+    public:
+      BadChannelCount(unsigned int num_channels, Mode mode);
+    };
+    
+    /**
+     * @brief constructor -- with the default prototype filter
+     *
+     * @param sample_rate the wideband input sample rate
+     * @param num_channels how many channels (M). This must be even for OVERSAMPLED_2X.
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param taps_per_channel the prototype filter is num_channels * taps_per_channel long
+     * @param window the window for the prototype filter design
+     */
+    Channelizer(float sample_rate, unsigned int num_channels, 
+		Mode mode = CRITICAL, 
+		unsigned int taps_per_channel = 16, 
+		Filter::WindowChoice window = Filter::HANN);
+
+    /**
+     * @brief constructor -- with a caller-supplied prototype filter
+     *
+     * @param prototype the low pass prototype (centered on 0 Hz) at the wideband sample rate.
+     * It is shifted so that its center tap falls on a multiple of
+     * num_channels, and its tap count is rounded up to a multiple of num_channels.
+     * @param num_channels how many channels (M). This must be even for OVERSAMPLED_2X.
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param window the window for the prototype filter design
+     */
+    Channelizer(FilterSpec & prototype, unsigned int num_channels, 
+		Mode mode = CRITICAL, 
+		Filter::WindowChoice window = Filter::HANN);
+
+    /**
+     * @brief make a channelizer with the default prototype filter
+     *
+     * @param sample_rate the wideband input sample rate
+     * @param num_channels how many channels
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param taps_per_channel the prototype filter is num_channels * taps_per_channel long
+     * @param window the window for the prototype filter design
+     * @return a shared pointer to a Channelizer
+     */
+    static ChannelizerPtr make(float sample_rate, unsigned int num_channels, 
+			       Mode mode = CRITICAL, 
+			       unsigned int taps_per_channel = 16, 
+			       Filter::WindowChoice window = Filter::HANN);
+
+    /**
+     * @brief make a channelizer with a caller-supplied prototype filter
+     *
+     * @param prototype the low pass prototype at the wideband sample rate
+     * @param num_channels how many channels
+     * @param mode CRITICAL or OVERSAMPLED_2X
+     * @param window the window for the prototype filter design
+     * @return a shared pointer to a Channelizer
+     */
+    static ChannelizerPtr make(FilterSpec & prototype, unsigned int num_channels, 
+			       Mode mode = CRITICAL, 
+			       Filter::WindowChoice window = Filter::HANN);
+    
+    /**
+     * @brief the default prototype filter
+     *
+     * Flat to 1/4 of the channel spacing, a linear ramp down to zero at 3/4
+     * of the channel spacing. The ramp is laid down one frequency bin at a
+     * time, since a FilterSpec is a staircase.
+     *
+     * @param sample_rate the wideband sample rate
+     * @param num_channels the number of channels
+     * @param taps_per_channel the prototype is num_channels * taps_per_channel long
+     * @return the spec for the prototype filter
+     */
+    static FilterSpec getPrototypeSpec(float sample_rate, unsigned int num_channels, 
+				       unsigned int taps_per_channel);
+    
+    /**
+     * @brief split a block of the wideband stream into channels
+     *
+     * @param in the wideband input. Its length must be a multiple of getDecimation()
+     * @param out the channel outputs, channel major: out[k * F + m] is
+     * sample m of channel k, where F = in.size() / getDecimation() is the
+     * number of output frames.  Its length must be num_channels * F.
+     * @return the number of output frames (samples per channel)
+     */
+    unsigned int apply(const std::vector<std::complex<float>> & in, 
+		       std::vector<std::complex<float>> & out);
+
+    /**
+     * @brief split a block of the wideband stream in caller-owned memory into channels
+     *
+     * @param in the wideband input
+     * @param in_length the number of samples at in -- a multiple of getDecimation()
+     * @param out the channel outputs, channel major
+     * @param out_length the number of samples at out -- num_channels * in_length / getDecimation()
+     * @return the number of output frames (samples per channel)
+     */
+    unsigned int apply(const std::complex<float> * in, unsigned int in_length, 
+		       std::complex<float> * out, unsigned int out_length);
+
+    /// @brief how many channels? 
+    unsigned int getNumChannels() const { return num_channels; }
+
+    /// @brief how many input samples per output frame?
+    unsigned int getDecimation() const { return decimation; }
+
+    /// @brief the sample rate of each channel
+    float getOutputRate() const { return sample_rate / float(decimation); }
+
+    /**
+     * @brief where is a channel?
+     * @param k the channel number
+     * @return the center frequency of channel k (in Hz, from -sample_rate/2 to sample_rate/2)
+     */
+    float getChannelFrequency(unsigned int k) const; 
+
+    /// @brief the length of the prototype filter
+    unsigned int getTaps() const { return prototype.size(); }
+
+    /**
+     * @brief get the prototype filter
+     * @param h resized to getTaps() and filled with the prototype impulse response
+     */
+    void getPrototype(std::vector<float> & h) const { h = prototype; }
+
+    /// @brief forget the input history
+    void clear(); 
+    
+  private:
+    void makeChannelizer(FilterSpec & proto_spec, unsigned int num_channels, 
+			 Mode mode, Filter::WindowChoice window);
+    
+    float sample_rate; 
+    unsigned int num_channels;
+    unsigned int decimation; 
+    unsigned int taps_per_channel;
+    
+    std::vector<float> prototype; ///< h[l]
+
+    /// The prototype, split into branches.  Branch p holds
+    /// h[p M + (M - 1 - r)] at r, as complex values, so that each branch
+    /// lines up with a contiguous stretch of the input history.
+    AlignedVector<std::complex<float>> branches;
+
+    /// The last getTaps() - 1 input samples, followed by the current block. 
+    AlignedVector<std::complex<float>> history;
+
+    AlignedVector<std::complex<float>> acc; ///< one frame's branch sums, reversed
+    AlignedVector<std::complex<float>> U; ///< the inverse FFT inputs for a block, interleaved by frame
+    AlignedVector<std::complex<float>> Y; ///< the inverse FFT outputs -- channel major
+
+    /// exp(-j 2 pi k n / M) at the end of each frame -- there are M / D distinct frames.
+    std::vector<std::vector<std::complex<float>>> rotations;
+    uint64_t frame_count; 
+    
+    std::unique_ptr<FFT> fft; 
+  };
+}
@@ -39,7 +39,7 @@
 ///
 ///  @file FFT.hxx
 ///  @brief General wrapper for fftw3 or whatever DFT widget we're going to use.
-///  Inspired by the numpy fft functions. Limitied to "float" types. 
+///  Inspired by the numpy fft functions. Handles float and double types. 
 ///
 ///  @author M. H. Reilly (kb1vc)
 ///  @date   Mar, 2025
@@ -49,12 +49,20 @@
 #include <vector>
 #include <fftw3.h>
 #include <stdexcept>
+#include "AlignedVector.hxx"
 
 namespace SoDa {
   /**
    * @class FFT
    *
    * @brief a low-pain, high-gain interface to the FFTW library. 
+   *
+   * FFT objects (and the Filter, OSFilter, ReSampler, and Periodogram
+   * objects built on them) may be constructed and destroyed from any number
+   * of threads at once -- all calls to the fftw planner go through a
+   * single lock. A single FFT object should only be used by one thread at
+   * a time, but separate objects (even ones that share plans) can transform
+   * in parallel. 
    */
   class FFT {
   public:
@@ -103,6 +111,12 @@ namespace SoDa {
       
     };      
 
+    /// How are the channels arranged in a buffer passed to fftBatch or ifftBatch?
+    enum BatchLayout {
+      CHANNEL_MAJOR, ///< all of channel 0, then all of channel 1, and so on.
+      INTERLEAVED  ///< sample 0 of every channel, then sample 1 of every channel, and so on.
+    };
+
     /**
      * @brief the constructor
      *
@@ -114,6 +128,18 @@ namespace SoDa {
      */
     FFT(unsigned int len, FFTOpt opt = ESTIMATE); 
 
+    /**
+     * @brief the constructor, for large transforms that should be spread across threads
+     *
+     * @param len the length of the buffer on which this FFT will operate.
+     * @param opt select how aggressive fftw will be in its attempt to
+     * optimize fft and ifft. See ::FFTOpt.
+     * @param num_threads the number of threads fftw may use for each transform.
+     * This is quietly ignored (and 1 thread is used) if the library was built
+     * without the threaded fftw library. See FFT::threadsAvailable
+     */
+    FFT(unsigned int len, FFTOpt opt, unsigned int num_threads); 
+
     /**
      * @brief Find a we-hope-is-close-to-optimal size for the operation
      * The buffer size is of the form 2^n * 3^m * 5^p * 7^q -- The factors
@@ -122,8 +148,65 @@ namespace SoDa {
      *
      * @param min_size the minimum size for the buffer
      * than min_size and that is of the form 2^n * 3^m * 5^p * 7^q
+     *
+     * If FFT::enableMeasuredSizes has been called, this returns
+     * FFT::findFastestSize(min_size) instead. 
      */
     static uint32_t findGoodSize(uint32_t min_size);
+
+    /**
+     * @brief Find the size that actually runs fastest on this machine
+     *
+     * The smallest 2^n * 3^m * 5^p * 7^q size isn't always the
+     * quickest -- a slightly larger power of two or 2^n * 3 size
+     * often beats it.  The candidates are all sizes of that form from
+     * min_size up to the next power of two.  Each candidate is timed
+     * once (see FFT::getTransformCost) and the fastest one wins. 
+     *
+     * @param min_size the minimum size for the buffer
+     * @return the fastest admissible size
+     */
+    static uint32_t findFastestSize(uint32_t min_size);
+
+    /**
+     * @brief how long does a forward transform of this length take?
+     *
+     * The answer comes from the timing table if we've seen this length
+     * before. Otherwise the transform is timed now (which takes a
+     * millisecond or so) and the result is added to the table.
+     *
+     * @param len the transform length
+     * @return nanoseconds per single precision complex forward transform
+     */
+    static double getTransformCost(uint32_t len);
+
+    /**
+     * @brief Make findGoodSize pick measured sizes rather than the smallest
+     * 2^n * 3^m * 5^p * 7^q size, and keep a per-machine timing table.
+     *
+     * OSFilter and ReSampler objects created after this call will
+     * choose their internal lengths from the timing table. Timing
+     * every candidate size is a bit slow the first time through, so
+     * new measurements are saved to the table file for the next run.
+     *
+     * @param path the timing table file. If empty, use the
+     * SODA_FFT_SIZE_COSTS environment variable, or failing that
+     * $XDG_CACHE_HOME/SoDa/fft_size_costs or ~/.cache/SoDa/fft_size_costs
+     * @return true if an existing timing table was loaded. 
+     */
+    static bool enableMeasuredSizes(const std::string & path = "");
+
+    /**
+     * @brief Go back to picking the smallest 2^n * 3^m * 5^p * 7^q size.
+     */
+    static void disableMeasuredSizes();
+
+    /**
+     * @brief are we choosing sizes from measurements?
+     *
+     * @return true if FFT::enableMeasuredSizes is in effect.
+     */
+    static bool measuredSizesEnabled(); 
     
     /**
      * @brief Perform a forward DFT.
@@ -151,6 +234,184 @@ namespace SoDa {
     void ifft(std::vector<std::complex<float>> & in, 
 	     std::vector<std::complex<float>> & out);
 
+    /**
+     * @brief Perform a forward DFT on any mix of std::vector and SoDa::AlignedVector buffers
+     *
+     * @param in the input buffer
+     * @param out the output buffer
+     *
+     * T may be float or double -- double precision buffers get
+     * fftw's double precision plans. AlignedVector buffers never need
+     * to be copied to get FFTW's SIMD alignment. Throws BadSize and
+     * UnmatchedSizes.
+     */
+    template<typename T, typename InAlloc, typename OutAlloc>
+    void fft(std::vector<std::complex<T>, InAlloc> & in, 
+	     std::vector<std::complex<T>, OutAlloc> & out) {
+      transform(true, "fft", in.data(), in.size(), out.data(), out.size());
+    }
+
+    /**
+     * @brief Perform an inverse DFT on any mix of std::vector and SoDa::AlignedVector buffers
+     *
+     * @param in the input buffer
+     * @param out the output buffer
+     *
+     * Throws BadSize and UnmatchedSizes.
+     */
+    template<typename T, typename InAlloc, typename OutAlloc>
+    void ifft(std::vector<std::complex<T>, InAlloc> & in, 
+	      std::vector<std::complex<T>, OutAlloc> & out) {
+      transform(false, "ifft", in.data(), in.size(), out.data(), out.size());
+    }
+
+    /**
+     * @brief Perform a forward DFT on a real input buffer.
+     *
+     * The DFT of a real signal is conjugate symmetric, so only the
+     * DC-and-positive-frequency half of the spectrum is computed.
+     * This takes about half the time of FFT::fft. 
+     *
+     * @param in the input buffer (length len)
+     * @param out the output buffer -- bins 0 through len/2 (length len/2 + 1)
+     *
+     * Throws BadSize if it is annoyed.
+     */
+    template<typename T, typename InAlloc, typename OutAlloc>
+    void rfft(std::vector<T, InAlloc> & in, 
+	      std::vector<std::complex<T>, OutAlloc> & out) {
+      realTransform(true, "rfft", in.data(), in.size(), out.data(), out.size());
+    }
+
+    /**
+     * @brief Perform an inverse DFT from a half spectrum to a real output buffer.
+     *
+     * @param in the input buffer -- bins 0 through len/2 (length len/2 + 1).
+     * <b>The contents of the input buffer are destroyed.</b> That's how fftw
+     * does it, and it is faster that way. 
+     * @param out the output buffer (length len)
+     *
+     * Throws BadSize if it is annoyed.
+     */
+    template<typename T, typename InAlloc, typename OutAlloc>
+    void irfft(std::vector<std::complex<T>, InAlloc> & in, 
+	       std::vector<T, OutAlloc> & out) {
+      realTransform(false, "irfft", out.data(), out.size(), in.data(), in.size());
+    }
+
+    /**
+     * @brief Perform a forward DFT on raw sample memory
+     *
+     * For samples that live in a DMA ring or a shared memory segment,
+     * where copying into a vector first would be a waste. 
+     *
+     * @param in the input samples
+     * @param out the output samples
+     * @param length the number of samples at in and at out
+     *
+     * Throws BadSize if length is not the transform length. 
+     */
+    template<typename T>
+    void fft(const std::complex<T> * in, std::complex<T> * out, unsigned int length) {
+      transform(true, "fft", in, length, out, length);
+    }
+
+    /**
+     * @brief Perform an inverse DFT on raw sample memory
+     *
+     * @param in the input samples
+     * @param out the output samples
+     * @param length the number of samples at in and at out
+     *
+     * Throws BadSize if length is not the transform length. 
+     */
+    template<typename T>
+    void ifft(std::complex<T> * in, std::complex<T> * out, unsigned int length) {
+      transform(false, "ifft", in, length, out, length);
+    }
+
+    /**
+     * @brief Perform a forward real DFT on raw sample memory
+     *
+     * @param in the input samples (length samples)
+     * @param out the output half spectrum (length / 2 + 1 bins)
+     * @param length the transform length
+     *
+     * Throws BadSize if length is not the transform length. 
+     */
+    template<typename T>
+    void rfft(const T * in, std::complex<T> * out, unsigned int length) {
+      // an out-of-place real to complex plan leaves its input alone, 
+      // so the cast is safe. 
+      realTransform(true, "rfft", const_cast<T*>(in), length, out, length / 2 + 1);
+    }
+
+    /**
+     * @brief Perform an inverse real DFT on raw sample memory
+     *
+     * @param in the input half spectrum (length / 2 + 1 bins). <b>This is destroyed.</b>
+     * @param out the output samples (length samples)
+     * @param length the transform length
+     *
+     * Throws BadSize if length is not the transform length. 
+     */
+    template<typename T>
+    void irfft(std::complex<T> * in, T * out, unsigned int length) {
+      realTransform(false, "irfft", out, length, in, length / 2 + 1);
+    }
+
+    /**
+     * @brief Perform a forward DFT on each channel of a multichannel buffer.
+     *
+     * All channels are transformed with a single fftw plan execution,
+     * which is a good deal quicker than calling fft on each
+     * channel in turn.  Interleaved buffers (as they come from many
+     * multichannel receivers) don't need to be sorted out first. 
+     *
+     * @param in the input buffer (length len * num_channels)
+     * @param out the output buffer (length len * num_channels), arranged
+     * the same way as the input buffer
+     * @param num_channels the number of channels in the buffer
+     * @param layout CHANNEL_MAJOR or INTERLEAVED
+     *
+     * Throws BadSize if it is annoyed.
+     */
+    template<typename T, typename InAlloc, typename OutAlloc>
+    void fftBatch(std::vector<std::complex<T>, InAlloc> & in, 
+		  std::vector<std::complex<T>, OutAlloc> & out, 
+		  unsigned int num_channels, 
+		  BatchLayout layout = CHANNEL_MAJOR) {
+      batchTransform(true, "fftBatch", in.data(), in.size(), out.data(), out.size(), 
+		     num_channels, layout);
+    }
+
+    /**
+     * @brief Perform an inverse DFT on each channel of a multichannel buffer.
+     *
+     * @param in the input buffer (length len * num_channels)
+     * @param out the output buffer (length len * num_channels), arranged
+     * the same way as the input buffer
+     * @param num_channels the number of channels in the buffer
+     * @param layout CHANNEL_MAJOR or INTERLEAVED
+     *
+     * Throws BadSize if it is annoyed.
+     */
+    template<typename T, typename InAlloc, typename OutAlloc>
+    void ifftBatch(std::vector<std::complex<T>, InAlloc> & in, 
+		   std::vector<std::complex<T>, OutAlloc> & out, 
+		   unsigned int num_channels, 
+		   BatchLayout layout = CHANNEL_MAJOR) {
+      batchTransform(false, "ifftBatch", in.data(), in.size(), out.data(), out.size(), 
+		     num_channels, layout);
+    }
+
+    /**
+     * @brief how long is the half spectrum produced by rfft?
+     *
+     * @return len / 2 + 1
+     */
+    unsigned int getHalfSpectrumSize() { return len / 2 + 1; }
+
     /**
      * @brief Shifts the input vector from "fft order" to "spectrum order."
      *
@@ -162,12 +423,26 @@ namespace SoDa {
      * compatible with humans (and simplifies some code) where the
      * elements run from -f_max to +f_max. 
      *
+     * in and out may be the same vector. The shift is done in place
+     * (or in a single copy pass) and allocates nothing. 
+     *
      * Throws UnmatchedSizes.
      * 
      */
     void shift(std::vector<std::complex<float>> & in, 
 	     std::vector<std::complex<float>> & out);
 
+    /**
+     * @brief Shifts a double precision vector from "fft order" to "spectrum order."
+     *
+     * @param in the input buffer
+     * @param out the output buffer
+     *
+     * Throws UnmatchedSizes.
+     */
+    void shift(std::vector<std::complex<double>> & in, 
+	       std::vector<std::complex<double>> & out);
+
     /**
      * @brief Shifts the input vector from "spectrum order" to "fft order."
      *
@@ -179,12 +454,48 @@ namespace SoDa {
      * compatible with humans (and simplifies some code) where the
      * elements run from -f_max to +f_max. 
      *
+     * in and out may be the same vector. The shift is done in place
+     * (or in a single copy pass) and allocates nothing. 
+     *
      * Throws UnmatchedSizes.
      * 
      */
     void ishift(std::vector<std::complex<float>> & in, 
 	     std::vector<std::complex<float>> & out);
 
+    /**
+     * @brief Shifts a double precision vector from "spectrum order" to "fft order."
+     *
+     * @param in the input buffer
+     * @param out the output buffer
+     *
+     * Throws UnmatchedSizes.
+     */
+    void ishift(std::vector<std::complex<double>> & in, 
+		std::vector<std::complex<double>> & out);
+
+    /**
+     * @brief Perform a forward DFT and leave the result in "spectrum order"
+     *
+     * For even lengths the shift costs nothing extra: the input is
+     * multiplied by (-1)^n on its way into the scratch buffer, which
+     * moves DC to the center bin, so the transform lands in out
+     * already shifted.  Odd lengths can't be shifted that way -- they
+     * get an fft and then an extra pass that rotates out in place.
+     * Spectrum displays and periodograms get display-ordered bins
+     * (-f_max to +f_max) directly.
+     *
+     * @param in the input buffer (in and out may be the same vector)
+     * @param out the output buffer, in spectrum order
+     *
+     * Throws BadSize and UnmatchedSizes.
+     */
+    template<typename T, typename InAlloc, typename OutAlloc>
+    void fftShifted(std::vector<std::complex<T>, InAlloc> & in, 
+		    std::vector<std::complex<T>, OutAlloc> & out) {
+      shiftedTransform("fftShifted", in.data(), in.size(), out.data(), out.size());
+    }
+
 
 
     /**
@@ -198,13 +509,395 @@ namespace SoDa {
      * @return a shared pointer to an FFT widget.
      */
     static std::shared_ptr<FFT> make(unsigned int len, FFTOpt opt = ESTIMATE); 
-    
+
+    /**
+     * @brief create a pointer to an FFT object that may use several threads
+     *
+     * @param len the length of the buffer on which this FFT will operate.
+     * @param opt select how aggressive fftw will be in its attempt to
+     * optimize fft and ifft. See ::FFTOpt.
+     * @param num_threads the number of threads fftw may use for each transform.
+     * @return a shared pointer to an FFT widget.
+     */
+    static std::shared_ptr<FFT> make(unsigned int len, FFTOpt opt, unsigned int num_threads); 
+
+    /**
+     * @brief was this library built with the threaded fftw library?
+     *
+     * @return true if FFT objects can spread a transform across several threads.
+     */
+    static bool threadsAvailable();
+
+    /**
+     * @brief Set the number of threads used by FFT objects that are created
+     * without an explicit thread count.
+     *
+     * This covers the FFTs inside Filter, OSFilter, ReSampler, and Periodogram
+     * objects created after the call. Threads only pay off for large
+     * transforms (say 2^16 points and up) -- FFTTiming T will show
+     * where the crossover is on a particular machine. 
+     *
+     * @param num_threads the number of threads. 1 means don't use threads. 
+     * @return false if threads aren't available (the setting is ignored).
+     */
+    static bool setDefaultThreads(unsigned int num_threads);
+
+    /**
+     * @brief how many threads do FFT objects get by default?
+     *
+     * @return the default thread count. See FFT::setDefaultThreads
+     */
+    static unsigned int getDefaultThreads();
+
+    /**
+     * @brief how many threads may this FFT use?
+     *
+     * @return the number of threads this FFT's plans were made for.
+     */
+    unsigned int getThreads() { return num_threads; }
+
+    /**
+     * @brief Forget all the plans in the process-wide plan cache.
+     *
+     * FFT objects that already exist keep the plans they are using. 
+     * The next FFT constructed for a given length will plan from scratch. 
+     */
+    static void clearPlanCache();
+
+    /**
+     * @brief how many plans are in the process-wide plan cache?
+     *
+     * @return the number of distinct (length, direction, option, alignment) plans. 
+     */
+    static unsigned int getPlanCacheSize();
+
+    /**
+     * @brief Import previously saved FFTW "wisdom" from a file.
+     *
+     * Wisdom is what fftw learns when it plans in MEASURE, PATIENT, or
+     * EXHAUST mode. With the right wisdom in hand, those plans take
+     * microseconds rather than seconds.  Wisdom that doesn't match this
+     * machine or fftw version is harmless -- fftw will plan from scratch.
+     *
+     * fftw keeps separate wisdom for double precision plans. That
+     * lives in a file of its own, named path + ".double". 
+     *
+     * @param path the wisdom file
+     * @return true if the file was read and accepted by fftw. false otherwise,
+     * in which case the current wisdom is unchanged.
+     */
+    static bool loadWisdom(const std::string & path);
+
+    /**
+     * @brief Save the accumulated FFTW wisdom to a file.
+     *
+     * Any wisdom already in the file is merged with ours before the
+     * file is rewritten. The new file is written to a temporary and
+     * renamed into place under an exclusive lock, so several processes
+     * may save to the same file at once.
+     *
+     * @param path the wisdom file. Missing directories are created.
+     * @return true if the wisdom was written.
+     */
+    static bool saveWisdom(const std::string & path);
+
+    /**
+     * @brief Keep a per-user wisdom cache file up to date, automatically.
+     *
+     * Loads the cache file now, and saves to it each time a new
+     * MEASURE, PATIENT, or EXHAUST plan is created.
+     *
+     * @param path the cache file.  If empty, use the file named by the
+     * SODA_FFTW_WISDOM environment variable, or failing that
+     * $XDG_CACHE_HOME/SoDa/fftwf_wisdom or ~/.cache/SoDa/fftwf_wisdom
+     * @return true if existing wisdom was loaded from the cache file.
+     */
+    static bool enableWisdomCache(const std::string & path = "");
+
+    /**
+     * @brief Stop saving new wisdom to the cache file.
+     */
+    static void disableWisdomCache();
+
+    /**
+     * @brief where would the automatic wisdom cache live?
+     *
+     * @return the path to the per-user wisdom cache file. See FFT::enableWisdomCache
+     */
+    static std::string getDefaultWisdomPath();
+
+    /**
+     * @brief where do per-user SoDa cache files go?
+     *
+     * @return $XDG_CACHE_HOME/SoDa or ~/.cache/SoDa (or a SoDa directory in
+     * the system's temporary directory if there is no HOME)
+     */
+    static std::string getCacheDirectory();
+
+    /**
+     * @brief where would the automatic timing table live?
+     *
+     * @return the path to the per-user timing table. See FFT::enableMeasuredSizes
+     */
+    static std::string getDefaultSizeCostPath();
+
+    /**
+     * @class Plan
+     *
+     * @brief a wrapper around an fftwf_plan (or fftw_plan for double
+     * precision) that destroys the plan when the last FFT object (or
+     * the plan cache) lets go of it.  There isn't much reason to use
+     * this outside of the FFT class.
+     */
+    class Plan {
+    public:
+      Plan(fftwf_plan plan) : plan(plan), dplan(nullptr) { }
+      Plan(fftw_plan dplan) : plan(nullptr), dplan(dplan) { }
+      ~Plan();
+      fftwf_plan plan; ///< single precision plan, or null
+      fftw_plan dplan; ///< double precision plan, or null
+    };
+    typedef std::shared_ptr<Plan> PlanPtr;
+
   protected:
+    /**
+     * @brief do the transform -- fft and ifft all end up here
+     *
+     * @param forward if true, do the forward transform
+     * @param who the name of the caller, for exceptions
+     * @param in the input buffer
+     * @param in_size number of elements in the input buffer
+     * @param out the output buffer
+     * @param out_size number of elements in the output buffer
+     */
+    void transform(bool forward, const char * who, 
+		   const std::complex<float> * in, size_t in_size,
+		   std::complex<float> * out, size_t out_size);
+
+    /// @brief double precision transform. See the float version
+    void transform(bool forward, const char * who, 
+		   const std::complex<double> * in, size_t in_size,
+		   std::complex<double> * out, size_t out_size);
+
+    /**
+     * @brief do a forward transform that leaves the result in spectrum order -- fftShifted ends up here
+     *
+     * @param who the name of the caller, for exceptions
+     * @param in the input buffer
+     * @param in_size number of elements in the input buffer
+     * @param out the output buffer
+     * @param out_size number of elements in the output buffer
+     */
+    void shiftedTransform(const char * who, 
+			  const std::complex<float> * in, size_t in_size,
+			  std::complex<float> * out, size_t out_size);
+
+    /// @brief double precision shifted transform. See the float version
+    void shiftedTransform(const char * who, 
+			  const std::complex<double> * in, size_t in_size,
+			  std::complex<double> * out, size_t out_size);
+
+    /**
+     * @brief do the real to complex or complex to real transform -- rfft and irfft end up here
+     *
+     * @param forward if true, do the real to complex transform (rfft)
+     * @param who the name of the caller, for exceptions
+     * @param rbuf the real (time domain) buffer
+     * @param r_size number of elements in the real buffer
+     * @param cbuf the half spectrum buffer
+     * @param c_size number of elements in the half spectrum buffer
+     */
+    void realTransform(bool forward, const char * who, 
+		       float * rbuf, size_t r_size,
+		       std::complex<float> * cbuf, size_t c_size);
+
+    /// @brief double precision real transform. See the float version
+    void realTransform(bool forward, const char * who, 
+		       double * rbuf, size_t r_size,
+		       std::complex<double> * cbuf, size_t c_size);
+
+    /**
+     * @brief transform all the channels of a multichannel buffer -- fftBatch and ifftBatch end up here
+     *
+     * @param forward if true, do the forward transform
+     * @param who the name of the caller, for exceptions
+     * @param in the input buffer
+     * @param in_size number of elements in the input buffer
+     * @param out the output buffer
+     * @param out_size number of elements in the output buffer
+     * @param num_channels the number of channels in each buffer
+     * @param layout CHANNEL_MAJOR or INTERLEAVED
+     */
+    void batchTransform(bool forward, const char * who, 
+			std::complex<float> * in, size_t in_size,
+			std::complex<float> * out, size_t out_size,
+			unsigned int num_channels, BatchLayout layout);
+
+    /// @brief double precision batch transform. See the float version
+    void batchTransform(bool forward, const char * who, 
+			std::complex<double> * in, size_t in_size,
+			std::complex<double> * out, size_t out_size,
+			unsigned int num_channels, BatchLayout layout);
+
+    /**
+     * @brief rotate a buffer left by k elements: out[i] = in[(i + k) % n]
+     *
+     * This is the guts of shift and ishift.  When in == out the rotation
+     * is done in place (a block swap for the even case) so nothing gets
+     * allocated. 
+     *
+     * @param in the input buffer
+     * @param out the output buffer (may be the same as in, but may not otherwise overlap it)
+     * @param n the length of the buffers
+     * @param k the rotation
+     */
+    static void rotate(std::complex<float> * in, std::complex<float> * out, size_t n, size_t k);
+
+    /// @brief double precision rotate. See the float version
+    static void rotate(std::complex<double> * in, std::complex<double> * out, size_t n, size_t k);
+    
+    /// the guts of both transform methods
+    template<typename T>
+    void transformT(bool forward, const char * who, 
+		    const std::complex<T> * in, size_t in_size,
+		    std::complex<T> * out, size_t out_size);
+
+    /// the guts of both shiftedTransform methods
+    template<typename T>
+    void shiftedTransformT(const char * who, 
+			   const std::complex<T> * in, size_t in_size,
+			   std::complex<T> * out, size_t out_size);
+
+    /// the guts of both realTransform methods
+    template<typename T>
+    void realTransformT(bool forward, const char * who, 
+			T * rbuf, size_t r_size,
+			std::complex<T> * cbuf, size_t c_size);
+    
+    /// the guts of both batchTransform methods
+    template<typename T>
+    void batchTransformT(bool forward, const char * who, 
+			 std::complex<T> * in, size_t in_size,
+			 std::complex<T> * out, size_t out_size,
+			 unsigned int num_channels, BatchLayout layout);
+
+    /// the kinds of plans that we keep in the plan cache
+    enum PlanKind {
+      C2C_FORWARD, ///< complex to complex forward transform
+      C2C_BACKWARD, ///< complex to complex inverse transform
+      R2C, ///< real to half-spectrum forward transform
+      C2R ///< half-spectrum to real inverse transform
+    };
+    
+    /**
+     * @brief find a plan in the process-wide cache, or create one if
+     * this is the first time we've seen this combination. 
+     *
+     * FFTW plans are expensive to create (particularly in MEASURE
+     * mode and beyond) but they may be shared by any number of FFT
+     * objects, and executed from any number of threads via the
+     * "new array" execute functions. So all FFT objects of the same
+     * length and optimization level share the same plans.
+     *
+     * T (float or double) selects the fftwf or fftw planner. 
+     *
+     * @param len the length of the transform
+     * @param kind forward or backward, complex or real
+     * @param opt the optimization level. 
+     * @param alignment the value of fftwf_alignment_of for the buffers
+     * that will be passed to the plan. Anything other than 0 gets an FFTW_UNALIGNED plan. 
+     * @param nthreads the number of threads the plan may use
+     * @param howmany the number of channels to transform in one execution (complex plans only)
+     * @param layout the arrangement of the channels when howmany is more than 1
+     * @return a shared pointer to the plan
+     */
+    template<typename T>
+    static PlanPtr getPlan(unsigned int len, PlanKind kind, FFTOpt opt, int alignment, 
+			   unsigned int nthreads, unsigned int howmany = 1, BatchLayout layout = CHANNEL_MAJOR); 
+
+    /**
+     * @brief ask fftw for a new plan. Only getPlan should call this.
+     *
+     * Holds the planner lock while fftw is planning. 
+     * The parameters are the same as for getPlan. 
+     */
+    template<typename T>
+    static PlanPtr makePlan(unsigned int len, PlanKind kind, FFTOpt opt, int alignment, 
+			    unsigned int nthreads, unsigned int howmany, BatchLayout layout); 
+
+    /**
+     * @brief find the cost of a transform length, timing it if we haven't before
+     *
+     * The timing plan comes straight from makePlan and is dropped as
+     * soon as we're done with it, so a findFastestSize search doesn't
+     * leave a plan for every candidate length in the plan cache.
+     * The caller must hold the size cost lock. 
+     *
+     * @param len the transform length
+     * @param added set to true if we timed a new length
+     * @return nanoseconds per single precision complex forward transform
+     */
+    static double lookupCost(uint32_t len, bool & added);
+
+    /**
+     * @brief pick the plan that matches the alignment of the buffers
+     *
+     * @param forward if true, find the forward plan, otherwise the backward plan
+     * @param alignment the value of fftwf_alignment_of for the in and out buffers
+     * @return the plan to use
+     */
+    template<typename T>
+    const PlanPtr & selectPlan(bool forward, int alignment); 
+
+    /**
+     * @brief read wisdom from a file -- caller must hold the planner lock
+     *
+     * @param path the wisdom file
+     * @return true if fftw accepted the wisdom
+     */
+    static bool importWisdom(const std::string & path);
+
+    /**
+     * @brief merge our wisdom into a file -- caller must hold the planner lock
+     *
+     * @param path the wisdom file
+     * @return true if the file was written
+     */
+    static bool exportWisdom(const std::string & path);
+    
+    /**
+     * @brief the plans (and scratch buffers) for one precision.
+     *
+     * Most plans are created the first time we need them. 
+     */
+    template<typename T>
+    struct PlanSet {
+      PlanPtr forward; ///< fftw maintains a "plan" that contains the optimization information. 
+      PlanPtr backward; ///< the optimization information for the reverse fft
+
+      int unaligned_alignment = 0; ///< the alignment that the unaligned plans were fetched for. 
+      PlanPtr unaligned_forward; ///< forward plan for buffers that aren't SIMD aligned. 
+      PlanPtr unaligned_backward; ///< backward plan for buffers that aren't SIMD aligned. 
+
+      PlanPtr r2c; ///< real to half spectrum plan
+      PlanPtr c2r; ///< half spectrum to real plan
+      PlanPtr unaligned_r2c; ///< real to half spectrum for buffers that aren't SIMD aligned
+      PlanPtr unaligned_c2r; ///< half spectrum to real for buffers that aren't SIMD aligned
+
+      /// bounce buffers for when the input and output buffers have different alignment
+      AlignedVector<std::complex<T>> scratch_in, scratch_out; 
+    };
+
+    /// @brief find the plan set for float or double
+    template<typename T>
+    PlanSet<T> & getPlanSet();
     
-    fftwf_plan forward_plan; ///< fftw maintains a "plan" that contains the optimization information. 
-    fftwf_plan backward_plan; ///< the optimization information for the reverse fft
+    PlanSet<float> float_plans; ///< plans for std::complex<float> buffers
+    PlanSet<double> double_plans; ///< plans for std::complex<double> buffers
     
     unsigned int len; ///< the required length for input and output operands. 
+    FFTOpt opt; ///< the optimization level we asked for. 
+    unsigned int num_threads; ///< the number of threads each transform may use
   };
 }
 
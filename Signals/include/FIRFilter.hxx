@@ -0,0 +1,339 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file FIRFilter.hxx
+///  @brief A direct form (time domain) FIR filter for short filters
+///  and small buffers.
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <memory>
+#include <complex>
+#include <vector>
+#include <stdexcept>
+#include "FilterSpec.hxx"
+#include "Filter.hxx"
+#include "AlignedVector.hxx"
+#include "StreamFilter.hxx"
+
+namespace SoDa {
+
+  class FIRFilter;
+  typedef std::shared_ptr<FIRFilter> FIRFilterPtr;
+
+  /**
+   * @class FIRFilter
+   *
+   * @brief Filter a stream by convolving it with the filter taps. 
+   *
+   * The taps are designed exactly the way Filter designs them (the
+   * window method, from a FilterSpec) but the filter runs in the time
+   * domain.  There are no transforms, so a 9 tap loop filter costs 9
+   * multiply-adds per sample rather than two FFTs per block.  The
+   * output has the same group delay as an OSFilter with the same taps.
+   *
+   * The inner loop is VectorKernels::mulAcc, one pass over the
+   * block for each tap, so it uses whatever SIMD unit the machine has.
+   *
+   * Like OSFilter, each of the four sample types (complex and real,
+   * float and double) keeps its own history, so a FIRFilter should
+   * be fed one kind of stream.  Real streams are filtered with the
+   * real part of the taps. 
+   */
+  class FIRFilter : public StreamFilter {
+  public:
+    class BadBufferSize : public std::runtime_error {
+    public:
+      BadBufferSize(const std::string & st, unsigned int in, unsigned int out, unsigned int req);
+    };
+
+    /**
+     * constructor
+     * @brief Build the filter from a filter spec
+     * 
+     * @param filter_spec object of class FilterSpec identifying corner
+     * frequencies and amplitudes. The filter has filter_spec.getTaps() taps.
+     * @param buffer_size the length of the buffers passed to apply
+     * @param gain relative magnitude of input to output in the passband     
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     */
+    FIRFilter(FilterSpec & filter_spec, 
+	      unsigned int buffer_size,
+	      float gain = 1.0, 
+	      Filter::WindowChoice window = Filter::HANN);        
+
+    /**
+     * @brief Alternate constructor, for very simple filters
+     *
+     * The number of taps is estimated from the skirt width and stop band attenuation.
+     *
+     * @param low_cutoff lower edge of the filter
+     * @param high_cutoff upper edge of the filter
+     * @param skirt width of transition band between cutoff and stopband
+     * @param sample_rate sample rate for the input stream. 
+     * @param buffer_size size of the input buffer when apply is called
+     * @param stop_band_attenuation in dB
+     * @param gain relative magnitude of input to output in the passband
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     */
+    FIRFilter(float low_cutoff, float high_cutoff, float skirt,
+	      float sample_rate, unsigned int buffer_size,
+	      float stop_band_attenuation = 60.0,
+	      float gain = 1.0,
+	      Filter::WindowChoice window = Filter::HANN);    
+
+    /**
+     * @brief run the filter on a complex input stream
+     * @param in_buf the input buffer I/Q samples (complex)
+     * @param out_buf the output buffer I/Q samples (complex) (this can be in_buf)
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<std::complex<float>> & in_buf, 
+		       std::vector<std::complex<float>> & out_buf,
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on a real input stream
+     * @param in_buf the input buffer samples
+     * @param out_buf the output buffer samples (this can be in_buf)
+     * @param gain applied to the output buffer     
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<float> & in_buf, 
+		       std::vector<float> & out_buf, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on a double precision complex input stream
+     * @param in_buf the input buffer I/Q samples (complex)
+     * @param out_buf the output buffer I/Q samples (complex)
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<std::complex<double>> & in_buf, 
+		       std::vector<std::complex<double>> & out_buf,
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on a double precision real input stream
+     * @param in_buf the input buffer samples
+     * @param out_buf the output buffer samples
+     * @param gain applied to the output buffer     
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<double> & in_buf, 
+		       std::vector<double> & out_buf, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on complex samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const std::complex<float> * in_buf, 
+		       std::complex<float> * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on real samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const float * in_buf, 
+		       float * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on double precision complex samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const std::complex<double> * in_buf, 
+		       std::complex<double> * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on double precision real samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const double * in_buf, 
+		       double * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief return the number of taps in the filter.
+     */
+    unsigned int getTaps() { return taps.size(); }
+
+    /**
+     * @brief return what the filter object believes are its lowest and highest specified frequencies
+     *
+     * @return pair containing lowest, highest specified frequencies in the filter -- more or less 
+     */
+    std::pair<float,float> getFilterEdges() { return edges; }
+
+    /**
+     * @brief get the filter taps
+     *
+     * @param h resized to the number of taps, and filled with the impulse response
+     * (h[0] multiplies the newest sample)
+     */
+    void getImpulseResponse(std::vector<std::complex<float>> & h);
+
+    /**
+     * @brief how long does one tap take? 
+     *
+     * This is measured the first time it is called (which takes a
+     * millisecond or so) and remembered after that. 
+     *
+     * @return nanoseconds per tap per complex float sample
+     */
+    static double getTapCost();
+
+    /**
+     * @brief would a direct form filter beat overlap-and-save?
+     *
+     * The direct form filter costs taps * buffer_size multiply-adds
+     * per block. Overlap-and-save costs two transforms of length
+     * FFT::findGoodSize(buffer_size + taps - 1) plus one multiply per bin. 
+     * Both are priced from measurements on this machine (getTapCost and
+     * FFT::getTransformCost) so the crossover lands where it
+     * actually is, not where a textbook says it should be.
+     *
+     * @param num_taps the length of the filter
+     * @param buffer_size the length of the buffers passed to apply
+     * @return true if a FIRFilter is the cheaper choice
+     */
+    static bool directIsFaster(unsigned int num_taps, unsigned int buffer_size);
+    
+    /**
+     * @brief Build the filter from a filter spec
+     * 
+     * @param filter_spec object of class FilterSpec identifying corner frequencies and amplitudes
+     * @param buffer_size the length of the buffers passed to apply
+     * @param gain relative magnitude of input to output in the passband     
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @return a shared pointer to a FIRFilter
+     */
+    static FIRFilterPtr make(FilterSpec & filter_spec, 
+			     unsigned int buffer_size,
+			     float gain = 1.0, 
+			     Filter::WindowChoice window = Filter::HANN);        
+
+    /**
+     * @brief Build a very simple filter
+     *
+     * @param low_cutoff lower edge of the filter
+     * @param high_cutoff upper edge of the filter
+     * @param skirt width of transition band between cutoff and stopband
+     * @param sample_rate sample rate for the input stream. 
+     * @param buffer_size size of the input buffer when apply is called
+     * @param stop_band_attenuation in dB
+     * @param gain relative magnitude of input to output in the passband
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @return a shared pointer to a FIRFilter
+     */
+    static FIRFilterPtr make(float low_cutoff, float high_cutoff, float skirt,
+			     float sample_rate, unsigned int buffer_size,
+			     float stop_band_attenuation = 60.0,
+			     float gain = 1.0,
+			     Filter::WindowChoice window = Filter::HANN);    
+
+  private:
+    void makeFIRFilter(FilterSpec & filter_spec, 
+		       unsigned int _buffer_size,
+		       float gain, 
+		       Filter::WindowChoice window);
+
+    /**
+     * @brief the guts of all the apply methods
+     *
+     * @param in_buf the input samples
+     * @param in_size the number of input samples
+     * @param out_buf the output samples
+     * @param out_size the number of output samples
+     * @param gain applied to the output buffer
+     * @param hist the history buffer for this sample type
+     * @param rtaps the taps, in reverse order, for this sample type
+     * @param st the name of the caller, for error messages
+     * @return the length of the input buffer
+     */
+    template<typename ST>
+    unsigned int applyT(const ST * in_buf, size_t in_size, 
+			ST * out_buf, size_t out_size, 
+			float gain, 
+			AlignedVector<ST> & hist,
+			const std::vector<ST> & rtaps, 
+			const std::string & st);
+
+    unsigned int buffer_size;
+    std::pair<float, float> edges; 
+
+    std::vector<std::complex<float>> taps; ///< h[0] is applied to the newest sample
+
+    // The taps in reverse order, so that y[n] = sum_j rtaps[j] * x[n - (taps - 1) + j],
+    // in each of the sample types. 
+    std::vector<std::complex<float>> rtaps;
+    std::vector<float> rtaps_real;
+    std::vector<std::complex<double>> rtaps_double;
+    std::vector<double> rtaps_real_double;
+
+    // The last taps - 1 samples of the previous block, followed by
+    // the current block.  We don't size these until we need them.
+    AlignedVector<std::complex<float>> hist;
+    AlignedVector<float> hist_real;
+    AlignedVector<std::complex<double>> hist_double;
+    AlignedVector<double> hist_real_double;
+  };
+}
@@ -46,9 +46,11 @@
 #include <iostream>
 #include <complex>
 #include <vector>
+#include <string>
 #include <fftw3.h>
 #include "FilterSpec.hxx"
 #include "FFT.hxx"
+#include "AlignedVector.hxx"
 #include <stdexcept>
 
 namespace SoDa {
@@ -98,8 +100,18 @@ namespace SoDa {
       NOWINDOW, ///< a really bad idea. Included just for experimentation
       HAMMING, ///< a classic
       HANN, ///< tight skirts (!)
-      BLACKMAN ///< good compromise
+      BLACKMAN, ///< good compromise
+      KAISER, ///< shaped to just meet the FilterSpec's stop band attenuation (see kaiserBeta)
+      EQUIRIPPLE ///< not a window: the taps come from a Parks-McClellan design (see SoDa::Remez)
     };
+
+    /**
+     * @brief which FilterSpec::estimateTaps method goes with a window?
+     *
+     * @param window the window (or design method) the filter will use
+     * @return the matching tap estimate
+     */
+    static FilterSpec::TapEstimate tapEstimate(WindowChoice window);
     
     /**
      * @brief Build the filter from a filter spec for a general filter
@@ -136,6 +148,9 @@ namespace SoDa {
     /**
      * @brief Alternate constructore where we just get the H proto
      *
+     * There are no corners in a prototype for an EQUIRIPPLE design to
+     * work from, so EQUIRIPPLE gets a KAISER window here.
+     *
      * @param H a prototype frequency domain image of the filter
      * @param buffer_size size of the input buffer when apply is called
      * @param gain relative magnitude of input to output in the passband
@@ -155,6 +170,15 @@ namespace SoDa {
 		       std::vector<std::complex<float>> & out_buf, 
 		       InOutMode in_out_mode = InOutMode(true,true));
 
+    /// run the filter on a complex input stream in aligned buffers
+    /// @param in_buf the input buffer I/Q samples (complex)
+    /// @param out_buf the output buffer I/Q samples (complex)
+    /// @param in_out_mode input or output can be time samples or frequency (FFT format) samples
+    /// @return the length of the input buffer
+    unsigned int apply(AlignedVector<std::complex<float>> & in_buf, 
+		       AlignedVector<std::complex<float>> & out_buf, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
     /// run the filter on a real input stream
     /// @param in_buf the input buffer samples
     /// @param out_buf the output buffer samples (this can overlap the in_buf vector)
@@ -166,6 +190,133 @@ namespace SoDa {
 		       std::vector<float> & out_buf, 
 		       InOutMode in_out_mode = InOutMode(true,true));
 
+    /// run the filter on a real input stream in aligned buffers
+    /// @param in_buf the input buffer samples
+    /// @param out_buf the output buffer samples (this can be the in_buf vector)
+    /// @param in_out_mode ignored -- input and output must be time-domain samples.
+    /// @return the length of the input buffer
+    unsigned int apply(AlignedVector<float> & in_buf, 
+		       AlignedVector<float> & out_buf, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on a double precision complex input stream
+    /// @param in_buf the input buffer I/Q samples (complex)
+    /// @param out_buf the output buffer I/Q samples (complex)
+    /// @param in_out_mode input or output can be time samples or frequency (FFT format) samples
+    /// @return the length of the input buffer
+    ///
+    /// The double precision filter image is built from the same impulse
+    /// response as the float image the first time one of the double
+    /// apply methods is called. 
+    unsigned int apply(std::vector<std::complex<double>> & in_buf, 
+		       std::vector<std::complex<double>> & out_buf, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on a double precision complex input stream in aligned buffers
+    /// @param in_buf the input buffer I/Q samples (complex)
+    /// @param out_buf the output buffer I/Q samples (complex)
+    /// @param in_out_mode input or output can be time samples or frequency (FFT format) samples
+    /// @return the length of the input buffer
+    unsigned int apply(AlignedVector<std::complex<double>> & in_buf, 
+		       AlignedVector<std::complex<double>> & out_buf, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on a double precision real input stream
+    /// @param in_buf the input buffer samples
+    /// @param out_buf the output buffer samples (this can overlap the in_buf vector)
+    /// @param in_out_mode ignored -- input and output must be time-domain samples.
+    /// @return the length of the input buffer
+    unsigned int apply(std::vector<double> & in_buf, 
+		       std::vector<double> & out_buf, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on a double precision real input stream in aligned buffers
+    /// @param in_buf the input buffer samples
+    /// @param out_buf the output buffer samples (this can be the in_buf vector)
+    /// @param in_out_mode ignored -- input and output must be time-domain samples.
+    /// @return the length of the input buffer
+    unsigned int apply(AlignedVector<double> & in_buf, 
+		       AlignedVector<double> & out_buf, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on complex samples in caller-owned memory (a DMA ring, shared memory...)
+    /// @param in_buf the input samples
+    /// @param out_buf the output samples
+    /// @param length the number of samples at in_buf and out_buf -- must be the buffer size
+    /// @param in_out_mode input or output can be time samples or frequency (FFT format) samples
+    /// @return the length of the input buffer
+    unsigned int apply(const std::complex<float> * in_buf, 
+		       std::complex<float> * out_buf, 
+		       unsigned int length, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on double precision complex samples in caller-owned memory
+    /// @param in_buf the input samples
+    /// @param out_buf the output samples
+    /// @param length the number of samples at in_buf and out_buf -- must be the buffer size
+    /// @param in_out_mode input or output can be time samples or frequency (FFT format) samples
+    /// @return the length of the input buffer
+    unsigned int apply(const std::complex<double> * in_buf, 
+		       std::complex<double> * out_buf, 
+		       unsigned int length, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on real samples in caller-owned memory
+    /// @param in_buf the input samples
+    /// @param out_buf the output samples
+    /// @param length the number of samples at in_buf and out_buf -- must be the buffer size
+    /// @param in_out_mode ignored -- input and output must be time-domain samples.
+    /// @return the length of the input buffer
+    unsigned int apply(const float * in_buf, 
+		       float * out_buf, 
+		       unsigned int length, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /// run the filter on double precision real samples in caller-owned memory
+    /// @param in_buf the input samples
+    /// @param out_buf the output samples
+    /// @param length the number of samples at in_buf and out_buf -- must be the buffer size
+    /// @param in_out_mode ignored -- input and output must be time-domain samples.
+    /// @return the length of the input buffer
+    unsigned int apply(const double * in_buf, 
+		       double * out_buf, 
+		       unsigned int length, 
+		       InOutMode in_out_mode = InOutMode(true,true));
+
+    /**
+     * @brief multiply a half spectrum (from FFT::rfft) by the filter image
+     *
+     * This is the frequency domain half of the real-valued apply
+     * method, for callers (like the ReSampler) that do their own
+     * real-to-complex transforms. The result should be passed through
+     * an FFT::irfft of length buffer_size.  The filter image used here is
+     * the transform of the real part of the impulse response, so the result
+     * matches what the real valued apply method would produce.
+     *
+     * @param in_buf the input half spectrum (length getHalfSpectrumSize())
+     * @param out_buf the filtered half spectrum (this can be the in_buf vector)
+     * @return the length of the input buffer
+     */
+    unsigned int applyHalfSpectrum(AlignedVector<std::complex<float>> & in_buf, 
+				   AlignedVector<std::complex<float>> & out_buf);
+
+    /**
+     * @brief multiply a double precision half spectrum by the filter image
+     *
+     * @param in_buf the input half spectrum (length getHalfSpectrumSize())
+     * @param out_buf the filtered half spectrum (this can be the in_buf vector)
+     * @return the length of the input buffer
+     */
+    unsigned int applyHalfSpectrum(AlignedVector<std::complex<double>> & in_buf, 
+				   AlignedVector<std::complex<double>> & out_buf);
+
+    /**
+     * @brief how long is the half spectrum that applyHalfSpectrum expects?
+     *
+     * @return buffer_size / 2 + 1
+     */
+    unsigned int getHalfSpectrumSize() { return buffer_size / 2 + 1; }
+
     /**
      * @brief create a hamming window to make the filter nice.
      * @param w a vector that will be multiplied by the filter image
@@ -184,12 +335,97 @@ namespace SoDa {
      */
     static void blackmanWindow(std::vector<float> & w);        
 
+    /**
+     * @brief create a double precision hamming window
+     * @param w a vector that will be multiplied by the filter image
+     */
+    static void hammingWindow(std::vector<double> & w);
+
+    /**
+     * @brief create a double precision hann window
+     * @param w a vector that will be multiplied by the filter image
+     */
+    static void hannWindow(std::vector<double> & w);
+
+    /**
+     * @brief create a double precision blackman window
+     * @param w a vector that will be multiplied by the filter image
+     */
+    static void blackmanWindow(std::vector<double> & w);        
+
+    /**
+     * @brief create a kaiser window to make the filter nice.
+     * @param w a vector that will be multiplied by the filter image
+     * @param beta the shape parameter -- bigger is a deeper stop band and a wider skirt
+     */
+    static void kaiserWindow(std::vector<float> & w, float beta);
+
+    /**
+     * @brief Kaiser's empirical formula for the window shape
+     *
+     * beta = 0.1102 (A - 8.7) for A > 50 dB,
+     * 0.5842 (A - 21)^0.4 + 0.07886 (A - 21) for 21 <= A <= 50 dB,
+     * and 0 below that.
+     *
+     * @param stop_band_attenuation_dB the attenuation (A) we want in the stop band
+     * @return beta for kaiserWindow
+     */
+    static float kaiserBeta(float stop_band_attenuation_dB);
+
+    /// A KAISER filter's prototype is sampled this many times more
+    /// finely than the filter is long. 
+    static const unsigned int KAISER_OVERSAMPLE = 8; 
+
+    
+    /**
+     * @brief Copy a filter
+     *
+     * The copy shares the original's taps and frequency image, which
+     * are never changed once the filter is built.  It gets its own
+     * scratch buffers and FFT, so the two can be used from different
+     * threads.
+     *
+     * @param other the filter to copy
+     */
+    Filter(const Filter & other);
+
+    /**
+     * @brief make another filter just like this one
+     *
+     * A bank of identical channel filters should be one filter and
+     * its clones. They all share one set of coefficients, so the
+     * memory (and cache) they take grows with the number of channels,
+     * not with the number of channels times the buffer size. 
+     *
+     * @return a shared pointer to a copy of this filter. See Filter(const Filter &)
+     */
+    std::shared_ptr<Filter> clone() { return std::make_shared<Filter>(*this); }
+
+    /**
+     * @brief do two filters share their coefficients? 
+     *
+     * @param other another filter
+     * @return true if this filter and other use the same taps and frequency image
+     */
+    bool sharesDesign(const Filter & other) { return design == other.design; }
     
     /**
      * @brief Return the lowest and highest corner frequency for this filter. 
      */
     std::pair<float, float> getFilterEdges();
 
+    /**
+     * @brief get the time domain taps of the filter
+     *
+     * These are scaled the same way as the frequency domain image, so
+     * the peak of the response is the gain passed to the constructor.
+     * A direct form (convolution) filter with these taps is the
+     * same filter, without the circular wrap. 
+     *
+     * @param taps resized to the number of taps and filled with the impulse response
+     */
+    void getImpulseResponse(std::vector<std::complex<float>> & taps);
+
     /**
      * @brief how long must an output buffer be?
      * 
@@ -198,6 +434,72 @@ namespace SoDa {
      */
     unsigned int outLenRequired(unsigned int in_size) { return in_size; }
 
+    /**
+     * @brief Forget all the designs in the process-wide design cache.
+     *
+     * Every filter built from a FilterSpec is remembered, by the
+     * contents of the spec (corners, taps, sample rate, stop band
+     * attenuation and pass band ripple) along with the window, gain,
+     * and buffer size.  The next filter built from the same recipe
+     * copies the frequency image from the cache instead of designing
+     * it again.  The cache holds the DESIGN_CACHE_LIMIT most recently
+     * used designs.  Filters that already exist are not affected.
+     */
+    static void clearDesignCache();
+
+    /**
+     * @brief how many designs are in the process-wide design cache?
+     *
+     * @return the number of distinct designs
+     */
+    static unsigned int getDesignCacheSize();
+
+    /**
+     * @brief Keep designs in a directory, so that they survive a restart.
+     *
+     * Each new design is written to a file of its own, named for the
+     * hash of its recipe, and a design that isn't in the process-wide
+     * cache is looked for there before it is built from scratch.  A
+     * file is only used if its format version is DESIGN_VERSION and
+     * its hash and recipe match the filter being built. Anything else
+     * is ignored (and replaced).
+     *
+     * @param path the directory. If empty, use the SODA_FILTER_DESIGNS
+     * environment variable, or failing that $XDG_CACHE_HOME/SoDa/filter_designs
+     * or ~/.cache/SoDa/filter_designs. Missing directories are created. 
+     * @return true if the directory exists (or could be created)
+     */
+    static bool enableDesignFiles(const std::string & path = "");
+
+    /**
+     * @brief Stop reading and writing design files.
+     */
+    static void disableDesignFiles();
+
+    /**
+     * @brief where would the design files live?
+     *
+     * @return the default design directory. See Filter::enableDesignFiles
+     */
+    static std::string getDefaultDesignPath();
+
+    /**
+     * @brief The read-only part of a filter: its taps and frequency
+     * images.  Filters built from the same recipe (see
+     * clearDesignCache), copies of a filter, and clones all share one
+     * of these.  There isn't much reason to use this outside of the
+     * Filter class.
+     */
+    struct Design;
+    typedef std::shared_ptr<const Design> DesignPtr; 
+
+    /// The design file format, and the design methods, as of this
+    /// version. Files from other versions are ignored. 
+    static const unsigned int DESIGN_VERSION = 1;
+
+    /// The process-wide design cache holds at most this many designs
+    static const unsigned int DESIGN_CACHE_LIMIT = 64; 
+    
     /**
      * @brief Create shared pointer to a filter from a filter spec for a general filter
      *
@@ -268,29 +570,171 @@ namespace SoDa {
      * @param buffer_size the impulse response and frequency image will be this long
      * @param gain passband gain (max gain) through filter
      * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN 
+     * @param stop_band_attenuation_dB sets the shape of a KAISER window
+     * @param num_taps the length of the impulse response, if it is shorter than Hproto.
+     * Zero means Hproto.size().
      * 
      */
     void makeFilter(std::vector<std::complex<float>> Hproto, 
 		    unsigned int buffer_size,
 		    float gain = 1.0, 		    
-		    WindowChoice window = HAMMING); 
+		    WindowChoice window = HAMMING,
+		    float stop_band_attenuation_dB = 60.0,
+		    unsigned int num_taps = 0); 
+
+    /** @brief the recipe for a design -- the key for the design cache
+     *
+     * @param filter_spec the filter spec
+     * @param buffer_size the length of the frequency image
+     * @param gain passband gain
+     * @param window the window (or design method)
+     * @return a string that is the same for two designs only if they would be the same
+     */
+    static std::string designKey(FilterSpec & filter_spec, 
+				 unsigned int buffer_size, 
+				 float gain, 
+				 WindowChoice window);
 
+    /** @brief look for a design in the cache, and then in the design files
+     *
+     * @param key the recipe
+     * @param buffer_size the buffer size in the recipe -- a design file
+     * whose image isn't this long is no good to us. 
+     * @return the design, or a null pointer if we don't have it
+     */
+    static DesignPtr findDesign(const std::string & key, unsigned int buffer_size); 
+
+    /** @brief put this filter's design in the cache, and the design files
+     *
+     * @param key the recipe
+     */
+    void saveDesign(const std::string & key);
+
+    /** @brief set up this filter from a saved design
+     *
+     * @param design the design
+     */
+    void useDesign(DesignPtr design);
+
+    /** @brief read a design file
+     *
+     * @param path the file
+     * @param key the recipe we're looking for
+     * @param buffer_size the buffer size in the recipe
+     * @return the design, or a null pointer if the file doesn't hold this recipe
+     */
+    static DesignPtr readDesignFile(const std::string & path, const std::string & key, 
+				    unsigned int buffer_size);
+
+    /** @brief write a design file
+     *
+     * @param path the file
+     * @param key the recipe
+     * @param design the design
+     * @return true if the file was written
+     */
+    static bool writeDesignFile(const std::string & path, const std::string & key, 
+				const Design & design);
+
+    /** @brief Build the frequency domain image from the impulse response
+     *
+     * @param taps the impulse response -- num_taps long
+     * @param gain passband gain (max gain) through filter
+     */
+    void makeImage(const std::vector<std::complex<float>> & taps, float gain); 
+
+    /** @brief the guts of the complex apply methods
+     *
+     * @param in_buf the input samples
+     * @param in_size the number of input samples
+     * @param out_buf the output samples
+     * @param out_size the number of output samples
+     * @param in_out_mode input or output can be time samples or frequency (FFT format) samples
+     * @return the length of the input buffer
+     */
+    template<typename T>
+    unsigned int applyT(const std::complex<T> * in_buf, size_t in_size, 
+			std::complex<T> * out_buf, size_t out_size, 
+			InOutMode in_out_mode); 
+
+    /** @brief the guts of the real apply methods
+     *
+     * @param in_buf the input samples
+     * @param in_size the number of input samples
+     * @param out_buf the output samples
+     * @param out_size the number of output samples
+     * @return the length of the input buffer
+     */
+    template<typename T>
+    unsigned int applyRealT(const T * in_buf, size_t in_size, 
+			    T * out_buf, size_t out_size); 
+
+    /** @brief the guts of the applyHalfSpectrum methods
+     *
+     * @param in_buf the input half spectrum
+     * @param out_buf the filtered half spectrum
+     * @return the length of the input buffer
+     */
+    template<typename T>
+    unsigned int applyHalfSpectrumT(AlignedVector<std::complex<T>> & in_buf, 
+				    AlignedVector<std::complex<T>> & out_buf);
+
+    /**
+     * @brief The frequency domain image of the filter for one sample
+     * precision. 
+     */
+    template<typename T>
+    struct Image {
+      // this is the FFT image of the filter
+      AlignedVector<std::complex<T>> H;  ///< FFT image of the filter
+      
+      /// FFT image of the real part of h, bins 0 to buffer_size/2. Used for real valued inputs. 
+      AlignedVector<std::complex<T>> H_half; 
+    };
+
+    /**
+     * @brief The scratch buffers for one sample precision. Unlike the
+     * image, these belong to just one filter. 
+     */
+    template<typename T>
+    struct Scratch {
+      ///< we need a temporary vector for the frequency domain product
+      AlignedVector<std::complex<T>> temp_buf;
 
+      ///< and a half spectrum vector if we're doing a real valued filter
+      AlignedVector<std::complex<T>> temp_half_buf;
+    };
     
-    // this is the FFT image of the filter
-    std::vector<std::complex<float>> H;  ///< FFT image of the filter
+    /** @brief fill in the H_half member of an image from its H member
+     *
+     * @param img the image to be completed
+     * @param buffer_size the length of img.H
+     */
+    template<typename T>
+    static void makeHalfImage(Image<T> & img, unsigned int buffer_size);
 
-    std::vector<std::complex<float>> h; ///< impulse response of the filter
+    /** @brief find the filter image for this precision,
+     * building it from the taps if nobody has done that yet. 
+     *
+     * @return the float or double image
+     */
+    template<typename T>
+    const Image<T> & getImage(); 
+
+    /** @brief find the scratch buffers for this precision
+     *
+     * @return the float or double scratch buffers
+     */
+    template<typename T>
+    Scratch<T> & getScratch(); 
+
+    DesignPtr design; ///< the taps and images, shared with our copies and clones
+
+    Scratch<float> float_scratch; ///< used by the float apply methods
+    Scratch<double> double_scratch; ///< used by the double apply methods
 
     ///< We need an FFT widget for the input/output transforms
     std::unique_ptr<FFT> fft; 
-    
-    ///< and we need a temporary vector for the frequency domain product
-    std::vector<std::complex<float>> temp_buf;
-
-    ///< and a two more vectors if we're doing a real valued filter
-    std::vector<std::complex<float>> temp_in_buf;
-    std::vector<std::complex<float>> temp_out_buf;        
 
     /// This is the size of the block (number of samples) that we'll operate on. 
     unsigned int buffer_size; 
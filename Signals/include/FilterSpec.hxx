@@ -181,18 +181,92 @@ namespace SoDa {
     unsigned int indexHproto(float freq); 
 
   public:
+    /// How should estimateTaps size the filter?
+    enum TapEstimate {
+      HARRIS, ///< fred harris's rule of thumb. Fine for the fixed windows (HANN, BLACKMAN...)
+      KAISER, ///< Kaiser's formula, for a Filter::KAISER window (see kaiserTaps)
+      EQUIRIPPLE ///< the shortest Parks-McClellan design that meets the spec (see SoDa::Remez)
+    };
+    
     /**
      * @brief How many taps do we need to provide the requested 
      * shortest transition edge? 
      * 
      * Estimate and set the taps as appropriate. But the 
      * number of taps must be in the range min...max
+     *
+     * The usual estimate is fred harris's rule of thumb.  If the
+     * filter will be built with a Kaiser window (Filter::KAISER) use
+     * the KAISER estimate, which comes from Kaiser's formula
+     * instead (see kaiserTaps). The Kaiser window is tuned to the stop
+     * band attenuation, so it gets there with fewer taps than a fixed
+     * window like BLACKMAN would need.
+     *
+     * An EQUIRIPPLE filter (Filter::EQUIRIPPLE) is sized by
+     * designing it: this finds the shortest filter that meets both
+     * the stop band attenuation and the pass band ripple.  That takes
+     * a handful of Remez exchange designs, so it isn't free.
+     * 
+     * Filter::tapEstimate picks the estimate that goes with a window. 
      * 
      * @param min imum number of taps provided
      * @param max imum number of taps provided
+     * @param method which estimate to use
      * @return number of taps chosen
      */
-    unsigned int estimateTaps(unsigned int min, unsigned int max); 
+    unsigned int estimateTaps(unsigned int min, unsigned int max, TapEstimate method = HARRIS); 
+
+    /**
+     * @brief Kaiser's estimate of the length of a Kaiser windowed filter
+     *
+     * taps = (A - 7.95) / (2.285 * 2 pi * transition_width / sample_rate) + 1
+     *
+     * @param sample_rate the sample rate
+     * @param transition_width the width of the window's transition band, from
+     * the passband edge to the point where the response is down by stop_band_attenuation_dB
+     * @param stop_band_attenuation_dB how far down the stop band is
+     * @return the number of taps (always odd)
+     */
+    static unsigned int kaiserTaps(float sample_rate, float transition_width, 
+				   float stop_band_attenuation_dB);
+
+    /**
+     * @brief how far down should the stop band be?
+     * @return the stop band attenuation in dB
+     */
+    float getStopBandAttenuation() { return stop_band_attenuation_dB; }
+
+    /**
+     * @brief set the stop band attenuation
+     *
+     * This affects estimateTaps, and the shape of a Kaiser window.
+     *
+     * @param dB how far down the stop band should be
+     */
+    void setStopBandAttenuation(float dB) { stop_band_attenuation_dB = dB; }
+
+    /**
+     * @brief how much may the pass band wander?
+     * @return the peak-to-peak pass band ripple in dB
+     */
+    float getPassBandRipple() { return pass_band_ripple_dB; }
+
+    /**
+     * @brief set the pass band ripple
+     *
+     * Only an EQUIRIPPLE design pays attention to this.  The window
+     * designs get a pass band as flat as their stop band is deep,
+     * whether that's needed or not.  (Defaults to 0.1 dB.)
+     *
+     * @param dB peak-to-peak ripple allowed in the pass band
+     */
+    void setPassBandRipple(float dB) { pass_band_ripple_dB = dB; }
+
+    /**
+     * @brief is this a REAL or COMPLEX filter?
+     * @return the filter type
+     */
+    FType getFilterType() { return filter_type; }
 
     /**
      * @brief set the number of taps in the filter
@@ -231,6 +305,7 @@ namespace SoDa {
     FType filter_type;
 
     float stop_band_attenuation_dB; 
+    float pass_band_ripple_dB; 
     
     std::list<Corner> spec; 
   };
@@ -116,6 +116,28 @@ namespace SoDa {
      */
     void get(std::vector<std::complex<double>> & out, SumIt sum = SET);     
 
+    /**
+     * @brief fill caller-owned memory with the next length steps of the oscillator
+     *
+     * @param out get will fill this buffer (float)
+     * @param length the number of samples to write at out
+     * @param sum if set to "ADD" the new steps will be *added* to the output, otherwise
+     * the output value will be over-written
+     *
+     */
+    void get(std::complex<float> * out, unsigned int length, SumIt sum = SET);
+
+    /**
+     * @brief fill caller-owned memory with the next length steps of the oscillator
+     *
+     * @param out get will fill this buffer (double)
+     * @param length the number of samples to write at out
+     * @param sum if set to "ADD" the new steps will be *added* to the output, otherwise
+     * the output value will be over-written
+     *
+     */
+    void get(std::complex<double> * out, unsigned int length, SumIt sum = SET);
+
     /**
      * @class FreqOutOfBounds
      *
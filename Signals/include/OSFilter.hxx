@@ -30,7 +30,7 @@
 
 ///
 ///  @file OSFilter.hxx
-///  @brief This class creates an overlap-and-save filter from a filter specification and a buffer size
+///  @brief This class creates an overlap-and-save (or overlap-and-add) filter from a filter specification and a buffer size
 ///
 ///  This scheme replaces the awful filter creation scheme in SoDaRadio versions
 ///  8.x and before. 
@@ -45,21 +45,41 @@
 #include <vector>
 #include "FilterSpec.hxx"
 #include "FFT.hxx"
+#include "AlignedVector.hxx"
+#include "BlockQueue.hxx"
 #include <stdexcept>
 #include "Filter.hxx"
+#include "StreamFilter.hxx"
 
 namespace SoDa {
 
   class OSFilter;
   typedef std::shared_ptr<OSFilter> OSFilterPtr;
   
-  class OSFilter {
+  class OSFilter : public StreamFilter {
   public:
     class BadBufferSize : public std::runtime_error {
     public:
       BadBufferSize(const std::string & st, unsigned int in, unsigned int out, unsigned int req);
     };
 
+    /**
+     * @brief How the filtered blocks are stitched into a stream. Both
+     * methods use the same filter and the same transform length. 
+     *
+     * - OVERLAP_SAVE transforms the new input along with the tail of
+     *   the input before it, and throws away the part of the output
+     *   that wrapped around.
+     * - OVERLAP_ADD transforms the new input padded with zeros, and
+     *   adds the tail of each output block into the start of the
+     *   next one.  An input block of all zeros skips the transforms,
+     *   so this is the better choice for bursty streams that are
+     *   mostly silence.  SoDaBench compares the two. 
+     */
+    enum Method {
+      OVERLAP_SAVE, ///< save the input overlap, discard the wrapped output
+      OVERLAP_ADD ///< pad the input, add the output overlap
+    };
 
 
     /**
@@ -70,11 +90,13 @@ namespace SoDa {
      * @param buffer_size the impulse response and frequency image will be this long
      * @param gain relative magnitude of input to output in the passband     
      * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @param method OVERLAP_SAVE or OVERLAP_ADD
      */
     OSFilter(FilterSpec & filter_spec, 
 	     unsigned int buffer_size,
 	     float gain = 1.0, 
-	     Filter::WindowChoice window = Filter::HANN);        
+	     Filter::WindowChoice window = Filter::HANN,
+	     Method method = OVERLAP_SAVE);        
 
     /**
      * @brief Alternate constructor, for very simple filters
@@ -87,12 +109,14 @@ namespace SoDa {
      * @param stop_band_attenuation in dB
      * @param gain relative magnitude of input to output in the passband
      * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @param method OVERLAP_SAVE or OVERLAP_ADD
      */
     OSFilter(float low_cutoff, float high_cutoff, float skirt,
 	     float sample_rate, unsigned int buffer_size,
 	     float stop_band_attenuation = 60.0,
 	     float gain = 1.0,
-	     Filter::WindowChoice window = Filter::HANN);    
+	     Filter::WindowChoice window = Filter::HANN,
+	     Method method = OVERLAP_SAVE);    
 
     /**
      * @brief Some subclasses of OSFilter don't have much to say
@@ -120,17 +144,149 @@ namespace SoDa {
      * @param out_buf the output buffer samples (this can overlap the in_buf vector)
      * @param gain applied to the output buffer     
      *
+     * Real inputs are filtered with real-to-complex transforms, which
+     * take about half the work of the complex path.  The real and complex
+     * apply methods keep separate overlap state, so a single OSFilter
+     * should be fed one kind of stream or the other, not both. 
+     *
      * Throws OSFilter::BadRealOSFilter if the original filter spec was not "real"
      */
     unsigned int apply(std::vector<float> & in_buf, 
 		       std::vector<float> & out_buf, 
 		       float gain = 1.0);
 
+    /**
+     * @brief run the filter on a double precision complex input stream
+     * @param in_buf the input buffer I/Q samples (complex)
+     * @param out_buf the output buffer I/Q samples (complex)
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     *
+     * Like the real path, the double precision paths keep their own
+     * overlap state. 
+     */
+    unsigned int apply(std::vector<std::complex<double>> & in_buf, 
+		       std::vector<std::complex<double>> & out_buf,
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on a double precision real input stream
+     * @param in_buf the input buffer samples
+     * @param out_buf the output buffer samples (this can overlap the in_buf vector)
+     * @param gain applied to the output buffer     
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<double> & in_buf, 
+		       std::vector<double> & out_buf, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on complex samples in caller-owned memory
+     *
+     * The input is read in place, so samples in a DMA ring or shared
+     * memory segment don't need to be copied into a vector first. 
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const std::complex<float> * in_buf, 
+		       std::complex<float> * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on real samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const float * in_buf, 
+		       float * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on double precision complex samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const std::complex<double> * in_buf, 
+		       std::complex<double> * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on double precision real samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const double * in_buf, 
+		       double * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+
+    /**
+     * @brief feed any number of complex samples to the filter
+     *
+     * The apply methods take exactly one buffer at a time.  push and
+     * pull don't care: push copies the samples straight into the
+     * overlap buffer, and each time a full buffer has built up, the
+     * filter runs and the result waits for pull.  Nothing is copied
+     * that apply wouldn't copy. 
+     *
+     * The output lags the input by up to one buffer.  push and apply
+     * share the overlap, so they can be mixed, but apply throws
+     * BadBufferSize if the pushes so far don't add up to a whole
+     * number of buffers.
+     *
+     * @param in_buf the input samples
+     * @param length the number of samples at in_buf -- anything will do
+     * @return the number of samples taken (always length)
+     */
+    unsigned int push(const std::complex<float> * in_buf, unsigned int length);
+    /// @brief feed any number of real samples to the filter. See push(const std::complex<float> *, unsigned int)
+    unsigned int push(const float * in_buf, unsigned int length);
+    /// @brief feed any number of double precision complex samples to the filter. 
+    unsigned int push(const std::complex<double> * in_buf, unsigned int length);
+    /// @brief feed any number of double precision real samples to the filter. 
+    unsigned int push(const double * in_buf, unsigned int length);
 
+    /**
+     * @brief collect the complex samples that the filter has finished
+     *
+     * @param out_buf put the output samples here
+     * @param length out_buf has room for this many samples
+     * @param gain applied to the output samples
+     * @return the number of samples written to out_buf -- may be
+     * anything from 0 to length
+     */
+    unsigned int pull(std::complex<float> * out_buf, unsigned int length, float gain = 1.0);
+    /// @brief collect finished real samples. See pull(std::complex<float> *, unsigned int, float)
+    unsigned int pull(float * out_buf, unsigned int length, float gain = 1.0);
+    /// @brief collect finished double precision complex samples. 
+    unsigned int pull(std::complex<double> * out_buf, unsigned int length, float gain = 1.0);
+    /// @brief collect finished double precision real samples. 
+    unsigned int pull(double * out_buf, unsigned int length, float gain = 1.0);
+    
     /**
      * @brief return the number of taps in the filter.
      */
-    unsigned int getTaps() { return save_buf.size() + 1; }
+    unsigned int getTaps() { return num_taps; }
 
 
     /**
@@ -138,6 +294,13 @@ namespace SoDa {
      */
     unsigned int getInternalSize() { return x_augmented.size(); }
 
+    /**
+     * @brief which way does this filter stitch its blocks together? 
+     *
+     * @return OVERLAP_SAVE or OVERLAP_ADD
+     */
+    Method getMethod() { return method; }
+
     /**
      * @brief return what the filter object believes are its lowest and highest specified frequencies
      *
@@ -145,6 +308,18 @@ namespace SoDa {
      */
     std::pair<float,float> getFilterEdges() { return filter_p->getFilterEdges(); }
 
+    /**
+     * @brief make another filter just like this one, for another stream
+     *
+     * The clone shares this filter's coefficients (see
+     * Filter::clone) but has its own buffers, and starts out as if no
+     * samples had been pushed through it yet.  Use this to build a
+     * bank of identical channel filters.
+     *
+     * @return a shared pointer to the new OSFilter
+     */
+    std::shared_ptr<OSFilter> clone();
+
 
     /**
      * @brief Build the filter from a filter spec for a bandpass filter
@@ -153,12 +328,14 @@ namespace SoDa {
      * @param buffer_size the impulse response and frequency image will be this long
      * @param gain relative magnitude of input to output in the passband     
      * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @param method OVERLAP_SAVE or OVERLAP_ADD
      * @return a shared pointer to an OSFilter
      */
     static std::shared_ptr<OSFilter> make(FilterSpec & filter_spec, 
 					  unsigned int buffer_size,
 					  float gain = 1.0, 
-					  Filter::WindowChoice window = Filter::HANN);        
+					  Filter::WindowChoice window = Filter::HANN,
+					  Method method = OVERLAP_SAVE);        
 
     /**
      * @brief Alternate constructor, for very simple filters
@@ -171,13 +348,15 @@ namespace SoDa {
      * @param stop_band_attenuation in dB
      * @param gain relative magnitude of input to output in the passband
      * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @param method OVERLAP_SAVE or OVERLAP_ADD
      * @return a shared pointer to an OSFilter     
      */
     static std::shared_ptr<OSFilter> make(float low_cutoff, float high_cutoff, float skirt,
 					  float sample_rate, unsigned int buffer_size,
 					  float stop_band_attenuation = 60.0,
 					  float gain = 1.0,
-					  Filter::WindowChoice window = Filter::HANN);    
+					  Filter::WindowChoice window = Filter::HANN,
+					  Method method = OVERLAP_SAVE);    
 
     
   private:
@@ -198,14 +377,133 @@ namespace SoDa {
 			   float gain = 1.0,
 			   Filter::WindowChoice window_choice = Filter::HAMMING);
     
+    /**
+     * @brief The overlap state for one sample type.  
+     *
+     * For OVERLAP_SAVE the augmented input buffer is a ring: each
+     * block's input overwrites the oldest samples, starting at
+     * write_pos, and the filtered block comes out at the same place
+     * in the augmented output buffer. 
+     *
+     * For OVERLAP_ADD the input always goes at the start of the
+     * augmented input buffer, and the rest of it stays zero. The part
+     * of each output block past buffer_size is saved in tail, to be
+     * added to the next block.
+     *
+     * The push methods accumulate input in the augmented buffer too. 
+     */
+    template<typename ST>
+    struct Stream {
+      Stream() : write_pos(0), fill(0) { }
+      unsigned int write_pos; ///< where the next block's input starts in the ring
+      unsigned int fill; ///< input samples pushed into the current block so far
+      AlignedVector<ST> tail; ///< OVERLAP_ADD only: output waiting for the next block
+      BlockQueue<ST> out; ///< finished blocks
+    };
+
+    /**
+     * @brief size the augmented buffers for a sample type the first
+     * time we see it
+     *
+     * @param xa the augmented input buffer for this sample type
+     * @param ya the augmented output buffer for this sample type
+     * @param stream the overlap state for this sample type
+     */
+    template<typename ST>
+    void initAugmented(AlignedVector<ST> & xa, AlignedVector<ST> & ya, Stream<ST> & stream);
+
+    /**
+     * @brief filter one block
+     *
+     * The input is in xa, where applyT or pushT put it. On return the
+     * filtered block (before the per-call gain) is in ya, starting at
+     * the returned index and wrapping around the end of ya, and the
+     * overlap state is ready for the next block. 
+     *
+     * @param xa the augmented input buffer for this sample type
+     * @param ya the augmented output buffer for this sample type
+     * @param stream the overlap state for this sample type
+     * @return the index of the first output sample in ya
+     */
+    template<typename ST>
+    unsigned int runBlock(AlignedVector<ST> & xa, AlignedVector<ST> & ya, Stream<ST> & stream);
+
+    /**
+     * @brief the guts of the push methods
+     *
+     * @param in_buf the input samples
+     * @param in_size the number of input samples
+     * @param xa the augmented input buffer for this sample type
+     * @param ya the augmented output buffer for this sample type
+     * @param stream the streaming state for this sample type
+     * @return in_size
+     */
+    template<typename ST>
+    unsigned int pushT(const ST * in_buf, size_t in_size, 
+		       AlignedVector<ST> & xa,
+		       AlignedVector<ST> & ya, 
+		       Stream<ST> & stream);
+
+    /**
+     * @brief the guts of the pull methods
+     *
+     * @param out_buf where the output goes
+     * @param out_size room at out_buf
+     * @param gain applied to the output
+     * @param stream the streaming state for this sample type
+     * @return the number of samples written
+     */
+    template<typename ST>
+    unsigned int pullT(ST * out_buf, size_t out_size, float gain, 
+		       Stream<ST> & stream);
+    
+    /**
+     * @brief the guts of all the apply methods
+     *
+     * @param in_buf the input samples
+     * @param in_size the number of input samples
+     * @param out_buf the output samples
+     * @param out_size the number of output samples
+     * @param gain applied to the output buffer
+     * @param xa the augmented input buffer for this sample type
+     * @param ya the augmented output buffer for this sample type
+     * @param stream the ring position for this sample type
+     * @param st the name of the caller, for error messages
+     * @return the length of the input buffer
+     */
+    template<typename ST>
+    unsigned int applyT(const ST * in_buf, size_t in_size, 
+			ST * out_buf, size_t out_size, 
+			float gain, 
+			AlignedVector<ST> & xa,
+			AlignedVector<ST> & ya, 
+			Stream<ST> & stream, 
+			const std::string & st);
+    
     uint32_t buffer_size; 
+
+    Method method; ///< overlap-and-save or overlap-and-add
     
     std::unique_ptr<Filter> filter_p;
-    std::vector<std::complex<float>> real_in, real_out;     
-    std::vector<std::complex<float>> x_augmented;
-    std::vector<std::complex<float>> save_buf;
-    std::vector<std::complex<float>> y_augmented;
-    std::vector<std::complex<float>> X, Y; 
+    unsigned int num_taps; ///< the length of the filter -- the overlap is one less
+    AlignedVector<std::complex<float>> x_augmented;
+    AlignedVector<std::complex<float>> y_augmented;
+
+    // buffers for the real valued path. We don't size these until we need them. 
+    AlignedVector<float> x_real_augmented;
+    AlignedVector<float> y_real_augmented;
+
+    // and for the double precision paths. 
+    AlignedVector<std::complex<double>> x_double_augmented;
+    AlignedVector<std::complex<double>> y_double_augmented;
+    AlignedVector<double> x_real_double_augmented;
+    AlignedVector<double> y_real_double_augmented;
+
+    // streaming state for each of the sample types
+    Stream<std::complex<float>> stream; 
+    Stream<float> real_stream; 
+    Stream<std::complex<double>> double_stream; 
+    Stream<double> real_double_stream; 
   };
 }
 
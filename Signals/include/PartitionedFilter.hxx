@@ -0,0 +1,391 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file PartitionedFilter.hxx
+///  @brief A low latency FFT filter for long impulse responses:
+///  uniformly partitioned convolution with a frequency domain delay line.
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <memory>
+#include <complex>
+#include <vector>
+#include <stdexcept>
+#include "FilterSpec.hxx"
+#include "Filter.hxx"
+#include "FFT.hxx"
+#include "AlignedVector.hxx"
+#include "StreamFilter.hxx"
+
+namespace SoDa {
+
+  class PartitionedFilter;
+  typedef std::shared_ptr<PartitionedFilter> PartitionedFilterPtr;
+
+  /**
+   * @class PartitionedFilter
+   *
+   * @brief Filter a stream in small blocks with a long, sharp filter.
+   *
+   * An OSFilter can't hand back any output until it has a whole
+   * buffer's worth of input, and its transform has to be longer than
+   * the filter.  A 4000 tap filter with a narrow skirt means buffers
+   * of several thousand samples -- a tenth of a second or so at 48
+   * kS/s, which is a long time to wait in a monitoring audio path.
+   *
+   * PartitionedFilter chops the impulse response into P pieces, each
+   * as long as the buffer (B samples).  Each input block is transformed
+   * once (an N point FFT of the last N input samples, where N is the
+   * first good FFT size at or above 2B -- see FFT::findGoodSize), and
+   * the transform goes into a frequency
+   * domain delay line that holds the last P input spectra. The
+   * output spectrum is the sum over p of (the spectrum from p blocks
+   * ago) times (the transform of piece p), and one inverse transform
+   * of that sum gives B new output samples.  So the latency is one
+   * buffer, however long the filter is.
+   *
+   * The taps are designed exactly the way FIRFilter designs them (the
+   * window method, from a FilterSpec) and the output is the same as a
+   * FIRFilter's, to within rounding.  The cost per sample grows with
+   * P = taps / B, so a smaller buffer buys lower latency with more
+   * work per sample. getSampleCost estimates that trade-off for this
+   * machine.
+   *
+   * Like OSFilter, each of the four sample types (complex and real,
+   * float and double) keeps its own delay line, so a PartitionedFilter
+   * should be fed one kind of stream. Real streams are filtered with
+   * the real part of the taps, and use real transforms (FFT::rfft and
+   * FFT::irfft) so they only carry half a spectrum around.
+   */
+  class PartitionedFilter : public StreamFilter {
+  public:
+    class BadBufferSize : public std::runtime_error {
+    public:
+      BadBufferSize(const std::string & st, unsigned int in, unsigned int out, unsigned int req);
+    };
+
+    /**
+     * constructor
+     * @brief Build the filter from a filter spec
+     * 
+     * @param filter_spec object of class FilterSpec identifying corner
+     * frequencies and amplitudes. The filter has filter_spec.getTaps() taps.
+     * @param buffer_size the length of the buffers passed to apply. This is
+     * also the partition size, and the latency of the filter.
+     * @param gain relative magnitude of input to output in the passband     
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     */
+    PartitionedFilter(FilterSpec & filter_spec, 
+		      unsigned int buffer_size,
+		      float gain = 1.0, 
+		      Filter::WindowChoice window = Filter::HANN);        
+
+    /**
+     * @brief Alternate constructor, for very simple filters
+     *
+     * The number of taps is estimated from the skirt width and stop
+     * band attenuation.  Unlike OSFilter, there's no reason to hold the
+     * filter to a few hundred taps -- that's the point of partitioning it.
+     *
+     * @param low_cutoff lower edge of the filter
+     * @param high_cutoff upper edge of the filter
+     * @param skirt width of transition band between cutoff and stopband
+     * @param sample_rate sample rate for the input stream. 
+     * @param buffer_size size of the input buffer when apply is called
+     * @param stop_band_attenuation in dB
+     * @param gain relative magnitude of input to output in the passband
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     */
+    PartitionedFilter(float low_cutoff, float high_cutoff, float skirt,
+		      float sample_rate, unsigned int buffer_size,
+		      float stop_band_attenuation = 60.0,
+		      float gain = 1.0,
+		      Filter::WindowChoice window = Filter::HANN);    
+
+    /**
+     * @brief run the filter on a complex input stream
+     * @param in_buf the input buffer I/Q samples (complex)
+     * @param out_buf the output buffer I/Q samples (complex) (this can be in_buf)
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<std::complex<float>> & in_buf, 
+		       std::vector<std::complex<float>> & out_buf,
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on a real input stream
+     * @param in_buf the input buffer samples
+     * @param out_buf the output buffer samples (this can be in_buf)
+     * @param gain applied to the output buffer     
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<float> & in_buf, 
+		       std::vector<float> & out_buf, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on a double precision complex input stream
+     * @param in_buf the input buffer I/Q samples (complex)
+     * @param out_buf the output buffer I/Q samples (complex)
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<std::complex<double>> & in_buf, 
+		       std::vector<std::complex<double>> & out_buf,
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on a double precision real input stream
+     * @param in_buf the input buffer samples
+     * @param out_buf the output buffer samples
+     * @param gain applied to the output buffer     
+     * @return the length of the input buffer
+     */
+    unsigned int apply(std::vector<double> & in_buf, 
+		       std::vector<double> & out_buf, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on complex samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const std::complex<float> * in_buf, 
+		       std::complex<float> * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on real samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const float * in_buf, 
+		       float * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on double precision complex samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const std::complex<double> * in_buf, 
+		       std::complex<double> * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief run the filter on double precision real samples in caller-owned memory
+     *
+     * @param in_buf the input samples
+     * @param out_buf the output samples
+     * @param length the number of samples at in_buf and out_buf -- must be the buffer size
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    unsigned int apply(const double * in_buf, 
+		       double * out_buf,
+		       unsigned int length, 
+		       float gain = 1.0);
+
+    /**
+     * @brief return the number of taps in the filter.
+     */
+    unsigned int getTaps() { return taps.size(); }
+
+    /**
+     * @brief how many pieces is the impulse response cut into?
+     */
+    unsigned int getNumPartitions() { return num_partitions; }
+
+    /**
+     * @brief how long does an input sample wait before it shows up in the output? 
+     *
+     * @return the latency in samples (not counting the group delay of
+     * the filter itself) -- this is just the buffer size.
+     */
+    unsigned int getLatency() { return buffer_size; }
+    
+    /**
+     * @brief return what the filter object believes are its lowest and highest specified frequencies
+     *
+     * @return pair containing lowest, highest specified frequencies in the filter -- more or less 
+     */
+    std::pair<float,float> getFilterEdges() { return edges; }
+
+    /**
+     * @brief get the filter taps
+     *
+     * @param h resized to the number of taps, and filled with the impulse response
+     * (h[0] multiplies the newest sample)
+     */
+    void getImpulseResponse(std::vector<std::complex<float>> & h);
+
+    /**
+     * @brief what would a partitioned filter cost per sample?
+     *
+     * Each block costs a forward and an inverse transform of (at least)
+     * twice the buffer size, plus one multiply-add per bin for each partition.
+     * Both are priced from measurements on this machine
+     * (FFT::getTransformCost and FIRFilter::getTapCost).  Run this over
+     * a few buffer sizes to see how much throughput a shorter latency
+     * costs. 
+     *
+     * @param num_taps the length of the filter
+     * @param buffer_size the partition size
+     * @return estimated nanoseconds per complex float sample
+     */
+    static double getSampleCost(unsigned int num_taps, unsigned int buffer_size);
+    
+    /**
+     * @brief Build the filter from a filter spec
+     * 
+     * @param filter_spec object of class FilterSpec identifying corner frequencies and amplitudes
+     * @param buffer_size the length of the buffers passed to apply
+     * @param gain relative magnitude of input to output in the passband     
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @return a shared pointer to a PartitionedFilter
+     */
+    static PartitionedFilterPtr make(FilterSpec & filter_spec, 
+				     unsigned int buffer_size,
+				     float gain = 1.0, 
+				     Filter::WindowChoice window = Filter::HANN);        
+
+    /**
+     * @brief Build a very simple filter
+     *
+     * @param low_cutoff lower edge of the filter
+     * @param high_cutoff upper edge of the filter
+     * @param skirt width of transition band between cutoff and stopband
+     * @param sample_rate sample rate for the input stream. 
+     * @param buffer_size size of the input buffer when apply is called
+     * @param stop_band_attenuation in dB
+     * @param gain relative magnitude of input to output in the passband
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @return a shared pointer to a PartitionedFilter
+     */
+    static PartitionedFilterPtr make(float low_cutoff, float high_cutoff, float skirt,
+				     float sample_rate, unsigned int buffer_size,
+				     float stop_band_attenuation = 60.0,
+				     float gain = 1.0,
+				     Filter::WindowChoice window = Filter::HANN);    
+
+  private:
+    void makePartitionedFilter(FilterSpec & filter_spec, 
+			       unsigned int _buffer_size,
+			       float gain, 
+			       Filter::WindowChoice window);
+
+    /**
+     * @brief The transformed partitions and the delay line for one
+     * sample type.
+     */
+    template<typename T>
+    struct Partitions {
+      /// The transform of each piece of the impulse response, one after
+      /// the other (bins each), scaled by 1/fft_len to make up for the
+      /// unnormalized inverse transform. 
+      AlignedVector<std::complex<T>> H;
+      /// fft_len for complex streams, the half spectrum for real streams
+      unsigned int bins; 
+
+      /// The transforms of the last num_partitions input blocks, laid out like H
+      AlignedVector<std::complex<T>> fdl;
+      unsigned int newest; ///< the slot in fdl holding the newest spectrum
+
+      AlignedVector<std::complex<T>> x; ///< the last fft_len input samples
+      AlignedVector<std::complex<T>> Y; ///< the output spectrum
+      AlignedVector<std::complex<T>> y; ///< its inverse transform
+      AlignedVector<T> x_real; ///< the last fft_len input samples, for real streams
+      AlignedVector<T> y_real; ///< the inverse transform, for real streams
+    };
+
+    /**
+     * @brief transform the pieces of the impulse response and size the
+     * delay line -- the first time a sample type is used.
+     *
+     * @param parts the partitions for this sample type
+     * @param real_taps if true, use only the real part of the taps
+     */
+    template<typename T>
+    void makePartitions(Partitions<T> & parts, bool real_taps);
+    
+    /**
+     * @brief the guts of all the apply methods
+     *
+     * @param in_buf the input samples
+     * @param in_size the number of input samples
+     * @param out_buf the output samples
+     * @param out_size the number of output samples
+     * @param gain applied to the output buffer
+     * @param parts the partitions and delay line for this sample type
+     * @param st the name of the caller, for error messages
+     * @return the length of the input buffer
+     */
+    template<typename ST, typename T>
+    unsigned int applyT(const ST * in_buf, size_t in_size, 
+			ST * out_buf, size_t out_size, 
+			float gain, 
+			Partitions<T> & parts, 
+			const std::string & st);
+
+    unsigned int buffer_size;
+    unsigned int fft_len; ///< a good FFT size, at least 2 * buffer_size
+    unsigned int num_partitions; 
+    std::pair<float, float> edges; 
+
+    std::vector<std::complex<float>> taps; ///< h[0] is applied to the newest sample
+
+    // One set of partitions for each sample type. We don't build
+    // these until we need them. 
+    Partitions<float> parts;
+    Partitions<float> parts_real;
+    Partitions<double> parts_double;
+    Partitions<double> parts_real_double;
+
+    std::unique_ptr<FFT> fft; ///< fft_len points
+  };
+}
@@ -40,6 +40,7 @@
 #include <memory>
 #include "FFT.hxx"
 #include "Filter.hxx"
+#include "AlignedVector.hxx"
 
 namespace SoDa {
   class Periodogram {
@@ -75,19 +76,61 @@ namespace SoDa {
      */
     void accumulate(const std::vector<std::complex<float>> & in);
 
+    /**
+     * @brief add the spectrum of samples in caller-owned memory to the accumulated spectrum. 
+     * 
+     * @param in the input samples
+     * @param length the number of samples at in. This need not be a multiple of the segment_length
+     */
+    void accumulate(const std::complex<float> * in, unsigned int length);
+
+    /**
+     * @brief add the input buffer's spectrum to the double precision accumulator. 
+     *
+     * The windowing, transform, and accumulation are all done in double
+     * precision, so weak components far below the strongest one survive
+     * long integrations. The float and double accumulators are
+     * independent; read this one back with get(std::vector<double> &).
+     * 
+     * @param in the input vector. This need not be a multiple of the segment_length
+     */
+    void accumulate(const std::vector<std::complex<double>> & in);
+
+    /**
+     * @brief add the spectrum of samples in caller-owned memory to the
+     * double precision accumulator. 
+     * 
+     * @param in the input samples
+     * @param length the number of samples at in. This need not be a multiple of the segment_length
+     */
+    void accumulate(const std::complex<double> * in, unsigned int length);
+
     /**
      * @brief return the DC-at-center image of the accumulator
      *
      * @param res a pointer to a vector that will receive a copy of the accumulator.
      */
     void get(std::vector<float> & res) const;
+
+    /**
+     * @brief return the DC-at-center image of the double precision accumulator
+     *
+     * @param res a pointer to a vector that will receive a copy of the accumulator.
+     */
+    void get(std::vector<double> & res) const;
     
     /**
      * @brief the magitude of the accumulator may increase with each
      * accumulated segment. This returns a scale factor that will restore
      * the magnitudes to "true" levels independent of the number of accumulated segments. 
+     *
+     * The float and double accumulators count their segments
+     * separately: getScaleFactor() (or getScaleFactor<float>()) goes
+     * with get(std::vector<float> &), and getScaleFactor<double>()
+     * goes with get(std::vector<double> &).
      */
-    float getScaleFactor(); 
+    template<typename T = float>
+    T getScaleFactor(); 
 
     /**
      * @brief return the length of the buffer chunk that is consumed on each call to accumulate.
@@ -100,17 +143,48 @@ namespace SoDa {
     void clear(); 
 
   private:
+    /**
+     * @brief the save buffer and accumulator for one sample precision. 
+     * These are sized the first time we see an input of that type. 
+     */
+    template<typename T>
+    struct Work {
+      Work() : input_save_buffer_valid_count(0), accumulation_count(0) { }
+      AlignedVector<std::complex<T>> input_save_buffer;
+      uint32_t input_save_buffer_valid_count; 
+      AlignedVector<T> acc_buffer;
+      AlignedVector<std::complex<T>> fft_in_buffer;
+      AlignedVector<std::complex<T>> fft_out_buffer;        
+      std::vector<T> window; 
+      uint32_t accumulation_count;
+    };
+
+    Work<float> float_work;   ///< state for the float accumulate methods
+    Work<double> double_work; ///< state for the double accumulate methods
+
+    /// @return the working state for float or double samples
+    template<typename T>
+    Work<T> & getWork(); 
+
+    template<typename T>
+    void accumulateT(const std::complex<T> * in, unsigned int length);
+
+    template<typename T>
+    void getT(const Work<T> & w, std::vector<T> & res) const;
+
+    /// size the buffers and build the window, the first time through
+    template<typename T>
+    void initWork(Work<T> & w);
+    
+    /// zero the save buffer and accumulator for one precision
+    template<typename T>
+    void clearWork(Work<T> & w);
+    
     std::unique_ptr<FFT> fft_p;
     float alpha, beta;     
     uint32_t segment_length; 
-    std::vector<std::complex<float>> input_save_buffer;
-    uint32_t input_save_buffer_valid_count; 
-    std::vector<float> acc_buffer;
-    std::vector<std::complex<float>> fft_in_buffer;
-    std::vector<std::complex<float>> fft_out_buffer;        
-    std::vector<float> window; 
-    uint32_t accumulation_count;
-    float fft_scale; 
+    Filter::WindowChoice window_choice; 
+    double fft_scale; 
   };
 }
 
@@ -34,6 +34,8 @@
 
 #include "Filter.hxx"
 #include "FFT.hxx"
+#include "AlignedVector.hxx"
+#include "BlockQueue.hxx"
 
 namespace SoDa {
   // create pointer type
@@ -54,6 +56,11 @@ namespace SoDa {
      * @param input_sample_rate
      * @param output_sample_rate
      * @param time_span how many samples (in time) should a buffer hold? 
+     * @param window the window for the anti-aliasing filter. With KAISER, the
+     * filter length comes from Kaiser's formula for 60 dB of stop band, which
+     * is usually shorter -- and so is the overlap.  With EQUIRIPPLE the
+     * filter is the shortest Parks-McClellan design that is flat to 0.45 of
+     * the slower sample rate and 60 dB down at half of it.
      *
      * The constructor creates the temporary overlap-and-save buffers, 
      * calculates the sizes of the input and output buffers, 
@@ -63,6 +70,9 @@ namespace SoDa {
      * buffers (and the output buffer size follows from the ratio of the sample
      * rates.) These are set by the necessary overlap to provide a continuous
      * resampler. 
+     * If FFT::enableMeasuredSizes is in effect, the buffers may be made
+     * somewhat longer than the minimum, if that makes the transforms
+     * cheaper per sample on this machine.
      * 
      * The prototype for this resampler can be found in ../jupyter/ReSamplerII.ipynb
      * 
@@ -110,7 +120,8 @@ namespace SoDa {
      */
     ReSampler(float input_sample_rate,
 	      float output_sample_rate,
-	      float time_span);
+	      float time_span,
+	      Filter::WindowChoice window = Filter::HANN);
 
 
     /**
@@ -120,11 +131,13 @@ namespace SoDa {
      * @param input_sample_rate
      * @param output_sample_rate
      * @param time_span how many samples (in time) should a buffer hold? 
+     * @param window the window for the anti-aliasing filter
      *
      */ 
     static ReSamplerPtr make (float input_sample_rate,
 			      float output_sample_rate,
-			      float time_span);
+			      float time_span,
+			      Filter::WindowChoice window = Filter::HANN);
     
     /**
      * @brief take the resampler apart.
@@ -158,13 +171,127 @@ namespace SoDa {
     /**
      * @brief apply the resampler to a buffer of scalar samples.
      *
+     * Scalar buffers are resampled with real-to-complex transforms
+     * and only the half spectrum is filtered and copied.  The real and
+     * complex apply methods keep separate overlap state, so a single
+     * ReSampler should be fed one kind of stream or the other, not both. 
+     *
      * @param in input buffer
      * @param out output buffer
      */
     uint32_t apply(std::vector<float> & in,
 		   std::vector<float> & out);
 
+    /**
+     * @brief apply the resampler to a buffer of double precision IQ samples.
+     *
+     * Each sample precision keeps its own overlap state.
+     *
+     * @param in input buffer 
+     * @param out output buffer
+     */
+    uint32_t apply(std::vector<std::complex<double>> & in,
+		   std::vector<std::complex<double>> & out);
+
+    /**
+     * @brief apply the resampler to a buffer of double precision scalar samples.
+     *
+     * @param in input buffer
+     * @param out output buffer
+     */
+    uint32_t apply(std::vector<double> & in,
+		   std::vector<double> & out);
+
+    /**
+     * @brief apply the resampler to IQ samples in caller-owned memory.
+     *
+     * The input is read in place, so samples in a DMA ring or shared
+     * memory segment don't need to be copied into a vector first. 
+     *
+     * @param in input samples
+     * @param in_length number of input samples -- must be getInputBufferSize()
+     * @param out output samples
+     * @param out_length room at out -- must be getOutputBufferSize()
+     */
+    uint32_t apply(const std::complex<float> * in, unsigned int in_length, 
+		   std::complex<float> * out, unsigned int out_length);
+
+    /**
+     * @brief apply the resampler to scalar samples in caller-owned memory.
+     *
+     * @param in input samples
+     * @param in_length number of input samples -- must be getInputBufferSize()
+     * @param out output samples
+     * @param out_length room at out -- must be getOutputBufferSize()
+     */
+    uint32_t apply(const float * in, unsigned int in_length, 
+		   float * out, unsigned int out_length);
+
+    /**
+     * @brief apply the resampler to double precision IQ samples in caller-owned memory.
+     *
+     * @param in input samples
+     * @param in_length number of input samples -- must be getInputBufferSize()
+     * @param out output samples
+     * @param out_length room at out -- must be getOutputBufferSize()
+     */
+    uint32_t apply(const std::complex<double> * in, unsigned int in_length, 
+		   std::complex<double> * out, unsigned int out_length);
+
+    /**
+     * @brief apply the resampler to double precision scalar samples in caller-owned memory.
+     *
+     * @param in input samples
+     * @param in_length number of input samples -- must be getInputBufferSize()
+     * @param out output samples
+     * @param out_length room at out -- must be getOutputBufferSize()
+     */
+    uint32_t apply(const double * in, unsigned int in_length, 
+		   double * out, unsigned int out_length);
+
 
+    /**
+     * @brief feed any number of IQ samples to the resampler
+     *
+     * The apply methods take exactly getInputBufferSize() samples at
+     * a time.  push and pull don't care: push copies the samples
+     * straight into the overlap-and-save buffer, and each time a full
+     * buffer has built up, the resampler runs and the output waits
+     * for pull.  Nothing is copied that apply wouldn't copy. 
+     *
+     * push and apply share the overlap for each sample type, so they
+     * can take turns at buffer boundaries, but apply throws
+     * BadBufferSize if the pushes so far don't add up to a whole
+     * number of input buffers.
+     *
+     * @param in input samples
+     * @param in_length number of input samples -- anything will do
+     * @return the number of samples taken (always in_length)
+     */
+    uint32_t push(const std::complex<float> * in, unsigned int in_length);
+    /// @brief feed any number of scalar samples to the resampler. See push(const std::complex<float> *, unsigned int)
+    uint32_t push(const float * in, unsigned int in_length);
+    /// @brief feed any number of double precision IQ samples to the resampler.
+    uint32_t push(const std::complex<double> * in, unsigned int in_length);
+    /// @brief feed any number of double precision scalar samples to the resampler.
+    uint32_t push(const double * in, unsigned int in_length);
+
+    /**
+     * @brief collect the IQ samples that the resampler has finished
+     *
+     * @param out put the output samples here
+     * @param out_length there is room for this many samples at out
+     * @return the number of samples written to out -- may be anything
+     * from 0 to out_length
+     */
+    uint32_t pull(std::complex<float> * out, unsigned int out_length);
+    /// @brief collect finished scalar samples. See pull(std::complex<float> *, unsigned int)
+    uint32_t pull(float * out, unsigned int out_length);
+    /// @brief collect finished double precision IQ samples.
+    uint32_t pull(std::complex<double> * out, unsigned int out_length);
+    /// @brief collect finished double precision scalar samples.
+    uint32_t pull(double * out, unsigned int out_length);
+    
     /**
      * @class BadBufferSize
      *
@@ -190,7 +317,87 @@ namespace SoDa {
     uint32_t Lx; /// input full buffer length
     uint32_t Ly; /// output full buffer length
 
-    std::vector<std::complex<float>> x, X, y, Y; /// the working buffers
+    /**
+     * @brief The streaming (push/pull) state for one sample type.  The
+     * input accumulates in the x buffer that apply uses.
+     */
+    template<typename ST>
+    struct Stream {
+      Stream() : fill(0) { }
+      uint32_t fill; ///< input samples in x past the save region
+      BlockQueue<ST> out; ///< finished output blocks
+    };
+    
+    /**
+     * @brief the working buffers for one sample precision. 
+     * These are sized the first time we see an input of that type. 
+     */
+    template<typename T>
+    struct Work {
+      AlignedVector<std::complex<T>> x, X, y, Y; /// the working buffers
+
+      /// working buffers for the real valued path. 
+      AlignedVector<T> x_real, y_real;
+      AlignedVector<std::complex<T>> X_half, Y_half; 
+
+      Stream<std::complex<T>> stream; ///< push/pull state for the complex path
+      Stream<T> real_stream; ///< push/pull state for the real path
+    };
+
+    Work<float> float_work;   ///< buffers for the float apply methods
+    Work<double> double_work; ///< buffers for the double apply methods
+
+    /// @return the working buffers for float or double samples
+    template<typename T>
+    Work<T> & getWork(); 
+
+    /// size the complex working buffers, the first time through
+    template<typename T>
+    void initWork(Work<T> & w);
+
+    /// size the real working buffers, the first time through
+    template<typename T>
+    void initRealWork(Work<T> & w);
+
+    /// slide the end of the input buffer to the front
+    template<typename VT>
+    void shiftSave(VT & x); 
+
+    /// resample the complex input buffer w.x into w.y
+    template<typename T>
+    void runBlock(Work<T> & w);
+
+    /// resample the real input buffer w.x_real into w.y_real
+    template<typename T>
+    void runRealBlock(Work<T> & w);
+
+    /// the guts of the push methods
+    template<typename ST, typename RunBlock>
+    uint32_t pushT(const ST * in, size_t in_size, 
+		   AlignedVector<ST> & x, AlignedVector<ST> & y, 
+		   Stream<ST> & stream, RunBlock run_block);
+
+    /// push for the complex sample types
+    template<typename T>
+    uint32_t pushComplexT(const std::complex<T> * in, size_t in_size);
+
+    /// push for the real sample types
+    template<typename T>
+    uint32_t pushRealT(const T * in, size_t in_size);
+
+    /// the guts of the pull methods
+    template<typename ST>
+    uint32_t pullT(ST * out, size_t out_size, Stream<ST> & stream);
+    
+    /// the guts of the complex apply methods
+    template<typename T>
+    uint32_t applyT(const std::complex<T> * in, size_t in_size, 
+		    std::complex<T> * out, size_t out_size);
+
+    /// the guts of the real apply methods
+    template<typename T>
+    uint32_t applyRealT(const T * in, size_t in_size, 
+			T * out, size_t out_size);
     
     uint32_t save_count;   /// we do an overlap-and-save approach here
     uint32_t discard_count;  /// and we throw out samples at the end. 
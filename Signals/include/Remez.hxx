@@ -0,0 +1,175 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file Remez.hxx
+///  @brief Equiripple (Parks-McClellan) filter design from a FilterSpec
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <complex>
+#include <vector>
+#include <stdexcept>
+#include "FilterSpec.hxx"
+
+namespace SoDa {
+
+  /**
+   * @class Remez
+   *
+   * @brief Design the shortest filter that meets a FilterSpec, with
+   * the Remez exchange algorithm.
+   *
+   * A window design puts the same ripple in the pass band as in the
+   * stop band.  At 60 dB that's a pass band flat to a couple of
+   * hundredths of a dB, which nobody asked for, and it costs taps.
+   * The Parks-McClellan design spreads the error evenly over each band
+   * (it is "equiripple") and lets the pass band ripple up to the
+   * FilterSpec's pass band ripple while the stop band just reaches its
+   * stop band attenuation.  That typically takes a quarter to a third
+   * fewer taps than a Kaiser window.
+   *
+   * The FilterSpec corners are read this way: the space between two
+   * neighboring corners with the same gain is a band, and the
+   * response should be that gain all the way across it.  The space
+   * between corners of different gains is a transition band, and the
+   * design doesn't care what happens there.  A COMPLEX spec is taken
+   * as it stands (the corners wrap around from +sample_rate/2 to
+   * -sample_rate/2), so an asymmetric spec, like a sideband filter,
+   * gets complex taps.  A REAL spec is mirrored about zero and gets
+   * real taps.
+   *
+   * The filter is linear phase and the taps are centered at
+   * num_taps / 2, like those of a window designed Filter.
+   *
+   * Most users won't need this class directly -- pass
+   * Filter::EQUIRIPPLE as the window to Filter, OSFilter, FIRFilter
+   * and their relatives, and FilterSpec::EQUIRIPPLE to
+   * FilterSpec::estimateTaps.
+   */
+  class Remez {
+  public:
+    /**
+     * @class BadSpec
+     *
+     * @brief The FilterSpec has no bands to design to -- it needs at least
+     * one pair of corners with the same gain, and at least one change in gain.
+     */
+    class BadSpec : public std::runtime_error {
+    public:
+      /**
+       * @param st a string explaining who was annoyed
+       */
+      BadSpec(const std::string & st);
+    };
+
+    /**
+     * @brief Set up the design problem for a filter spec
+     *
+     * @param filter_spec the corners, sample rate, stop band attenuation
+     * and pass band ripple
+     */
+    Remez(FilterSpec & filter_spec);
+
+    /**
+     * @brief design a filter with a given number of taps
+     *
+     * If num_taps is even, the design has num_taps - 1 taps, and a
+     * zero is added at the front to keep the center at num_taps / 2.
+     *
+     * @param num_taps the length of the filter
+     * @param taps resized to num_taps and filled with the impulse response
+     * @return the worst error in the design, as a fraction of what the
+     * spec allows. 1.0 or less meets the spec.
+     */
+    double design(unsigned int num_taps, std::vector<std::complex<float>> & taps);
+
+    /**
+     * @brief find the shortest filter that meets the spec
+     *
+     * @param min_taps the smallest filter to consider
+     * @param max_taps the largest filter to consider
+     * @return the smallest odd number of taps that meets the spec, or
+     * max_taps if none of them do.
+     */
+    unsigned int minimumTaps(unsigned int min_taps, unsigned int max_taps);
+
+    /**
+     * @brief the usual estimate of the length of an equiripple filter
+     *
+     * taps = (-20 log10(sqrt(dp * ds)) - 13) / (14.6 * transition_width / sample_rate) + 1
+     *
+     * where dp and ds are the pass and stop band tolerances.  This is
+     * where minimumTaps starts looking.
+     *
+     * @return an odd number of taps
+     */
+    unsigned int estimateTaps();
+
+  private:
+    /// A band where the response should be flat
+    struct Band {
+      double lo, hi; ///< edges in radians per sample
+      double gain; ///< the response we want
+      double weight; ///< 1 / the error we can tolerate
+    };
+
+    /**
+     * @brief run the exchange
+     *
+     * @param num_taps an odd number of taps
+     * @param h the impulse response
+     * @return the worst weighted error
+     */
+    double exchange(unsigned int num_taps, std::vector<std::complex<double>> & h);
+
+    /**
+     * @brief lay out the frequency grid for a design with num_taps taps
+     *
+     * @param num_taps an odd number of taps
+     */
+    void makeGrid(unsigned int num_taps);
+
+    std::vector<Band> bands; ///< in order, from the end of a transition band around the circle
+    double min_transition; ///< the narrowest transition band, in radians per sample
+    double pass_tolerance; ///< the pass band ripple, as a fraction of the gain
+    double stop_tolerance; ///< the stop band level, as a fraction of unity
+    bool real_taps; ///< the spec was REAL -- drop the (tiny) imaginary part of the taps
+
+    // the grid, for the current design
+    std::vector<double> grid_sin; ///< sin(w/2) at each grid point
+    std::vector<double> grid_cos; ///< cos(w/2) at each grid point
+    std::vector<double> grid_gain; ///< the response we want at each grid point
+    std::vector<double> grid_weight; ///< 1 / the error we can tolerate at each grid point
+    std::vector<unsigned int> grid_band; ///< which band the grid point is in
+    unsigned int grid_taps; ///< the grid was laid out for this many taps
+  };
+}
@@ -64,6 +64,21 @@
  * signals. It handles much of the boilerplate and fiddly bits around things like
  * buffer allocation and such. It even handles training and tuning. 
  *
+ * Training (FFT::MEASURE and friends) can take a while. SoDa::FFT::enableWisdomCache
+ * keeps what FFTW learns in a per-user file so that the next run
+ * doesn't have to learn it all over again. 
+ *
+ * Real valued signals can use FFT::rfft and FFT::irfft, which compute just
+ * the non-negative half of the spectrum. The real valued apply methods in
+ * Filter, OSFilter, and ReSampler use these, so a real stream costs about
+ * half as much as a complex one. 
+ *
+ * FFT, Filter, OSFilter, and ReSampler also take double precision
+ * buffers (std::complex<double> and double). These use the double
+ * precision FFTW library (fftw_ rather than fftwf_) and are meant for long
+ * integrations where float runs out of dynamic range. The float
+ * interfaces are unchanged. 
+ *
  * @section Filter The SoDa::Filter Class
  *
  * Almost any DSP chain will need a filter somewhere along the line. Textbooks
@@ -80,6 +95,11 @@
  * filter larger than about 8 taps, doing the processing with a DFT
  * is far more efficient. By a lot. 
  *
+ * The per-bin multiply between the forward and inverse transforms
+ * goes through SoDa::VectorKernels, which picks SSE2, AVX2, or AVX-512
+ * code at run time (falling back to plain C++). Every version
+ * produces the same bits, so results don't depend on the machine. 
+ *
  * SoDa::Filter processes just one input block at a time, so it isn't
  * directly useful for streaming data. If you try to use it that way,
  * there will be unpleasant artifacts at the start of each output buffer.
@@ -93,6 +113,36 @@
  * number of taps required for a filter is nearly irrelevant. And neither of
  * those methods is very good at strange filter shapes. 
  *
+ * When the taps *do* matter -- they set the overlap in OSFilter and
+ * ReSampler, and the whole cost of a FIRFilter -- choose the KAISER
+ * window.  Its shape comes from the FilterSpec's stop band attenuation,
+ * and FilterSpec::estimateTaps(min, max, FilterSpec::KAISER) sizes the filter with
+ * Kaiser's formula, which asks for about a quarter fewer taps than the
+ * usual rule of thumb.
+ *
+ * Fewer still come from EQUIRIPPLE, which isn't a window at all.
+ * SoDa::Remez runs the Parks-McClellan (Remez exchange) design on the
+ * FilterSpec's corners, and lets the pass band ripple as much as
+ * FilterSpec::setPassBandRipple allows (0.1 dB unless you say
+ * otherwise) instead of holding it as flat as the stop band is deep.
+ * FilterSpec::estimateTaps(min, max, FilterSpec::EQUIRIPPLE) finds the
+ * shortest design that meets the spec.  Note that an equiripple filter
+ * meets its corners exactly, where the window designs reach the stop
+ * band a skirt width beyond the stop corner.
+ *
+ * Designs aren't free, so SoDa::Filter remembers the ones it has built
+ * from a FilterSpec. A second filter (or OSFilter, or ReSampler) with
+ * the same recipe shares its frequency image with the cache.
+ * Filter::enableDesignFiles keeps the designs on disk too, so they
+ * survive a restart.
+ *
+ * The taps and frequency image never change once a filter is built,
+ * so copies of a filter share them.  Filter::clone and OSFilter::clone
+ * make another filter with the same coefficients but its own scratch
+ * buffers (and, for OSFilter, its own overlap history).  A bank of
+ * channel filters built this way holds one image, not one per channel,
+ * and the clones can run in separate threads. 
+ *
  * @section OSFilter The SoDa::OSFilter Class - so much more useful than SoDa::Filter
  *
  * SoDa::OSFilter operates on continuous streams --
@@ -115,6 +165,31 @@
  * That's all a consequence of "circular convolution."  And we can't escape it simply
  * by doing everything with DFTs. The OSFilter class processes streams of blocks, saving
  * the tail end of each block to prepend at the start of the next block.
+ * (It doesn't actually move the tail. Circular convolution works in
+ * our favor here: each new block simply overwrites the oldest samples
+ * in the buffer, and the filtered block comes out in the same spot.)
+ *
+ * OSFilter can do overlap-and-add instead (OSFilter::OVERLAP_ADD):
+ * pad each block with zeros, and add the tail of each filtered
+ * block into the start of the next one.  Same filter, same transform
+ * length, same output to within rounding, but a block of silence
+ * costs no transforms at all. SoDaBench times both engines on busy
+ * and bursty streams over a range of buffer to filter length ratios. 
+ *
+ * For really short filters -- a few dozen taps on small buffers, the
+ * kind of thing that shows up in control loops -- the two transforms
+ * cost more than the convolution itself. SoDa::FIRFilter takes the
+ * same FilterSpec and window, but convolves in the time domain.
+ * SoDa::StreamFilter::make times both on this machine and builds
+ * whichever is cheaper. 
+ *
+ * At the other extreme, a filter with thousands of taps needs a big
+ * OSFilter buffer, and every sample waits for that buffer to fill.
+ * SoDa::PartitionedFilter cuts the impulse response into pieces as
+ * long as a (small) buffer and keeps the transforms of the last few
+ * input blocks in a delay line, so the latency is one small buffer
+ * and the filter is just as sharp. Smaller pieces cost more work per
+ * sample; PartitionedFilter::getSampleCost says how much. 
  *
  * 
  * @section ReSampling The SoDa::ReSampler Class
@@ -132,6 +207,39 @@
  * Like SoDa::Filter, SoDa::ReSampler operates on a continuous signal
  * stream. Otherwise it would be pretty useless. 
  *
+ * Both OSFilter and ReSampler want their input in fixed size
+ * buffers.  Streams don't always come that way.  The push and pull
+ * methods take and return any number of samples: push fills the
+ * overlap buffer, runs a block whenever it is full, and queues the
+ * result, and pull hands back whatever is ready. 
+ *
+ * @section ToneBank The SoDa::ToneBank Class
+ *
+ * Sometimes we only care about a handful of frequencies -- DTMF
+ * decoding, pilot tone detection, that sort of thing. Running a
+ * whole FFT to look at five bins is a waste. SoDa::ToneBank computes
+ * just the bins it is asked for, either once per block with Goertzel
+ * filters or on every sample with a sliding DFT. 
+ *
+ * @section Channelizer The SoDa::Channelizer Class
+ *
+ * The other end of that problem: we want *every* channel in a wide
+ * band -- all the 25 kHz slots in a chunk of the 2m band, say. We
+ * could run an NCO, a filter, and a decimator for each one, but
+ * that does the same filtering work over and over. SoDa::Channelizer
+ * splits the prototype low pass filter into polyphase branches and
+ * lets one inverse FFT per output frame do the mixing for all the
+ * channels at once. It can decimate by the channel count (critically
+ * sampled) or by half of it, which leaves room for the filter skirts
+ * and makes the channels easy to stitch back together.
+ *
+ * SoDa::ChannelSynthesizer does the stitching: it takes a block from
+ * each of M channels (in the same channel-major layout a Channelizer
+ * produces) and builds the wideband composite, again with one inverse
+ * FFT per frame. Run a 2x oversampled Channelizer into a 2x
+ * oversampled ChannelSynthesizer and you get the original stream
+ * back, a little later.
+ *
  * @section SoDa
  * 
  * SoDa is a namespace around a set of classes, libraries, (and one
@@ -0,0 +1,161 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file StreamFilter.hxx
+///  @brief The common interface for filters that run on a continuous stream
+///  of fixed size buffers, and a factory that picks the cheapest one.
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <memory>
+#include <complex>
+#include <vector>
+#include "FilterSpec.hxx"
+#include "Filter.hxx"
+
+namespace SoDa {
+
+  class StreamFilter;
+  typedef std::shared_ptr<StreamFilter> StreamFilterPtr;
+
+  /**
+   * @class StreamFilter
+   *
+   * @brief Anything that filters a stream one fixed size buffer at a time.
+   *
+   * OSFilter (overlap-and-save, in the frequency domain) and FIRFilter
+   * (direct convolution, in the time domain) both do this.  For long
+   * filters and big buffers the FFT wins by a mile.  For a handful of
+   * taps, the two transforms per block cost more than just doing the
+   * convolution. StreamFilter::make picks the cheaper one for the
+   * filter and buffer size at hand.
+   */
+  class StreamFilter {
+  public:
+    virtual ~StreamFilter() { }
+
+    /**
+     * @brief run the filter on a complex input stream
+     * @param in_buf the input buffer I/Q samples (complex)
+     * @param out_buf the output buffer I/Q samples (complex)
+     * @param gain applied to the output buffer
+     * @return the length of the input buffer
+     */
+    virtual unsigned int apply(std::vector<std::complex<float>> & in_buf, 
+			       std::vector<std::complex<float>> & out_buf,
+			       float gain = 1.0) = 0;
+    /// @brief run the filter on a real input stream
+    virtual unsigned int apply(std::vector<float> & in_buf, 
+			       std::vector<float> & out_buf, 
+			       float gain = 1.0) = 0;
+    /// @brief run the filter on a double precision complex input stream
+    virtual unsigned int apply(std::vector<std::complex<double>> & in_buf, 
+			       std::vector<std::complex<double>> & out_buf,
+			       float gain = 1.0) = 0;
+    /// @brief run the filter on a double precision real input stream
+    virtual unsigned int apply(std::vector<double> & in_buf, 
+			       std::vector<double> & out_buf, 
+			       float gain = 1.0) = 0;
+    /// @brief run the filter on complex samples in caller-owned memory
+    virtual unsigned int apply(const std::complex<float> * in_buf, 
+			       std::complex<float> * out_buf,
+			       unsigned int length, 
+			       float gain = 1.0) = 0;
+    /// @brief run the filter on real samples in caller-owned memory
+    virtual unsigned int apply(const float * in_buf, 
+			       float * out_buf,
+			       unsigned int length, 
+			       float gain = 1.0) = 0;
+    /// @brief run the filter on double precision complex samples in caller-owned memory
+    virtual unsigned int apply(const std::complex<double> * in_buf, 
+			       std::complex<double> * out_buf,
+			       unsigned int length, 
+			       float gain = 1.0) = 0;
+    /// @brief run the filter on double precision real samples in caller-owned memory
+    virtual unsigned int apply(const double * in_buf, 
+			       double * out_buf,
+			       unsigned int length, 
+			       float gain = 1.0) = 0;
+
+    /**
+     * @brief return the number of taps in the filter.
+     */
+    virtual unsigned int getTaps() = 0;
+
+    /**
+     * @brief return what the filter object believes are its lowest and highest specified frequencies
+     *
+     * @return pair containing lowest, highest specified frequencies in the filter -- more or less 
+     */
+    virtual std::pair<float,float> getFilterEdges() = 0;
+
+    /**
+     * @brief Build a FIRFilter or an OSFilter, whichever is cheaper.
+     *
+     * The filter_spec's tap count (FilterSpec::getTaps) sets the length
+     * of the direct form filter, and the choice is made by
+     * FIRFilter::directIsFaster.  If the overlap-and-save filter wins,
+     * it picks its own tap count, as OSFilter always does.
+     *
+     * @param filter_spec object of class FilterSpec identifying corner frequencies and amplitudes
+     * @param buffer_size the length of the buffers passed to apply
+     * @param gain relative magnitude of input to output in the passband     
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @return a shared pointer to a FIRFilter or an OSFilter
+     */
+    static StreamFilterPtr make(FilterSpec & filter_spec, 
+				unsigned int buffer_size,
+				float gain = 1.0, 
+				Filter::WindowChoice window = Filter::HANN);        
+
+    /**
+     * @brief Build a FIRFilter or an OSFilter for a very simple filter, whichever is cheaper.
+     *
+     * The number of taps is estimated from the skirt width and stop band attenuation.
+     *
+     * @param low_cutoff lower edge of the filter
+     * @param high_cutoff upper edge of the filter
+     * @param skirt width of transition band between cutoff and stopband
+     * @param sample_rate sample rate for the input stream. 
+     * @param buffer_size size of the input buffer when apply is called
+     * @param stop_band_attenuation in dB
+     * @param gain relative magnitude of input to output in the passband
+     * @param window filter window choice - we're using the window filter synthesis method. Defaults to HANN
+     * @return a shared pointer to a FIRFilter or an OSFilter     
+     */
+    static StreamFilterPtr make(float low_cutoff, float high_cutoff, float skirt,
+				float sample_rate, unsigned int buffer_size,
+				float stop_band_attenuation = 60.0,
+				float gain = 1.0,
+				Filter::WindowChoice window = Filter::HANN);    
+  };
+}
@@ -0,0 +1,224 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file ToneBank.hxx
+///  @brief Track a handful of DFT bins with Goertzel filters or a sliding DFT
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <complex>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+namespace SoDa {
+
+  class ToneBank;
+  typedef std::shared_ptr<ToneBank> ToneBankPtr;
+
+  /**
+   * @class ToneBank
+   *
+   * @brief Watch a few selected frequencies without doing a whole FFT. 
+   *
+   * Reading five bins from a 4096 point FFT or a Periodogram throws
+   * away almost all of the work.  A ToneBank computes just the bins
+   * it is asked for, at a cost of O(1) per tone per sample.
+   *
+   * Each tone's value is the DFT of the last block_length samples
+   * evaluated at that tone's frequency:
+   *
+   * X = sum_{m=0}^{N-1} x[m] exp(-j 2 pi f m / fs)
+   *
+   * where x[0] is the oldest sample in the block. That's the same
+   * value a block_length point FFT would put in the bin at f, though
+   * f need not be on an FFT bin center. 
+   *
+   * There are two ways to get there:
+   * - GOERTZEL runs a Goertzel filter over each (non-overlapping) block
+   *   of block_length samples.  The tone values are updated once per block.
+   *   This is the cheapest way to do it -- about two real multiplies per
+   *   tone per complex sample.
+   * - SLIDING_DFT updates every tone on every sample, once the
+   *   first block_length samples have arrived.  This costs a complex
+   *   multiply per tone per sample, plus a block_length history buffer.
+   *
+   * The filter state is kept in double precision, so the sliding DFT
+   * doesn't wander off over long runs. 
+   */
+  class ToneBank {
+  public:
+    enum Method {
+      GOERTZEL, ///< update the tones once per block
+      SLIDING_DFT ///< update the tones on every sample
+    };
+    
+    /**
+     * @brief constructor
+     *
+     * @param sample_rate the sample rate of the input stream
+     * @param freqs the frequencies to watch. For complex inputs these run
+     * from -sample_rate/2 to sample_rate/2.  For real inputs, only positive
+     * frequencies make sense.
+     * @param block_length the DFT length.  The frequency resolution of each tone
+     * is sample_rate / block_length. 
+     * @param method GOERTZEL or SLIDING_DFT
+     */
+    ToneBank(float sample_rate, const std::vector<float> & freqs, 
+	     unsigned int block_length, Method method = GOERTZEL);
+
+    /**
+     * @brief make a tone bank and return a shared pointer to it. 
+     *
+     * @param sample_rate the sample rate of the input stream
+     * @param freqs the frequencies to watch
+     * @param block_length the DFT length
+     * @param method GOERTZEL or SLIDING_DFT
+     * @return a shared pointer to a ToneBank
+     */
+    static ToneBankPtr make(float sample_rate, const std::vector<float> & freqs, 
+			    unsigned int block_length, Method method = GOERTZEL);
+    
+    /**
+     * @brief push a buffer of complex samples through the tone bank
+     *
+     * @param in the input buffer. This can be any length. 
+     * @return the number of times the tone values were updated (for GOERTZEL, the number
+     * of blocks completed, for SLIDING_DFT the number of samples that ended a full window)
+     */
+    unsigned int apply(const std::vector<std::complex<float>> & in);
+
+    /**
+     * @brief push a buffer of real samples through the tone bank
+     *
+     * @param in the input buffer. This can be any length. 
+     * @return the number of times the tone values were updated
+     */
+    unsigned int apply(const std::vector<float> & in);
+
+    /**
+     * @brief push complex samples from caller-owned memory through the tone bank
+     *
+     * @param in the input samples
+     * @param length the number of samples at in
+     * @return the number of times the tone values were updated
+     */
+    unsigned int apply(const std::complex<float> * in, unsigned int length);
+
+    /**
+     * @brief push real samples from caller-owned memory through the tone bank
+     *
+     * @param in the input samples
+     * @param length the number of samples at in
+     * @return the number of times the tone values were updated
+     */
+    unsigned int apply(const float * in, unsigned int length);
+
+    /**
+     * @brief get the most recent value of each tone
+     *
+     * @param out resized to the number of tones, and filled with the DFT
+     * values in the order the frequencies were given to the constructor.
+     * These are all zero until the first full block has arrived.
+     */
+    void get(std::vector<std::complex<float>> & out) const;
+
+    /**
+     * @brief get the most recent magnitude of each tone
+     *
+     * @param out resized to the number of tones, and filled with |X| / block_length.
+     * A complex exponential with amplitude A at exactly a tone frequency reads A. 
+     */
+    void getMagnitude(std::vector<float> & out) const;
+
+    /**
+     * @brief how many tones are we watching?
+     */
+    unsigned int getNumTones() const { return tones.size(); }
+
+    /**
+     * @brief how long is the DFT block?
+     */
+    unsigned int getBlockLength() const { return block_length; }
+
+    /**
+     * @brief forget all the samples we've seen, and zero the tone values
+     */
+    void clear();
+
+    /**
+     * @class BadFrequency
+     *
+     * @brief a tone frequency is outside the nyquist limits for this sample rate
+     */
+    class BadFrequency : public std::runtime_error {
+    public:
+      /**
+       * @brief Signal a violation of the nyquist limit
+       *
+       * @param fs the sample rate (Hz)
+       * @param fr the requested frequency (Hz)
+       */
+      BadFrequency(double fs, double fr);
+    };
+    
+  private:
+    /// the guts of the apply methods
+    template<typename ST>
+    unsigned int applyT(const ST * in, unsigned int length);
+
+    /// run one sample through the Goertzel filters
+    unsigned int goertzelStep(const std::complex<double> & x);
+
+    /// run one sample through the sliding DFT
+    unsigned int slidingStep(const std::complex<double> & x);
+
+    struct Tone {
+      double coeff; ///< 2 cos(w) for the Goertzel recursion
+      std::complex<double> w_1; ///< exp(j w)
+      std::complex<double> w_n; ///< exp(j w N) -- 1 if the tone is on a bin center
+      std::complex<double> w_neg; ///< exp(-j w)
+      std::complex<double> rot; ///< exp(-j w (N - 1)) moves the phase reference to the oldest sample
+      std::complex<double> s1, s2; ///< Goertzel state, or the sliding DFT sum in s1
+      std::complex<float> value; ///< the most recent result
+    };
+
+    std::vector<Tone> tones;
+    Method method; 
+    unsigned int block_length;
+    unsigned int sample_count; ///< samples in the current block (GOERTZEL) or seen so far (SLIDING_DFT)
+
+    /// the last block_length samples, for the sliding DFT.
+    std::vector<std::complex<double>> history;
+    unsigned int history_idx; 
+  }; 
+}
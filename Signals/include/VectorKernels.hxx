@@ -0,0 +1,186 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file VectorKernels.hxx
+///  @brief Vectorized complex multiply, multiply-accumulate, and scale loops
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <complex>
+#include <string>
+
+namespace SoDa {
+
+  /**
+   * @class VectorKernels
+   *
+   * @brief The per-bin loops that sit between every forward and inverse
+   * FFT in Filter, OSFilter, and ReSampler.
+   *
+   * Each kernel has an SSE2, AVX2, and AVX-512 version, plus a plain
+   * scalar version for everything else. The first call picks the
+   * widest one the CPU (and OS) supports. 
+   *
+   * All versions produce *exactly* the same bits as the scalar
+   * version.  The complex products are done as
+   *
+   * (ar br - ai bi) + j(ar bi + ai br)
+   *
+   * with no fused multiply-adds, and without the inf/NaN recovery
+   * that std::complex multiply does.  (The kernels are compiled
+   * without -ffast-math and with floating point contraction turned
+   * off, so the compiler doesn't get clever with the scalar
+   * version either.)
+   *
+   * The output buffer may be the same as either input buffer, but
+   * the buffers must not otherwise overlap.  Nothing needs to be
+   * aligned, though AlignedVector buffers are a little faster. 
+   */
+  class VectorKernels {
+  public:
+    /// The instruction set used by the kernels
+    enum ISA {
+      SCALAR, ///< plain C++
+      SSE2, ///< 128 bit vectors
+      AVX2, ///< 256 bit vectors
+      AVX512 ///< 512 bit vectors (AVX-512F)
+    };
+    
+    /**
+     * @brief out[i] = a[i] * b[i]
+     *
+     * @param a first input vector
+     * @param b second input vector
+     * @param out the product (may be a or b)
+     * @param length the number of elements in each vector
+     */
+    static void mul(const std::complex<float> * a, const std::complex<float> * b, 
+		    std::complex<float> * out, unsigned int length);
+    static void mul(const std::complex<double> * a, const std::complex<double> * b, 
+		    std::complex<double> * out, unsigned int length);
+
+    /**
+     * @brief out[i] = a[i] * conj(b[i])
+     *
+     * @param a first input vector
+     * @param b second input vector -- this one gets conjugated
+     * @param out the product (may be a or b)
+     * @param length the number of elements in each vector
+     */
+    static void mulConj(const std::complex<float> * a, const std::complex<float> * b, 
+			std::complex<float> * out, unsigned int length);
+    static void mulConj(const std::complex<double> * a, const std::complex<double> * b, 
+			std::complex<double> * out, unsigned int length);
+
+    /**
+     * @brief acc[i] = acc[i] + a[i] * b[i]
+     *
+     * @param a first input vector
+     * @param b second input vector
+     * @param acc the accumulator
+     * @param length the number of elements in each vector
+     */
+    static void mulAcc(const std::complex<float> * a, const std::complex<float> * b, 
+		       std::complex<float> * acc, unsigned int length);
+    static void mulAcc(const std::complex<double> * a, const std::complex<double> * b, 
+		       std::complex<double> * acc, unsigned int length);
+
+    /**
+     * @brief acc[i] = acc[i] + a[i] * s -- the inner loop of a direct form FIR
+     *
+     * Each acc[i] gets exactly one rounding per call, in the same order
+     * on every ISA, so a sum over taps built from these matches the scalar
+     * version bit for bit. 
+     *
+     * @param a input vector
+     * @param s the multiplier (a filter tap)
+     * @param acc the accumulator
+     * @param length the number of elements in each vector
+     */
+    static void mulAcc(const std::complex<float> * a, std::complex<float> s, 
+		       std::complex<float> * acc, unsigned int length);
+    static void mulAcc(const std::complex<double> * a, std::complex<double> s, 
+		       std::complex<double> * acc, unsigned int length);
+    static void mulAcc(const float * a, float s, float * acc, unsigned int length);
+    static void mulAcc(const double * a, double s, double * acc, unsigned int length);
+
+    /**
+     * @brief out[i] = a[i] * s
+     *
+     * @param a input vector
+     * @param s the scale factor
+     * @param out the scaled vector (may be a)
+     * @param length the number of elements in each vector
+     */
+    static void scale(const float * a, float s, float * out, unsigned int length);
+    static void scale(const double * a, double s, double * out, unsigned int length);
+    static void scale(const std::complex<float> * a, float s, 
+		      std::complex<float> * out, unsigned int length);
+    static void scale(const std::complex<double> * a, double s, 
+		      std::complex<double> * out, unsigned int length);
+
+    /**
+     * @brief which instruction set are the kernels using? 
+     *
+     * @return the ISA picked at startup, or the one passed to setISA
+     */
+    static ISA getISA();
+
+    /**
+     * @brief can this machine run kernels for a particular ISA?
+     *
+     * @param isa the instruction set
+     * @return true if the CPU and OS support it, and the library was built with it.
+     */
+    static bool isSupported(ISA isa);
+
+    /**
+     * @brief force the kernels to use a particular instruction set.
+     *
+     * This is meant for tests and benchmarks.  It is safe to call while
+     * other threads are running kernels: each kernel call runs
+     * entirely with either the old or the new instruction set. 
+     *
+     * @param isa the instruction set
+     * @return false (and no change) if isa is not supported on this machine. 
+     */
+    static bool setISA(ISA isa);
+
+    /**
+     * @brief a printable name for an ISA
+     *
+     * @param isa the instruction set
+     * @return "scalar", "sse2", "avx2", or "avx512"
+     */
+    static std::string getISAName(ISA isa);
+  };
+}
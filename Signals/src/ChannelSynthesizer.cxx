@@ -0,0 +1,226 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ChannelSynthesizer.hxx"
+#include "VectorKernels.hxx"
+#include <Utils/include/Format.hxx>
+#include <algorithm>
+#include <cmath>
+
+namespace SoDa {
+
+  ChannelSynthesizer::ChannelSynthesizer(float sample_rate, unsigned int num_channels, 
+					 Channelizer::Mode mode, 
+					 unsigned int taps_per_channel, 
+					 Filter::WindowChoice window) {
+    auto spec = getPrototypeSpec(sample_rate, num_channels, taps_per_channel, mode);
+    makeSynthesizer(spec, num_channels, mode, window);
+  }
+
+  ChannelSynthesizer::ChannelSynthesizer(FilterSpec & proto_spec, unsigned int num_channels, 
+					 Channelizer::Mode mode, 
+					 Filter::WindowChoice window) {
+    makeSynthesizer(proto_spec, num_channels, mode, window);
+  }
+
+  ChannelSynthesizerPtr ChannelSynthesizer::make(float sample_rate, unsigned int num_channels, 
+						 Channelizer::Mode mode, 
+						 unsigned int taps_per_channel, 
+						 Filter::WindowChoice window) {
+    return std::make_shared<ChannelSynthesizer>(sample_rate, num_channels, mode, taps_per_channel, window);
+  }
+
+  ChannelSynthesizerPtr ChannelSynthesizer::make(FilterSpec & proto_spec, unsigned int num_channels, 
+						 Channelizer::Mode mode, 
+						 Filter::WindowChoice window) {
+    return std::make_shared<ChannelSynthesizer>(proto_spec, num_channels, mode, window);
+  }
+  
+  FilterSpec ChannelSynthesizer::getPrototypeSpec(float sample_rate, unsigned int num_channels, 
+						  unsigned int taps_per_channel, 
+						  Channelizer::Mode mode) {
+    unsigned int taps = num_channels * taps_per_channel; 
+    FilterSpec spec(sample_rate, taps);
+    
+    // Critically sampled, there's no room between the images for
+    // anything wider than the analysis prototype.
+    float spacing = sample_rate / float(num_channels);
+    bool critical = (mode == Channelizer::CRITICAL);
+    float pass_edge = (critical ? 0.25 : 0.75) * spacing;
+    float stop_edge = (critical ? 0.75 : 1.25) * spacing;
+    float bin = sample_rate / float(taps);
+
+    spec.add(-0.5 * sample_rate, 0.0);
+    // one corner per bin across the ramp, as in Channelizer
+    int max_bin = int(stop_edge / bin) + 1;
+    for(int i = -max_bin; i <= max_bin; i++) {
+      float f = bin * i; 
+      float gain = (stop_edge - fabs(f)) / (stop_edge - pass_edge);
+      gain = std::min(1.0f, std::max(0.0f, gain));
+      spec.add(f, gain);
+    }
+    spec.add(0.5 * sample_rate, 0.0);
+    return spec; 
+  }
+  
+  void ChannelSynthesizer::makeSynthesizer(FilterSpec & proto_spec, unsigned int _num_channels, 
+					   Channelizer::Mode mode, Filter::WindowChoice window) {
+    sample_rate = proto_spec.getSampleRate();
+    num_channels = _num_channels;
+    if((num_channels < 2) || ((mode == Channelizer::OVERSAMPLED_2X) && (num_channels & 1))) {
+      throw BadChannelCount(num_channels, mode);
+    }
+    interpolation = (mode == Channelizer::CRITICAL) ? num_channels : (num_channels / 2);
+
+    // The prototype design is the same as the Channelizer's
+    unsigned int spec_taps = proto_spec.getTaps();
+    unsigned int design_size = FFT::findGoodSize(std::max(4 * spec_taps, 1024u));
+    Filter design(proto_spec, design_size, 1.0, window);
+    std::vector<std::complex<float>> g;
+    design.getImpulseResponse(g);
+
+    // A Channelizer frame ends D - 1 samples after the start of the
+    // frame we build from it, and the Channelizer puts its prototype's
+    // center tap on a multiple of M. Put our center tap D - 1 past a
+    // multiple of M. Then the analysis/synthesis pair's impulse response
+    // is centered on a sample that the M-fold sum over channels keeps,
+    // and the linear ramps of neighboring channels add up to one. 
+    unsigned int center = 0;
+    for(int i = 0; i < g.size(); i++) {
+      if(fabs(g[i].real()) > fabs(g[center].real())) center = i; 
+    }
+    unsigned int lead = (interpolation - 1 + num_channels - (center % num_channels)) % num_channels;
+    taps_per_channel = (lead + g.size() + num_channels - 1) / num_channels;
+    prototype.assign(taps_per_channel * num_channels, 0.0);
+    for(int i = 0; i < g.size(); i++) {
+      prototype[lead + i] = g[i].real();
+    }
+
+    // fold the upsampling gain into the branches
+    branches.resize(prototype.size());
+    for(int i = 0; i < prototype.size(); i++) {
+      branches[i] = std::complex<float>(float(interpolation) * prototype[i], 0.0);
+    }
+
+    // Frame m starts on output sample m D.  The mix-up phase for
+    // channel k there is exp(j 2 pi k m D / M), and that only depends
+    // on m mod (M / D).
+    unsigned int num_phases = num_channels / interpolation; 
+    rotations.resize(num_phases);
+    for(unsigned int f = 0; f < num_phases; f++) {
+      uint64_t n = uint64_t(f) * interpolation; 
+      rotations[f].resize(num_channels);
+      for(unsigned int k = 0; k < num_channels; k++) {
+	uint64_t kn = (uint64_t(k) * n) % num_channels;
+	rotations[f][k] = std::polar(1.0, 2.0 * M_PI * double(kn) / double(num_channels));
+      }
+    }
+    
+    fft = std::unique_ptr<FFT>(new FFT(num_channels));
+    clear();
+  }
+
+  void ChannelSynthesizer::clear() {
+    accum.assign(prototype.size() - interpolation, std::complex<float>(0.0, 0.0));
+    frame_count = 0; 
+  }
+  
+  float ChannelSynthesizer::getChannelFrequency(unsigned int k) const {
+    float spacing = sample_rate / float(num_channels);
+    if(k < (num_channels + 1) / 2) return spacing * float(k);
+    else return spacing * (float(k) - float(num_channels)); 
+  }
+  
+  unsigned int ChannelSynthesizer::apply(const std::vector<std::complex<float>> & in, 
+					 std::vector<std::complex<float>> & out) {
+    return apply(in.data(), in.size(), out.data(), out.size());
+  }
+  
+  unsigned int ChannelSynthesizer::apply(const std::complex<float> * in, unsigned int in_length, 
+					 std::complex<float> * out, unsigned int out_length) {
+    unsigned int frames = in_length / num_channels; 
+    if(((in_length % num_channels) != 0) || (out_length != frames * interpolation)) {
+      throw BadBufferSize(in_length, out_length, interpolation, num_channels);
+    }
+    if(frames == 0) return 0; 
+
+    unsigned int M = num_channels; 
+    unsigned int D = interpolation;
+
+    // Mix each frame to its starting phase, and turn the channel-major
+    // input around so that each frame is one contiguous transform.
+    Z.resize(M * frames);
+    V.resize(M * frames);
+    for(unsigned int k = 0; k < M; k++) {
+      for(unsigned int f = 0; f < frames; f++) {
+	auto & rot = rotations[(frame_count + f) % rotations.size()];
+	Z[f * M + k] = in[k * frames + f] * rot[k];
+      }
+    }
+
+    // v_m[r] = sum_k z_k[m] exp(j 2 pi k r / M) for every frame at once
+    fft->ifftBatch(Z, V, frames, FFT::CHANNEL_MAJOR);
+
+    // accum holds the tail of the last block. Make room for this one.
+    unsigned int save = prototype.size() - D; 
+    accum.resize(save + frames * D, std::complex<float>(0.0, 0.0));
+
+    // Frame m contributes D g[l] v_m[l mod M] to output sample m D + l. 
+    for(unsigned int f = 0; f < frames; f++) {
+      auto v = V.data() + f * M; 
+      for(unsigned int p = 0; p < taps_per_channel; p++) {
+	VectorKernels::mulAcc(branches.data() + p * M, v, 
+			      accum.data() + f * D + p * M, M);
+      }
+    }
+    frame_count += frames; 
+
+    // The first frames * D sums are finished. Nothing after this block
+    // reaches back that far.
+    std::copy(accum.begin(), accum.begin() + frames * D, out);
+    std::copy(accum.begin() + frames * D, accum.end(), accum.begin());
+    accum.resize(save);
+    
+    return frames; 
+  }
+
+  ChannelSynthesizer::BadBufferSize::BadBufferSize(unsigned int in, unsigned int out, 
+						   unsigned int interpolation, unsigned int num_channels) : 
+    std::runtime_error(SoDa::Format("ChannelSynthesizer::apply input length %0 must be a multiple of %3, and output length %1 must be %2 times the number of frames\n")
+		       .addI(in)
+		       .addI(out)
+		       .addI(interpolation)
+		       .addI(num_channels)
+		       .str()) { }
+
+  ChannelSynthesizer::BadChannelCount::BadChannelCount(unsigned int num_channels, Channelizer::Mode mode) : 
+    std::runtime_error(SoDa::Format("ChannelSynthesizer can't combine %0 channels %1\n")
+		       .addI(num_channels)
+		       .addS((mode == Channelizer::OVERSAMPLED_2X) ? "with 2x oversampling (it must be even)" : "(it must be at least 2)")
+		       .str()) { }
+}
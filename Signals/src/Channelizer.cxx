@@ -0,0 +1,232 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Channelizer.hxx"
+#include "VectorKernels.hxx"
+#include <Utils/include/Format.hxx>
+#include <algorithm>
+#include <cmath>
+
+namespace SoDa {
+
+  Channelizer::Channelizer(float sample_rate, unsigned int num_channels, 
+			   Mode mode, 
+			   unsigned int taps_per_channel, 
+			   Filter::WindowChoice window) {
+    auto spec = getPrototypeSpec(sample_rate, num_channels, taps_per_channel);
+    makeChannelizer(spec, num_channels, mode, window);
+  }
+
+  Channelizer::Channelizer(FilterSpec & proto_spec, unsigned int num_channels, 
+			   Mode mode, 
+			   Filter::WindowChoice window) {
+    makeChannelizer(proto_spec, num_channels, mode, window);
+  }
+
+  ChannelizerPtr Channelizer::make(float sample_rate, unsigned int num_channels, 
+				   Mode mode, 
+				   unsigned int taps_per_channel, 
+				   Filter::WindowChoice window) {
+    return std::make_shared<Channelizer>(sample_rate, num_channels, mode, taps_per_channel, window);
+  }
+
+  ChannelizerPtr Channelizer::make(FilterSpec & proto_spec, unsigned int num_channels, 
+				   Mode mode, 
+				   Filter::WindowChoice window) {
+    return std::make_shared<Channelizer>(proto_spec, num_channels, mode, window);
+  }
+  
+  FilterSpec Channelizer::getPrototypeSpec(float sample_rate, unsigned int num_channels, 
+					   unsigned int taps_per_channel) {
+    unsigned int taps = num_channels * taps_per_channel; 
+    FilterSpec spec(sample_rate, taps);
+    
+    float spacing = sample_rate / float(num_channels);
+    float pass_edge = 0.25 * spacing;
+    float stop_edge = 0.75 * spacing;
+    float bin = sample_rate / float(taps);
+
+    spec.add(-0.5 * sample_rate, 0.0);
+    // one corner per bin across the ramp
+    int max_bin = int(stop_edge / bin) + 1;
+    for(int i = -max_bin; i <= max_bin; i++) {
+      float f = bin * i; 
+      float gain = (stop_edge - fabs(f)) / (stop_edge - pass_edge);
+      gain = std::min(1.0f, std::max(0.0f, gain));
+      spec.add(f, gain);
+    }
+    spec.add(0.5 * sample_rate, 0.0);
+    return spec; 
+  }
+  
+  void Channelizer::makeChannelizer(FilterSpec & proto_spec, unsigned int _num_channels, 
+				    Mode mode, Filter::WindowChoice window) {
+    sample_rate = proto_spec.getSampleRate();
+    num_channels = _num_channels;
+    if((num_channels < 2) || ((mode == OVERSAMPLED_2X) && (num_channels & 1))) {
+      throw BadChannelCount(num_channels, mode);
+    }
+    decimation = (mode == CRITICAL) ? num_channels : (num_channels / 2);
+
+    // Let Filter design the prototype, on a fine grid so the gain
+    // normalization sees the real peak.
+    unsigned int spec_taps = proto_spec.getTaps();
+    unsigned int design_size = FFT::findGoodSize(std::max(4 * spec_taps, 1024u));
+    Filter design(proto_spec, design_size, 1.0, window);
+    std::vector<std::complex<float>> h;
+    design.getImpulseResponse(h);
+
+    // Slide the prototype along so that its center tap lands on a
+    // multiple of M -- a ChannelSynthesizer counts on that to line
+    // its images up with ours -- and pad it out to a whole number of
+    // taps per channel.
+    unsigned int center = 0;
+    for(int i = 0; i < h.size(); i++) {
+      if(fabs(h[i].real()) > fabs(h[center].real())) center = i; 
+    }
+    unsigned int lead = (num_channels - (center % num_channels)) % num_channels;
+    taps_per_channel = (lead + h.size() + num_channels - 1) / num_channels;
+    prototype.assign(taps_per_channel * num_channels, 0.0);
+    for(int i = 0; i < h.size(); i++) {
+      prototype[lead + i] = h[i].real();
+    }
+
+    branches.resize(prototype.size());
+    for(unsigned int p = 0; p < taps_per_channel; p++) {
+      for(unsigned int r = 0; r < num_channels; r++) {
+	branches[p * num_channels + r] = prototype[p * num_channels + (num_channels - 1 - r)];
+      }
+    }
+
+    // Each frame ends on input sample n = (f + 1) D - 1.  The mix-down
+    // phase for channel k at that sample is exp(-j 2 pi k n / M), and
+    // that only depends on f mod (M / D). 
+    unsigned int num_phases = num_channels / decimation; 
+    rotations.resize(num_phases);
+    for(unsigned int f = 0; f < num_phases; f++) {
+      uint64_t n = (uint64_t(f) + 1) * decimation - 1; 
+      rotations[f].resize(num_channels);
+      for(unsigned int k = 0; k < num_channels; k++) {
+	// do the modulo in integers so the big channel numbers stay exact
+	uint64_t kn = (uint64_t(k) * n) % num_channels;
+	rotations[f][k] = std::polar(1.0, -2.0 * M_PI * double(kn) / double(num_channels));
+      }
+    }
+    
+    acc.resize(num_channels);
+    fft = std::unique_ptr<FFT>(new FFT(num_channels));
+    clear();
+  }
+
+  void Channelizer::clear() {
+    history.assign(prototype.size() - 1, std::complex<float>(0.0, 0.0));
+    frame_count = 0; 
+  }
+  
+  float Channelizer::getChannelFrequency(unsigned int k) const {
+    float spacing = sample_rate / float(num_channels);
+    if(k < (num_channels + 1) / 2) return spacing * float(k);
+    else return spacing * (float(k) - float(num_channels)); 
+  }
+  
+  unsigned int Channelizer::apply(const std::vector<std::complex<float>> & in, 
+				  std::vector<std::complex<float>> & out) {
+    return apply(in.data(), in.size(), out.data(), out.size());
+  }
+  
+  unsigned int Channelizer::apply(const std::complex<float> * in, unsigned int in_length, 
+				  std::complex<float> * out, unsigned int out_length) {
+    unsigned int frames = in_length / decimation; 
+    if(((in_length % decimation) != 0) || (out_length != frames * num_channels)) {
+      throw BadBufferSize(in_length, out_length, decimation, num_channels);
+    }
+    if(frames == 0) return 0; 
+    
+    // history holds the tail of the last block. Tack this block on the end.
+    unsigned int save = prototype.size() - 1; 
+    history.resize(save + in_length);
+    std::copy(in, in + in_length, history.begin() + save);
+
+    unsigned int M = num_channels; 
+    U.resize(M * frames);
+    Y.resize(M * frames);
+    for(unsigned int f = 0; f < frames; f++) {
+      // the newest sample in this frame
+      unsigned int n = save + (f + 1) * decimation - 1;
+      
+      // the polyphase branches: 
+      // acc[M - 1 - r] = sum_p h[p M + r] x[n - p M - r]
+      std::fill(acc.begin(), acc.end(), std::complex<float>(0.0, 0.0));
+      for(unsigned int p = 0; p < taps_per_channel; p++) {
+	VectorKernels::mulAcc(history.data() + n + 1 - (p + 1) * M, 
+			      branches.data() + p * M, 
+			      acc.data(), M);
+      }
+      
+      // lay the branch sums down for the batched inverse FFT -- frame f
+      // is "channel" f of an interleaved batch, so the transform comes out
+      // channel major, just the way we want to deliver it. 
+      for(unsigned int r = 0; r < M; r++) {
+	U[r * frames + f] = acc[M - 1 - r];
+      }
+    }
+
+    // sum_r u_r exp(j 2 pi k r / M) for every frame at once
+    fft->ifftBatch(U, Y, frames, FFT::INTERLEAVED);
+
+    // and mix each channel down to baseband
+    for(unsigned int k = 0; k < M; k++) {
+      for(unsigned int f = 0; f < frames; f++) {
+	auto & rot = rotations[(frame_count + f) % rotations.size()];
+	out[k * frames + f] = Y[k * frames + f] * rot[k];
+      }
+    }
+    frame_count += frames; 
+
+    // save the tail for next time
+    std::copy(history.end() - save, history.end(), history.begin());
+    history.resize(save);
+    
+    return frames; 
+  }
+
+  Channelizer::BadBufferSize::BadBufferSize(unsigned int in, unsigned int out, 
+					    unsigned int decimation, unsigned int num_channels) : 
+    std::runtime_error(SoDa::Format("Channelizer::apply input length %0 must be a multiple of %2, and output length %1 must be %3 times the number of frames\n")
+		       .addI(in)
+		       .addI(out)
+		       .addI(decimation)
+		       .addI(num_channels)
+		       .str()) { }
+
+  Channelizer::BadChannelCount::BadChannelCount(unsigned int num_channels, Mode mode) : 
+    std::runtime_error(SoDa::Format("Channelizer can't make %0 channels %1\n")
+		       .addI(num_channels)
+		       .addS((mode == OVERSAMPLED_2X) ? "with 2x oversampling (it must be even)" : "(it must be at least 2)")
+		       .str()) { }
+}
@@ -30,154 +30,758 @@
 #include <Utils/include/Format.hxx>
 #include <Utils/include/Exception.hxx>
 
+#include <map>
+#include <algorithm>
+#include <tuple>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace SoDa {
 
+  // fftw has a separate API for each precision -- fftwf_* for float
+  // and fftw_* for double.  FFTW<T> picks the right one at compile time
+  // so that the rest of this file can be written once.
+  template<typename T> struct FFTW; 
+
+  template<> struct FFTW<float> {
+    typedef fftwf_complex complex; 
+    typedef fftwf_plan plan; 
+    static plan get(const FFT::Plan & p) { return p.plan; }
+    static int alignmentOf(float * p) { return fftwf_alignment_of(p); }
+    static void * malloc(size_t n) { return fftwf_malloc(n); }
+    static void free(void * p) { fftwf_free(p); }
+    static void setTimelimit(double t) { fftwf_set_timelimit(t); }
+    static plan dft1d(int n, complex * in, complex * out, int sign, unsigned flags) {
+      return fftwf_plan_dft_1d(n, in, out, sign, flags);
+    }
+    static plan manyDft(int n, int howmany, complex * in, complex * out, 
+			int stride, int dist, int sign, unsigned flags) {
+      return fftwf_plan_many_dft(1, &n, howmany, in, NULL, stride, dist, 
+				 out, NULL, stride, dist, sign, flags);
+    }
+    static plan r2c(int n, float * in, complex * out, unsigned flags) {
+      return fftwf_plan_dft_r2c_1d(n, in, out, flags);
+    }
+    static plan c2r(int n, complex * in, float * out, unsigned flags) {
+      return fftwf_plan_dft_c2r_1d(n, in, out, flags);
+    }
+    static void execute(plan p, complex * in, complex * out) { fftwf_execute_dft(p, in, out); }
+    static void executeR2C(plan p, float * in, complex * out) { fftwf_execute_dft_r2c(p, in, out); }
+    static void executeC2R(plan p, complex * in, float * out) { fftwf_execute_dft_c2r(p, in, out); }
+    static int importWisdom(FILE * f) { return fftwf_import_wisdom_from_file(f); }
+    static void exportWisdom(FILE * f) { fftwf_export_wisdom_to_file(f); }
+    static std::string wisdomString() {
+      char * w = fftwf_export_wisdom_to_string();
+      std::string ret(w == nullptr ? "" : w);
+      ::free(w);
+      return ret; 
+    }
+#ifdef SODA_FFTW_THREADS
+    static void initThreads() { fftwf_init_threads(); fftwf_make_planner_thread_safe(); }
+    static void planWithNThreads(int n) { fftwf_plan_with_nthreads(n); }
+#endif
+    /// float wisdom lives in the file we're given
+    static std::string wisdomPath(const std::string & path) { return path; }
+  };
+
+  template<> struct FFTW<double> {
+    typedef fftw_complex complex; 
+    typedef fftw_plan plan; 
+    static plan get(const FFT::Plan & p) { return p.dplan; }
+    static int alignmentOf(double * p) { return fftw_alignment_of(p); }
+    static void * malloc(size_t n) { return fftw_malloc(n); }
+    static void free(void * p) { fftw_free(p); }
+    static void setTimelimit(double t) { fftw_set_timelimit(t); }
+    static plan dft1d(int n, complex * in, complex * out, int sign, unsigned flags) {
+      return fftw_plan_dft_1d(n, in, out, sign, flags);
+    }
+    static plan manyDft(int n, int howmany, complex * in, complex * out, 
+			int stride, int dist, int sign, unsigned flags) {
+      return fftw_plan_many_dft(1, &n, howmany, in, NULL, stride, dist, 
+				out, NULL, stride, dist, sign, flags);
+    }
+    static plan r2c(int n, double * in, complex * out, unsigned flags) {
+      return fftw_plan_dft_r2c_1d(n, in, out, flags);
+    }
+    static plan c2r(int n, complex * in, double * out, unsigned flags) {
+      return fftw_plan_dft_c2r_1d(n, in, out, flags);
+    }
+    static void execute(plan p, complex * in, complex * out) { fftw_execute_dft(p, in, out); }
+    static void executeR2C(plan p, double * in, complex * out) { fftw_execute_dft_r2c(p, in, out); }
+    static void executeC2R(plan p, complex * in, double * out) { fftw_execute_dft_c2r(p, in, out); }
+    static int importWisdom(FILE * f) { return fftw_import_wisdom_from_file(f); }
+    static void exportWisdom(FILE * f) { fftw_export_wisdom_to_file(f); }
+    static std::string wisdomString() {
+      char * w = fftw_export_wisdom_to_string();
+      std::string ret(w == nullptr ? "" : w);
+      ::free(w);
+      return ret; 
+    }
+#ifdef SODA_FFTW_THREADS
+    static void initThreads() { fftw_init_threads(); fftw_make_planner_thread_safe(); }
+    static void planWithNThreads(int n) { fftw_plan_with_nthreads(n); }
+#endif
+    /// double wisdom goes in a file of its own, right beside the float wisdom
+    static std::string wisdomPath(const std::string & path) { return path + ".double"; }
+  };
   
-  FFT::FFT(unsigned int len, FFTOpt opt) : len(len) {
-    fftwf_set_timelimit(1.0);
-    
-    unsigned int fftw_flag; 
+  // The process-wide plan cache.  The fftw planner is not thread
+  // safe, so every call that creates or destroys a plan, or touches
+  // wisdom, must hold planner_mutex.  Executing a plan (with the
+  // new-array execute functions) is thread safe, so there's no
+  // locking in fft/ifft.
+  //
+  // The cache itself is protected by cache_mutex, which is never held
+  // while we're planning. A thread that wants a plan that's already
+  // cached doesn't have to wait for somebody else's slow MEASURE plan,
+  // and threads that want a plan that is being made right now wait
+  // for that one instead of making another.
+  typedef std::tuple<unsigned int, unsigned int, int, int, int, unsigned int, unsigned int, int> PlanKey; // len, sizeof(T), kind, opt, alignment, threads, howmany, layout
+  static std::mutex planner_mutex;
+  static std::mutex cache_mutex; 
+  static std::map<PlanKey, std::shared_future<FFT::PlanPtr>> plan_cache;
 
+  // if this isn't empty, we save new wisdom here whenever we make
+  // a MEASURE/PATIENT/EXHAUST plan. (protected by planner_mutex)
+  static std::string wisdom_cache_path; 
+
+  // we don't write out double precision wisdom unless we've
+  // made a double precision plan. (protected by planner_mutex)
+  static bool double_planned = false; 
+  
+  // FFTs that don't ask for a thread count get this many. (protected by cache_mutex)
+  static unsigned int default_threads = 1; 
+
+#ifdef SODA_FFTW_THREADS
+  static void initThreads() {
+    static std::once_flag threads_init_flag;
+    // make_planner_thread_safe protects the planner from anybody else in this
+    // process who calls fftw without going through us. 
+    std::call_once(threads_init_flag, []() { 
+	FFTW<float>::initThreads();
+	FFTW<double>::initThreads();
+      });
+  }
+#endif
+
+  static unsigned int fftwFlag(FFT::FFTOpt opt) {
     switch (opt) {
-    case MEASURE:
-      fftw_flag = FFTW_MEASURE;
+    case FFT::MEASURE:
+      return FFTW_MEASURE;
+    case FFT::EXHAUST:
+      return FFTW_EXHAUSTIVE;
+    case FFT::PATIENT:
+      return FFTW_PATIENT;
+    case FFT::ESTIMATE:
+    default:
+      return FFTW_ESTIMATE; 
+    }
+  }
+
+  template<>
+  FFT::PlanSet<float> & FFT::getPlanSet<float>() { return float_plans; }
+
+  template<>
+  FFT::PlanSet<double> & FFT::getPlanSet<double>() { return double_plans; }
+  
+  FFT::FFT(unsigned int len, FFTOpt opt) : FFT(len, opt, getDefaultThreads()) {
+  }
+
+  FFT::FFT(unsigned int len, FFTOpt opt, unsigned int _num_threads) : len(len), opt(opt) {
+    num_threads = threadsAvailable() ? std::max(1u, _num_threads) : 1; 
+    // float plans are made now. The double precision plans are
+    // made the first time somebody hands us a double precision buffer. 
+    float_plans.forward = getPlan<float>(len, C2C_FORWARD, opt, 0, num_threads);
+    float_plans.backward = getPlan<float>(len, C2C_BACKWARD, opt, 0, num_threads);
+  }
+
+  bool FFT::threadsAvailable() {
+#ifdef SODA_FFTW_THREADS
+    return true;
+#else
+    return false; 
+#endif
+  }
+
+  bool FFT::setDefaultThreads(unsigned int num_threads) {
+    if(!threadsAvailable()) return false; 
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    default_threads = std::max(1u, num_threads);
+    return true; 
+  }
+
+  unsigned int FFT::getDefaultThreads() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return default_threads; 
+  }
+
+  FFT::Plan::~Plan() {
+    std::lock_guard<std::mutex> lock(planner_mutex);
+    if(plan != nullptr) fftwf_destroy_plan(plan);
+    if(dplan != nullptr) fftw_destroy_plan(dplan);
+  }
+
+  template<typename T>
+  FFT::PlanPtr FFT::getPlan(unsigned int len, PlanKind kind, FFTOpt opt, int alignment, 
+			    unsigned int nthreads, unsigned int howmany, BatchLayout layout) {
+    PlanKey key(len, sizeof(T), int(kind), int(opt), alignment, nthreads, 
+		howmany, (howmany > 1) ? int(layout) : 0);
+
+    std::promise<PlanPtr> plan_promise;     
+    std::shared_future<PlanPtr> plan_future; 
+    bool we_make_it = false; 
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex);
+      auto pi = plan_cache.find(key);
+      if(pi != plan_cache.end()) {
+	// either it is ready, or somebody is making it right now.
+	plan_future = pi->second;
+      }
+      else {
+	// we've never seen this one before. Tell everybody we're working on it. 
+	plan_future = plan_promise.get_future().share();
+	plan_cache[key] = plan_future; 
+	we_make_it = true; 
+      }
+    }
+
+    if(we_make_it) {
+      try {
+	plan_promise.set_value(makePlan<T>(len, kind, opt, alignment, nthreads, howmany, layout));
+      }
+      catch (...) {
+	// let the next caller try again, and pass the bad news to anyone who's waiting.
+	{
+	  std::lock_guard<std::mutex> lock(cache_mutex);
+	  plan_cache.erase(key);
+	}
+	plan_promise.set_exception(std::current_exception());
+      }
+    }
+
+    return plan_future.get();
+  }
+
+  template<typename T>
+  FFT::PlanPtr FFT::makePlan(unsigned int len, PlanKind kind, FFTOpt opt, int alignment, 
+			     unsigned int nthreads, unsigned int howmany, BatchLayout layout) {
+    typedef typename FFTW<T>::complex fcomplex; 
+    std::lock_guard<std::mutex> lock(planner_mutex);
+    
+    FFTW<T>::setTimelimit(1.0);
+    
+    unsigned int fftw_flag = fftwFlag(opt);
+    if(alignment != 0) fftw_flag |= FFTW_UNALIGNED; 
+
+#ifdef SODA_FFTW_THREADS
+    // the thread count is planner state, so set it for every plan.
+    initThreads();
+    FFTW<T>::planWithNThreads(nthreads);
+#endif
+    
+    // We only want to write the wisdom file if this plan taught the
+    // planner something.  A plan that came straight out of wisdom we
+    // already had leaves the wisdom unchanged. 
+    bool save_wisdom = (opt != ESTIMATE) && !wisdom_cache_path.empty();
+    std::string old_wisdom;
+    if(save_wisdom) old_wisdom = FFTW<T>::wisdomString();
+    
+    auto f_dummy_in = (fcomplex*) FFTW<T>::malloc(sizeof(fcomplex) * len * howmany);
+    auto f_dummy_out = (fcomplex*) FFTW<T>::malloc(sizeof(fcomplex) * len * howmany);  
+  
+    typename FFTW<T>::plan plan = nullptr;
+    if(howmany > 1) {
+      // a batch of channels. Channel major buffers have unit stride
+      // and are len apart.  Interleaved buffers are the other way around. 
+      int stride = (layout == CHANNEL_MAJOR) ? 1 : howmany;
+      int dist = (layout == CHANNEL_MAJOR) ? len : 1;
+      plan = FFTW<T>::manyDft(len, howmany, f_dummy_in, f_dummy_out, stride, dist, 
+			      (kind == C2C_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD, 
+			      fftw_flag);
+    }
+    else switch (kind) {
+    case C2C_FORWARD:
+      plan = FFTW<T>::dft1d(len, f_dummy_in, f_dummy_out, FFTW_FORWARD, fftw_flag);
       break; 
-    case EXHAUST:
-      fftw_flag = FFTW_EXHAUSTIVE;
+    case C2C_BACKWARD:
+      plan = FFTW<T>::dft1d(len, f_dummy_in, f_dummy_out, FFTW_BACKWARD, fftw_flag);
       break; 
-    case PATIENT:
-      fftw_flag = FFTW_PATIENT;
+    case R2C:
+      plan = FFTW<T>::r2c(len, (T*) f_dummy_in, f_dummy_out, fftw_flag);
       break; 
-    case ESTIMATE:
-    default:
-      fftw_flag = FFTW_ESTIMATE; 
+    case C2R:
+      plan = FFTW<T>::c2r(len, f_dummy_in, (T*) f_dummy_out, fftw_flag);
       break; 
     }
+
+    FFTW<T>::free(f_dummy_in);
+    FFTW<T>::free(f_dummy_out);
+
+    auto ret = std::make_shared<Plan>(plan);
+
+    if(sizeof(T) == sizeof(double)) double_planned = true; 
+    
+    // if we learned something, remember it for next time.
+    if(save_wisdom && (FFTW<T>::wisdomString() != old_wisdom)) {
+      exportWisdom(wisdom_cache_path);
+    }
     
-    auto f_dummy_in = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * len);
-    auto f_dummy_out = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * len);  
+    return ret; 
+  }
+
+  template<typename T>
+  const FFT::PlanPtr & FFT::selectPlan(bool forward, int alignment) {
+    auto & ps = getPlanSet<T>();
+    if(alignment == 0) {
+      if(!ps.forward) {
+	ps.forward = getPlan<T>(len, C2C_FORWARD, opt, 0, num_threads);
+	ps.backward = getPlan<T>(len, C2C_BACKWARD, opt, 0, num_threads);
+      }
+      return forward ? ps.forward : ps.backward; 
+    }
+    if((alignment != ps.unaligned_alignment) || !ps.unaligned_forward) {
+      ps.unaligned_forward = getPlan<T>(len, C2C_FORWARD, opt, alignment, num_threads);
+      ps.unaligned_backward = getPlan<T>(len, C2C_BACKWARD, opt, alignment, num_threads);
+      ps.unaligned_alignment = alignment; 
+    }
+    return forward ? ps.unaligned_forward : ps.unaligned_backward;     
+  }
   
-    forward_plan = fftwf_plan_dft_1d(len, f_dummy_in, f_dummy_out, 
-				     FFTW_FORWARD, fftw_flag);
-    backward_plan = fftwf_plan_dft_1d(len, f_dummy_in, f_dummy_out, 
-				      FFTW_BACKWARD, fftw_flag); // ESTIMATE);
+  void FFT::clearPlanCache() {
+    // swap the cache out while we hold the lock, then let the
+    // plans go after we've released it -- Plan::~Plan needs the planner lock. 
+    std::map<PlanKey, std::shared_future<FFT::PlanPtr>> old_cache; 
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex);
+      old_cache.swap(plan_cache);
+    }
+  }
 
-    fftwf_free(f_dummy_in);
-    fftwf_free(f_dummy_out);
+  unsigned int FFT::getPlanCacheSize() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return plan_cache.size();
   }
+
+  // the wisdom functions all touch planner state, so the caller
+  // must hold planner_mutex.  The file locks keep other processes
+  // from reading a half-written file, or writing at the same time. 
+  template<typename T>
+  static bool importWisdomFile(const std::string & path) {
+    FILE * wf = fopen(path.c_str(), "r");
+    if(wf == nullptr) return false;
+
+    flock(fileno(wf), LOCK_SH);
+    // fftw leaves the current wisdom alone if it can't parse the file. 
+    bool ret = FFTW<T>::importWisdom(wf) != 0;
+    flock(fileno(wf), LOCK_UN);
+    fclose(wf);
     
-  void FFT::fft(std::vector<std::complex<float>> & in, 
-		std::vector<std::complex<float>> & out) {
-    if(in.size() != out.size()) {
-      throw UnmatchedSizes("fft", in.size(), out.size());
+    return ret; 
+  }
+
+  template<typename T>
+  static bool writeWisdomFile(const std::string & path) {
+    // write to a temporary and rename it into place, so readers
+    // never see a partial file. 
+    auto tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+    bool ret = false; 
+    FILE * wf = fopen(tmp_path.c_str(), "w");
+    if(wf != nullptr) {
+      FFTW<T>::exportWisdom(wf);
+      ret = (fclose(wf) == 0);
+      if(ret) {
+	ret = (rename(tmp_path.c_str(), path.c_str()) == 0);
+      }
+      if(!ret) {
+	unlink(tmp_path.c_str());
+      }
     }
-    if(in.size() != len) {
-      throw BadSize("fft", in.size(), len);
+    return ret; 
+  }
+  
+  bool FFT::importWisdom(const std::string & path) {
+    bool fret = importWisdomFile<float>(FFTW<float>::wisdomPath(path));
+    bool dret = importWisdomFile<double>(FFTW<double>::wisdomPath(path));
+    return fret || dret; 
+  }
+
+  bool FFT::exportWisdom(const std::string & path) {
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    // serialize writers with a lock file that sits beside the wisdom file. 
+    auto lock_path = path + ".lock";
+    int lock_fd = open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(lock_fd < 0) return false;
+    flock(lock_fd, LOCK_EX);
+
+    // pick up anything another process learned since we last looked
+    importWisdom(path);
+
+    bool ret = writeWisdomFile<float>(FFTW<float>::wisdomPath(path));
+    if(double_planned) {
+      ret = writeWisdomFile<double>(FFTW<double>::wisdomPath(path)) && ret;
     }
     
-    auto in_p = (fftwf_complex*) in.data();
-    auto out_p = (fftwf_complex*) out.data();    
-    bool do_fixup = false;
-    
-    if(fftwf_alignment_of((float*)in_p) != fftwf_alignment_of((float*)out_p)) {
-      // buffers are misaligned.  sigh. make a copy
-      in_p = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * in.size());
-      out_p = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * out.size());
-      for(int i = 0; i < in.size(); i++) {
-	in_p[i][0] = in[i].real();
-	in_p[i][1] = in[i].imag();
-      }
-      do_fixup = true; 
+    flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+    return ret; 
+  }
+  
+  bool FFT::loadWisdom(const std::string & path) {
+    std::lock_guard<std::mutex> lock(planner_mutex);
+    return importWisdom(path);
+  }
+
+  bool FFT::saveWisdom(const std::string & path) {
+    std::lock_guard<std::mutex> lock(planner_mutex);
+    return exportWisdom(path);
+  }
+
+  std::string FFT::getCacheDirectory() {
+    std::string cache_dir;
+    const char * xdg = getenv("XDG_CACHE_HOME");
+    const char * home = getenv("HOME");
+    if((xdg != nullptr) && (xdg[0] != '\0')) {
+      cache_dir = xdg; 
+    }
+    else if(home != nullptr) {
+      cache_dir = std::string(home) + "/.cache";
     }
     else {
-      in_p = (fftwf_complex*) in.data();
-      out_p = (fftwf_complex*) out.data();      
+      cache_dir = std::filesystem::temp_directory_path().string();
     }
-    
-    fftwf_execute_dft(forward_plan, in_p, out_p);
 
-    if(do_fixup) {
-      for(int i = 0; i < out.size(); i++) {
-	out[i] = std::complex<float>(out_p[i][0], out_p[i][1]);
-      }
-      fftwf_free(in_p);
-      fftwf_free(out_p);
+    return cache_dir + "/SoDa";
+  }
+  
+  std::string FFT::getDefaultWisdomPath() {
+    const char * env_path = getenv("SODA_FFTW_WISDOM");
+    if((env_path != nullptr) && (env_path[0] != '\0')) {
+      return std::string(env_path);
     }
+    
+    return getCacheDirectory() + "/fftwf_wisdom";
+  }
+  
+  bool FFT::enableWisdomCache(const std::string & path) {
+    std::lock_guard<std::mutex> lock(planner_mutex);
+    wisdom_cache_path = path.empty() ? getDefaultWisdomPath() : path;
+    return importWisdom(wisdom_cache_path);
+  }
+
+  void FFT::disableWisdomCache() {
+    std::lock_guard<std::mutex> lock(planner_mutex);
+    wisdom_cache_path.clear();
+  }
+    
+  void FFT::fft(std::vector<std::complex<float>> & in, 
+		std::vector<std::complex<float>> & out) {
+    transform(true, "fft", in.data(), in.size(), out.data(), out.size());
   }
 
   void FFT::ifft(std::vector<std::complex<float>> & in, 
 		 std::vector<std::complex<float>> & out) {
-    if(in.size() != out.size()) {
-      throw UnmatchedSizes("fft", in.size(), out.size());
+    transform(false, "ifft", in.data(), in.size(), out.data(), out.size());
+  }
+
+  template<typename T>
+  void FFT::transformT(bool forward, const char * who, 
+		       const std::complex<T> * in, size_t in_size,
+		       std::complex<T> * out, size_t out_size) {
+    typedef typename FFTW<T>::complex fcomplex; 
+    if(in_size != out_size) {
+      throw UnmatchedSizes(who, in_size, out_size);
+    }
+    if(in_size != len) {
+      throw BadSize(who, in_size, len);
     }
-    if(in.size() != len) {
-      throw BadSize("fft", in.size(), len);
+    
+    // fftw wants a non-const input, but an out-of-place complex
+    // transform doesn't write to it. 
+    auto in_p = (fcomplex*) const_cast<std::complex<T>*>(in);
+    auto out_p = (fcomplex*) out;
+    int in_align = FFTW<T>::alignmentOf((T*) in_p);
+    int out_align = FFTW<T>::alignmentOf((T*) out_p);
+
+    if(in_align == out_align) {
+      // the usual case -- and always the case for AlignedVector buffers
+      FFTW<T>::execute(FFTW<T>::get(*selectPlan<T>(forward, in_align)), in_p, out_p);
+      return; 
     }
 
-    auto in_p = (fftwf_complex*) in.data();
-    auto out_p = (fftwf_complex*) out.data();    
-    bool do_fixup = false;
-    if(fftwf_alignment_of((float*)in_p) != fftwf_alignment_of((float*)out_p)) {
-      // buffers are misaligned.  sigh. make a copy
-      in_p = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * in.size());
-      out_p = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * out.size());
-      for(int i = 0; i < in.size(); i++) {
-	in_p[i][0] = in[i].real();
-	in_p[i][1] = in[i].imag();
-      }
-      do_fixup = true; 
+    // buffers are misaligned with respect to each other. sigh.
+    // Run the aligned plan, bouncing the misaligned buffer(s)
+    // through the scratch buffers. 
+    auto & ps = getPlanSet<T>();
+    if(ps.scratch_in.size() != len) {
+      ps.scratch_in.resize(len);
+      ps.scratch_out.resize(len);
+    }
+    if(in_align != 0) {
+      std::copy(in, in + len, ps.scratch_in.begin());
+      in_p = (fcomplex*) ps.scratch_in.data();
+    }
+    if(out_align != 0) {
+      out_p = (fcomplex*) ps.scratch_out.data();
     }
     
-    fftwf_execute_dft(backward_plan, in_p, out_p);
+    FFTW<T>::execute(FFTW<T>::get(*selectPlan<T>(forward, 0)), in_p, out_p);
+
+    if(out_align != 0) {
+      std::copy(ps.scratch_out.begin(), ps.scratch_out.end(), out);
+    }
+  }
+
+  void FFT::transform(bool forward, const char * who, 
+		      const std::complex<float> * in, size_t in_size,
+		      std::complex<float> * out, size_t out_size) {
+    transformT(forward, who, in, in_size, out, out_size);
+  }
 
-    if(do_fixup) {
-      for(int i = 0; i < out.size(); i++) {
-	out[i] = std::complex<float>(out_p[i][0], out_p[i][1]);
+  void FFT::transform(bool forward, const char * who, 
+		      const std::complex<double> * in, size_t in_size,
+		      std::complex<double> * out, size_t out_size) {
+    transformT(forward, who, in, in_size, out, out_size);
+  }
+  
+  template<typename T>
+  void FFT::shiftedTransformT(const char * who, 
+			      const std::complex<T> * in, size_t in_size,
+			      std::complex<T> * out, size_t out_size) {
+    typedef typename FFTW<T>::complex fcomplex; 
+    if(in_size != out_size) {
+      throw UnmatchedSizes(who, in_size, out_size);
+    }
+    if(in_size != len) {
+      throw BadSize(who, in_size, len);
+    }
+
+    auto & ps = getPlanSet<T>();
+    if(ps.scratch_in.size() != len) {
+      ps.scratch_in.resize(len);
+      ps.scratch_out.resize(len);
+    }
+    
+    if((len & 1) != 0) {
+      // no modulation trick for odd lengths -- transform, then rotate. 
+      // Our plans are out-of-place, so an in-place call goes through
+      // the scratch buffer. 
+      if(in == out) {
+	std::copy(in, in + len, ps.scratch_in.begin());
+	in = ps.scratch_in.data();
       }
-      fftwf_free(in_p);
-      fftwf_free(out_p);
+      transformT(true, who, in, in_size, out, out_size);
+      rotate(out, out, len, (len + 1) / 2);
+      return; 
+    }
+
+    // x[n] * (-1)^n transforms to X[k - len/2], which is the shifted
+    // spectrum. We need a copy of the input in the (aligned) scratch
+    // buffer anyway, so flip the sign of the odd samples on the way. 
+    for(size_t i = 0; i < len; i += 2) {
+      ps.scratch_in[i] = in[i];
+      ps.scratch_in[i + 1] = -in[i + 1];
+    }
+
+    auto in_p = (fcomplex*) ps.scratch_in.data();
+    auto out_p = (fcomplex*) out;
+    bool out_aligned = FFTW<T>::alignmentOf((T*) out_p) == 0; 
+    if(!out_aligned) {
+      out_p = (fcomplex*) ps.scratch_out.data();
+    }
+    
+    FFTW<T>::execute(FFTW<T>::get(*selectPlan<T>(true, 0)), in_p, out_p);
+
+    if(!out_aligned) {
+      std::copy(ps.scratch_out.begin(), ps.scratch_out.end(), out);
     }
   }
+
+  void FFT::shiftedTransform(const char * who, 
+			     const std::complex<float> * in, size_t in_size,
+			     std::complex<float> * out, size_t out_size) {
+    shiftedTransformT(who, in, in_size, out, out_size);
+  }
+
+  void FFT::shiftedTransform(const char * who, 
+			     const std::complex<double> * in, size_t in_size,
+			     std::complex<double> * out, size_t out_size) {
+    shiftedTransformT(who, in, in_size, out, out_size);
+  }
   
-  void FFT::shift(std::vector<std::complex<float>> & in, 
-		  std::vector<std::complex<float>> & out) {
-    // the inputs must be the same size
-    if(in.size() != out.size()) {
-      throw UnmatchedSizes("shift", in.size(), out.size());
+  template<typename T>
+  void FFT::realTransformT(bool forward, const char * who, 
+			   T * rbuf, size_t r_size,
+			   std::complex<T> * cbuf, size_t c_size) {
+    typedef typename FFTW<T>::complex fcomplex; 
+    if(r_size != len) {
+      throw BadSize(who, r_size, len);
+    }
+    if(c_size != getHalfSpectrumSize()) {
+      throw BadSize(who, c_size, getHalfSpectrumSize());
+    }
+
+    auto c_p = (fcomplex*) cbuf;
+    // the plans for an aligned real buffer and complex buffer aren't
+    // any good for anything else, so anything that isn't aligned gets
+    // the unaligned plan. 
+    bool aligned = (FFTW<T>::alignmentOf(rbuf) == 0) && (FFTW<T>::alignmentOf((T*) c_p) == 0);
+
+    auto & ps = getPlanSet<T>();
+    PlanPtr & plan = forward ? (aligned ? ps.r2c : ps.unaligned_r2c) : 
+      (aligned ? ps.c2r : ps.unaligned_c2r);
+    if(!plan) {
+      plan = getPlan<T>(len, forward ? R2C : C2R, opt, aligned ? 0 : -1, num_threads);
+    }
+
+    if(forward) {
+      FFTW<T>::executeR2C(FFTW<T>::get(*plan), rbuf, c_p);
+    }
+    else {
+      FFTW<T>::executeC2R(FFTW<T>::get(*plan), c_p, rbuf);
+    }
+  }
+
+  void FFT::realTransform(bool forward, const char * who, 
+			  float * rbuf, size_t r_size,
+			  std::complex<float> * cbuf, size_t c_size) {
+    realTransformT(forward, who, rbuf, r_size, cbuf, c_size);
+  }
+
+  void FFT::realTransform(bool forward, const char * who, 
+			  double * rbuf, size_t r_size,
+			  std::complex<double> * cbuf, size_t c_size) {
+    realTransformT(forward, who, rbuf, r_size, cbuf, c_size);
+  }
+  
+  template<typename T>
+  void FFT::batchTransformT(bool forward, const char * who, 
+			    std::complex<T> * in, size_t in_size,
+			    std::complex<T> * out, size_t out_size,
+			    unsigned int num_channels, BatchLayout layout) {
+    typedef typename FFTW<T>::complex fcomplex; 
+    if(in_size != out_size) {
+      throw UnmatchedSizes(who, in_size, out_size);
     }
-    if((in.size() % 2) == 0) {
-      // for the even case, ishift and shift are the
-      // same. ishift gets it right....
-      return ishift(in, out);
+    if((num_channels == 0) || (in_size != size_t(len) * num_channels)) {
+      throw BadSize(who, in_size, len * num_channels);
     }
-    // take the middle and shift it down
-    // since in and out may be the same vectors, we
-    // make a copy. (Not a big deal.)
-    auto temp = in; 
-    unsigned int mid = (in.size() - 1) / 2;
-    unsigned int mod = in.size();
-    for(int i = 0; i < in.size(); i++) {
-      out[(mid + i) % mod] = temp[i];
+
+    if(num_channels == 1) {
+      // nothing to batch
+      transformT(forward, who, in, in_size, out, out_size);
+      return; 
     }
+    
+    auto in_p = (fcomplex*) in; 
+    auto out_p = (fcomplex*) out;
+    bool aligned = (FFTW<T>::alignmentOf((T*) in_p) == 0) && (FFTW<T>::alignmentOf((T*) out_p) == 0);
+
+    // batch plans are found in the plan cache every time -- that's cheap
+    // compared to transforming a handful of channels. 
+    auto plan = getPlan<T>(len, forward ? C2C_FORWARD : C2C_BACKWARD, opt, aligned ? 0 : -1, 
+			   num_threads, num_channels, layout);
+    FFTW<T>::execute(FFTW<T>::get(*plan), in_p, out_p);
+  }
+
+  void FFT::batchTransform(bool forward, const char * who, 
+			   std::complex<float> * in, size_t in_size,
+			   std::complex<float> * out, size_t out_size,
+			   unsigned int num_channels, BatchLayout layout) {
+    batchTransformT(forward, who, in, in_size, out, out_size, num_channels, layout);
+  }
+
+  void FFT::batchTransform(bool forward, const char * who, 
+			   std::complex<double> * in, size_t in_size,
+			   std::complex<double> * out, size_t out_size,
+			   unsigned int num_channels, BatchLayout layout) {
+    batchTransformT(forward, who, in, in_size, out, out_size, num_channels, layout);
   }
   
-  void FFT::ishift(std::vector<std::complex<float>> & in, 
-		   std::vector<std::complex<float>> & out) {
+  template<typename T>
+  static void rotateT(std::complex<T> * in, std::complex<T> * out, size_t n, size_t k) {
+    if(in != out) {
+      // one pass, straight into the output buffer.
+      std::rotate_copy(in, in + k, in + n, out);
+    }
+    else if((2 * k) == n) {
+      // even length: the two halves just trade places. 
+      std::swap_ranges(out, out + k, out + k); 
+    }
+    else {
+      // odd length: std::rotate follows the permutation cycles
+      // in place, without a temporary buffer.
+      std::rotate(out, out + k, out + n); 
+    }
+  }
+  
+  template<typename T>
+  static void ishiftT(std::vector<std::complex<T>> & in, 
+		      std::vector<std::complex<T>> & out) {
     // the inputs must be the same size
     if(in.size() != out.size()) {
-      throw UnmatchedSizes("ishift", in.size(), out.size());
+      throw FFT::UnmatchedSizes("ishift", in.size(), out.size());
     }
-    // take the middle and shift it down
-    // the two vectors must be distinct.
-    auto temp = in;
-    unsigned int mid = (in.size() + 1) / 2;
-    unsigned int mod = in.size();
-    for(int i = 0; i < in.size(); i++) {
-      out[(mid + i) % mod] = temp[i]; 
+    // take the middle and shift it down: out[(mid + i) % n] = in[i]
+    // where mid is (n + 1) / 2.  That's a left rotation by n / 2
+    rotateT(in.data(), out.data(), in.size(), in.size() / 2);
+  }
+
+  template<typename T>
+  static void shiftT(std::vector<std::complex<T>> & in, 
+		     std::vector<std::complex<T>> & out) {
+    // the inputs must be the same size
+    if(in.size() != out.size()) {
+      throw FFT::UnmatchedSizes("shift", in.size(), out.size());
     }
+    // move DC to the middle: out[(mid + i) % n] = in[i]
+    // where mid is n / 2.  That's a left rotation by (n + 1) / 2
+    // (for even lengths, shift and ishift are the same thing.)
+    rotateT(in.data(), out.data(), in.size(), (in.size() + 1) / 2);
+  }
+
+  void FFT::rotate(std::complex<float> * in, std::complex<float> * out, size_t n, size_t k) {
+    rotateT(in, out, n, k);
+  }
+
+  void FFT::rotate(std::complex<double> * in, std::complex<double> * out, size_t n, size_t k) {
+    rotateT(in, out, n, k);
+  }
+  
+  void FFT::shift(std::vector<std::complex<float>> & in, 
+		  std::vector<std::complex<float>> & out) {
+    shiftT(in, out);
+  }
+
+  void FFT::shift(std::vector<std::complex<double>> & in, 
+		  std::vector<std::complex<double>> & out) {
+    shiftT(in, out);
+  }
+  
+  void FFT::ishift(std::vector<std::complex<float>> & in, 
+		   std::vector<std::complex<float>> & out) {
+    ishiftT(in, out);
+  }
+
+  void FFT::ishift(std::vector<std::complex<double>> & in, 
+		   std::vector<std::complex<double>> & out) {
+    ishiftT(in, out);
   }
   
   uint32_t FFT::findGoodSize(uint32_t min_size) {
+    if(measuredSizesEnabled()) {
+      return findFastestSize(min_size);
+    }
+    
     // look for the nearest number of the form 2^n * 3^m * 5^p * 7^q
     // that is greater than min_size.
     //
@@ -208,6 +812,174 @@ namespace SoDa {
     }	
     return best_val; 
   }
+  // The timing table for findFastestSize: nanoseconds per
+  // forward transform, by length. (all protected by size_cost_mutex)
+  static std::mutex size_cost_mutex;
+  static std::map<uint32_t, double> size_costs;
+  static bool measured_sizes = false;
+  // if this isn't empty, new measurements are saved here. 
+  static std::string size_cost_path; 
+
+  // caller must hold size_cost_mutex.  Entries we've already
+  // measured in this process win over the ones in the file. 
+  static bool readSizeCosts(const std::string & path) {
+    FILE * cf = fopen(path.c_str(), "r");
+    if(cf == nullptr) return false;
+
+    flock(fileno(cf), LOCK_SH);
+    bool ret = false; 
+    char line[128];
+    while(fgets(line, sizeof(line), cf) != nullptr) {
+      unsigned int len;
+      double cost; 
+      if((line[0] != '#') && (sscanf(line, "%u %lf", &len, &cost) == 2)) {
+	size_costs.emplace(len, cost);
+	ret = true; 
+      }
+    }
+    flock(fileno(cf), LOCK_UN);
+    fclose(cf);
+    return ret; 
+  }
+
+  // caller must hold size_cost_mutex.  This follows the same
+  // lock-merge-rename dance as exportWisdom.
+  static bool writeSizeCosts(const std::string & path) {
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    auto lock_path = path + ".lock";
+    int lock_fd = open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(lock_fd < 0) return false;
+    flock(lock_fd, LOCK_EX);
+
+    // pick up anything another process measured since we last looked
+    readSizeCosts(path);
+
+    auto tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+    bool ret = false; 
+    FILE * cf = fopen(tmp_path.c_str(), "w");
+    if(cf != nullptr) {
+      fprintf(cf, "# SoDa FFT timing table: length  ns per complex float forward transform\n");
+      for(auto & e : size_costs) {
+	fprintf(cf, "%u %g\n", e.first, e.second);
+      }
+      ret = (fclose(cf) == 0);
+      if(ret) {
+	ret = (rename(tmp_path.c_str(), path.c_str()) == 0);
+      }
+      if(!ret) {
+	unlink(tmp_path.c_str());
+      }
+    }
+    
+    flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+    return ret; 
+  }
+
+  double FFT::lookupCost(uint32_t len, bool & added) {
+    auto it = size_costs.find(len);
+    if(it != size_costs.end()) return it->second;
+
+    // time it, with the same plan an FFT(len) would get.  The plan
+    // doesn't go through the plan cache, so it (and its twiddle
+    // tables) go away when we're done. 
+    unsigned int nthreads = threadsAvailable() ? getDefaultThreads() : 1; 
+    auto plan = makePlan<float>(len, C2C_FORWARD, ESTIMATE, 0, nthreads, 1, CHANNEL_MAJOR);
+    AlignedVector<std::complex<float>> in(len, std::complex<float>(1.0, -0.5)), out(len);
+    auto in_p = (fftwf_complex*) in.data();
+    auto out_p = (fftwf_complex*) out.data();
+    FFTW<float>::execute(FFTW<float>::get(*plan), in_p, out_p); // warm up the caches
+    
+    // Keep doubling the repetitions until we've run for
+    // a millisecond or so, to get past the clock resolution.
+    double cost;
+    for(unsigned int reps = 1; ; reps *= 2) {
+      auto start = std::chrono::steady_clock::now();
+      for(unsigned int i = 0; i < reps; i++) {
+	FFTW<float>::execute(FFTW<float>::get(*plan), in_p, out_p);
+      }
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      if((elapsed.count() > 1.0e6) || (reps >= (1 << 20))) {
+	cost = elapsed.count() / double(reps);
+	break; 
+      }
+    }
+    
+    size_costs[len] = cost;
+    added = true; 
+    return cost; 
+  }
+  
+  double FFT::getTransformCost(uint32_t len) {
+    std::lock_guard<std::mutex> lock(size_cost_mutex);
+    bool added = false; 
+    double ret = lookupCost(len, added);
+    if(added && !size_cost_path.empty()) {
+      writeSizeCosts(size_cost_path);
+    }
+    return ret; 
+  }
+
+  uint32_t FFT::findFastestSize(uint32_t min_size) {
+    // the next power of two is always a candidate, and we won't
+    // look any further than that. 
+    uint64_t max_size = 1;
+    while(max_size < min_size) max_size *= 2;
+
+    std::lock_guard<std::mutex> lock(size_cost_mutex);
+    bool added = false;
+    uint32_t best_size = max_size;
+    double best_cost = lookupCost(max_size, added);
+    for(uint64_t vn = 1; vn <= max_size; vn *= 2) {
+      for(uint64_t vm = vn; vm <= max_size; vm *= 3) {
+	for(uint64_t vp = vm; vp <= max_size; vp *= 5) {
+	  for(uint64_t vq = vp; vq <= max_size; vq *= 7) {
+	    if(vq < min_size) continue;
+	    double cost = lookupCost(vq, added);
+	    if((cost < best_cost) || ((cost == best_cost) && (vq < best_size))) {
+	      best_cost = cost;
+	      best_size = vq; 
+	    }
+	  }
+	}
+      }
+    }
+
+    if(added && !size_cost_path.empty()) {
+      writeSizeCosts(size_cost_path);
+    }
+    return best_size; 
+  }
+
+  bool FFT::enableMeasuredSizes(const std::string & path) {
+    std::lock_guard<std::mutex> lock(size_cost_mutex);
+    measured_sizes = true; 
+    size_cost_path = path.empty() ? getDefaultSizeCostPath() : path;
+    return readSizeCosts(size_cost_path);
+  }
+
+  void FFT::disableMeasuredSizes() {
+    std::lock_guard<std::mutex> lock(size_cost_mutex);
+    measured_sizes = false; 
+    size_cost_path.clear();
+  }
+
+  bool FFT::measuredSizesEnabled() {
+    std::lock_guard<std::mutex> lock(size_cost_mutex);
+    return measured_sizes; 
+  }
+
+  std::string FFT::getDefaultSizeCostPath() {
+    const char * env_path = getenv("SODA_FFT_SIZE_COSTS");
+    if((env_path != nullptr) && (env_path[0] != '\0')) {
+      return std::string(env_path);
+    }
+    return getCacheDirectory() + "/fft_size_costs";
+  }
+
 
 
   FFT::UnmatchedSizes::UnmatchedSizes(const std::string & st, unsigned int ins, unsigned int outs) :
@@ -221,5 +993,9 @@ namespace SoDa {
   std::shared_ptr<FFT> FFT::make(unsigned int len, FFTOpt opt) {
     return std::make_shared<FFT>(len, opt);
   }
+
+  std::shared_ptr<FFT> FFT::make(unsigned int len, FFTOpt opt, unsigned int num_threads) {
+    return std::make_shared<FFT>(len, opt, num_threads);
+  }
 }
 
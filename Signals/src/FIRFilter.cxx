@@ -0,0 +1,252 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FIRFilter.hxx"
+#include "FFT.hxx"
+#include "VectorKernels.hxx"
+#include <Utils/include/Format.hxx>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace SoDa {
+
+  FIRFilter::FIRFilter(float low_cutoff, float high_cutoff, float skirt, 
+		       float sample_rate, unsigned int buffer_size, 
+		       float stop_band_attenuation,
+		       float gain, 
+		       Filter::WindowChoice window) {
+    FilterSpec fspec(sample_rate, low_cutoff, high_cutoff, skirt,
+		     FilterSpec::COMPLEX,
+		     stop_band_attenuation);
+    // There's no FFT here, so there's no reason to pad out the taps
+    // the way OSFilter does.
+    fspec.estimateTaps(3, 501, Filter::tapEstimate(window));
+    makeFIRFilter(fspec, buffer_size, gain, window); 
+  }
+
+  FIRFilter::FIRFilter(FilterSpec & filter_spec, 
+		       unsigned int buffer_size,
+		       float gain, 
+		       Filter::WindowChoice window) {    
+    makeFIRFilter(filter_spec, buffer_size, gain, window); 
+  }
+
+  void FIRFilter::makeFIRFilter(FilterSpec & filter_spec, 
+				unsigned int _buffer_size,
+				float gain, 
+				Filter::WindowChoice window) {
+    buffer_size = _buffer_size;
+    
+    // Let Filter design it.  The gain is normalized to the peak of
+    // the frequency image, so give it plenty of bins to find the peak.
+    unsigned int design_size = FFT::findGoodSize(std::max(8 * filter_spec.getTaps(), 1024u));
+    Filter design(filter_spec, design_size, gain, window);
+    design.getImpulseResponse(taps);
+    edges = design.getFilterEdges();
+
+    unsigned int num_taps = taps.size(); 
+    rtaps.resize(num_taps);
+    rtaps_real.resize(num_taps);
+    rtaps_double.resize(num_taps);
+    rtaps_real_double.resize(num_taps);
+    for(int i = 0; i < num_taps; i++) {
+      auto & t = taps[num_taps - 1 - i];
+      rtaps[i] = t;
+      rtaps_real[i] = t.real();
+      rtaps_double[i] = t;
+      rtaps_real_double[i] = t.real();
+    }
+  }
+
+  void FIRFilter::getImpulseResponse(std::vector<std::complex<float>> & h) {
+    h = taps; 
+  }
+  
+  template<typename ST>
+  unsigned int FIRFilter::applyT(const ST * in_buf, size_t in_size, 
+				 ST * out_buf, size_t out_size, 
+				 float gain, 
+				 AlignedVector<ST> & hist,
+				 const std::vector<ST> & rtaps, 
+				 const std::string & st) {
+    if((in_size != buffer_size) || (out_size != buffer_size)) {
+      throw BadBufferSize(st, in_size, out_size, buffer_size); 
+    }
+
+    unsigned int save_count = rtaps.size() - 1; 
+    if(hist.size() != save_count + buffer_size) {
+      // the history starts out zero filled
+      hist.assign(save_count + buffer_size, ST(0.0));
+    }
+
+    // slide the tail of the last block to the front, then append the new block
+    std::copy(hist.end() - save_count, hist.end(), hist.begin());
+    std::copy(in_buf, in_buf + buffer_size, hist.begin() + save_count);
+
+    // the input is safe in hist now, so out_buf can be in_buf.
+    // One pass over the block per tap. 
+    std::fill(out_buf, out_buf + buffer_size, ST(0.0));
+    for(unsigned int j = 0; j < rtaps.size(); j++) {
+      VectorKernels::mulAcc(hist.data() + j, rtaps[j], out_buf, buffer_size);
+    }
+
+    if(gain != 1.0) {
+      // (the gain is a float or double, to match the sample precision)
+      decltype(std::abs(ST())) g = gain; 
+      VectorKernels::scale(out_buf, g, out_buf, buffer_size);
+    }
+    
+    return out_size; 
+  }
+
+  unsigned int FIRFilter::apply(std::vector<std::complex<float>> & in_buf, 
+				std::vector<std::complex<float>> & out_buf,
+				float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, hist, rtaps, "applyVCF");
+  }
+
+  unsigned int FIRFilter::apply(std::vector<float> & in_buf, 
+				std::vector<float> & out_buf, 
+				float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, hist_real, rtaps_real, "applyVF");
+  }
+
+  unsigned int FIRFilter::apply(std::vector<std::complex<double>> & in_buf, 
+				std::vector<std::complex<double>> & out_buf,
+				float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, hist_double, rtaps_double, "applyVCD");
+  }
+
+  unsigned int FIRFilter::apply(std::vector<double> & in_buf, 
+				std::vector<double> & out_buf, 
+				float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, hist_real_double, rtaps_real_double, "applyVD");
+  }
+
+  unsigned int FIRFilter::apply(const std::complex<float> * in_buf, 
+				std::complex<float> * out_buf,
+				unsigned int length, 
+				float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, hist, rtaps, "applyPCF");
+  }
+
+  unsigned int FIRFilter::apply(const float * in_buf, 
+				float * out_buf,
+				unsigned int length, 
+				float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, hist_real, rtaps_real, "applyPF");
+  }
+
+  unsigned int FIRFilter::apply(const std::complex<double> * in_buf, 
+				std::complex<double> * out_buf,
+				unsigned int length, 
+				float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, hist_double, rtaps_double, "applyPCD");
+  }
+
+  unsigned int FIRFilter::apply(const double * in_buf, 
+				double * out_buf,
+				unsigned int length, 
+				float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, hist_real_double, rtaps_real_double, "applyPD");
+  }
+
+  double FIRFilter::getTapCost() {
+    static std::mutex cost_mutex;
+    static double cost = 0.0;
+
+    std::lock_guard<std::mutex> lock(cost_mutex);
+    if(cost > 0.0) return cost; 
+
+    // time the inner loop of applyT on a typical block. Keep doubling
+    // the repetitions until we've run for a millisecond or so, to get
+    // past the clock resolution (just like FFT::getTransformCost)
+    const unsigned int len = 1024;
+    const unsigned int num_taps = 16; 
+    AlignedVector<std::complex<float>> x(len + num_taps, std::complex<float>(1.0, -0.5));
+    AlignedVector<std::complex<float>> y(len, std::complex<float>(0.0, 0.0));
+    std::complex<float> t(0.25, 0.125);
+    for(unsigned int reps = 1; ; reps *= 2) {
+      auto start = std::chrono::steady_clock::now();
+      for(unsigned int i = 0; i < reps; i++) {
+	for(unsigned int j = 0; j < num_taps; j++) {
+	  VectorKernels::mulAcc(x.data() + j, t, y.data(), len);
+	}
+      }
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      if((elapsed.count() > 1.0e6) || (reps >= (1 << 20))) {
+	cost = elapsed.count() / (double(reps) * double(len) * double(num_taps));
+	break; 
+      }
+    }
+    return cost; 
+  }
+
+  bool FIRFilter::directIsFaster(unsigned int num_taps, unsigned int buffer_size) {
+    double direct_cost = double(num_taps) * double(buffer_size) * getTapCost();
+    
+    uint32_t fft_size = FFT::findGoodSize(buffer_size + num_taps - 1);
+    // forward and inverse transforms, and the bin by bin multiply
+    // (which costs about the same as a tap)
+    double os_cost = 2.0 * FFT::getTransformCost(fft_size) + double(fft_size) * getTapCost();
+
+    return direct_cost < os_cost; 
+  }
+  
+  FIRFilter::BadBufferSize::BadBufferSize(const std::string & st, 
+					  unsigned int in, 
+					  unsigned int out, 
+					  unsigned int req) :
+	std::runtime_error(SoDa::Format("FIRFilter::%3 input and output buffer sizes (%0 and %1) must be equal to %2\n")
+			   .addI(in)
+			   .addI(out)
+			   .addI(req)
+			   .addS(st)
+			   .str()) { }
+
+  FIRFilterPtr FIRFilter::make(FilterSpec & filter_spec, 
+			       unsigned int buffer_size,
+			       float gain, 
+			       Filter::WindowChoice window) {
+    return std::make_shared<FIRFilter>(filter_spec, buffer_size, gain, window);
+  }
+
+  FIRFilterPtr FIRFilter::make(float low_cutoff, 
+			       float high_cutoff, 
+			       float skirt,
+			       float sample_rate, 
+			       unsigned int buffer_size,
+			       float stop_band_attenuation,
+			       float gain,
+			       Filter::WindowChoice window) {
+    return std::make_shared<FIRFilter>(low_cutoff, high_cutoff, skirt,
+				       sample_rate, buffer_size,
+				       stop_band_attenuation, gain, window);
+  }
+}
@@ -27,11 +27,33 @@
  */
 
 #include "Filter.hxx"
+#include "VectorKernels.hxx"
+#include "Remez.hxx"
 #include <iostream>
 #include <fstream>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <list>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
 #include <Utils/include/Format.hxx>
 
 namespace SoDa {
+
+  // The read-only part of a filter. Once a Design is built, only the
+  // double precision image changes, and that just once. 
+  struct Filter::Design {
+    std::vector<std::complex<float>> taps; ///< the impulse response, before image_scale
+    double image_scale; ///< the scale applied to the transform of the taps
+    Image<float> float_image; ///< always built
+    mutable Image<double> double_image; ///< built when somebody first asks for it
+    mutable std::once_flag double_once; 
+  };
   
   Filter::Filter(float low_cutoff, float high_cutoff, float skirt, 
 		 float sample_rate,
@@ -65,16 +87,21 @@ namespace SoDa {
   void Filter::makeFilter(std::vector<std::complex<float>> Hproto, 
 			  unsigned int _buffer_size, 
 			  float gain, 
-			  WindowChoice window_choice) {
+			  WindowChoice window_choice,
+			  float stop_band_attenuation_dB,
+			  unsigned int _num_taps) {
     buffer_size = _buffer_size;
 
-    auto num_taps = Hproto.size();
+    unsigned int proto_size = Hproto.size();
+    unsigned int num_taps = (_num_taps == 0) ? proto_size : _num_taps;
     
-    std::vector<std::complex<float>> hproto(num_taps);    
+    std::vector<std::complex<float>> hproto(proto_size);    
 
     // now we've got a frequency domain prototype.
     // first shift it to fit the FFT picture
-    FFT pfft(num_taps);
+    // (the plans for this come from the FFT plan cache, so
+    // this is cheap if we've seen this prototype size before.)
+    FFT pfft(proto_size);
 
     pfft.shift(Hproto, Hproto);
 
@@ -84,6 +111,14 @@ namespace SoDa {
     // shift that back to 0 in the middle
     pfft.ishift(hproto, hproto);
 
+    // if the prototype was sampled more finely than the filter is
+    // long, keep the middle of the impulse response
+    if(num_taps < proto_size) {
+      unsigned int first = proto_size / 2 - num_taps / 2;
+      std::copy(hproto.begin() + first, hproto.begin() + first + num_taps, hproto.begin());
+      hproto.resize(num_taps);
+    }
+
     // now apply a window
     std::vector<float> window(num_taps);    
     bool apply_window = true; 
@@ -97,6 +132,10 @@ namespace SoDa {
     case BLACKMAN:
       blackmanWindow(window);
       break; 
+    case KAISER:
+    case EQUIRIPPLE:
+      kaiserWindow(window, kaiserBeta(stop_band_attenuation_dB));
+      break; 
     default:
       apply_window = false; 
     }
@@ -108,23 +147,23 @@ namespace SoDa {
     }
 
 
+    makeImage(hproto, gain); 
+  }
+
+  void Filter::makeImage(const std::vector<std::complex<float>> & taps, float gain) {
+    auto new_design = std::make_shared<Design>();
+    new_design->taps = taps; 
+    
     // so now we have the time domain prototype.
     // embed it in the impulse response of the appropriate length
-    h.resize(buffer_size);
-    auto f21 = std::unique_ptr<FFT>(new FFT(buffer_size));
-
-    for(int i = 0; i < num_taps; i++) {
-      h[i] = hproto[i];
-    }
-
-    // zero the rest
-    for(int i = num_taps; i < buffer_size; i++) {
-      h[i] = std::complex<float>(0.0, 0.0);
-    }
+    // (zero the rest)
+    AlignedVector<std::complex<float>> h(buffer_size, std::complex<float>(0.0, 0.0));
+    std::copy(taps.begin(), taps.end(), h.begin());
 
     // now make the frequency domain filter
     
     fft = std::unique_ptr<FFT>(new FFT(buffer_size));
+    auto & H = new_design->float_image.H; 
     H.resize(buffer_size);
     
     fft->fft(h, H);
@@ -136,13 +175,71 @@ namespace SoDa {
       auto vm = std::abs(v); 
       max = std::max(vm, max); 
     }
-    float scale = 1.0 / max;
+    // The inverse FFT doesn't normalize, so fold the 1/buffer_size
+    // in here, along with the gain. That saves a multiply per bin
+    // in every apply call. 
+    new_design->image_scale = double(gain) / (double(max) * double(buffer_size));
     
     for(auto & v : H) {
-      v = v * scale * gain;
+      v = v * float(new_design->image_scale);
     }
+
+    makeHalfImage(new_design->float_image, buffer_size);
+
+    // the double precision image is made when somebody asks for it. 
+    design = new_design; 
+  }
+
+  Filter::Filter(const Filter & other) :
+    design(other.design), buffer_size(other.buffer_size), sample_rate(other.sample_rate) {
+    // the plans come from the FFT plan cache, so this is cheap. 
+    fft = std::unique_ptr<FFT>(new FFT(buffer_size));
+  }
+  
+  template<typename T>
+  void Filter::makeHalfImage(Image<T> & img, unsigned int buffer_size) {
+    // The real valued apply methods see only the real part of h.
+    // The transform of Re(h) is the conjugate-symmetric part of H,
+    // and we only need the bottom half of that. 
+    img.H_half.resize(buffer_size / 2 + 1);
+    for(int i = 0; i < img.H_half.size(); i++) {
+      img.H_half[i] = T(0.5) * (img.H[i] + std::conj(img.H[(buffer_size - i) % buffer_size]));
+    }
+  }
+
+  template<>
+  const Filter::Image<float> & Filter::getImage<float>() {
+    return design->float_image; 
+  }
+
+  template<>
+  const Filter::Image<double> & Filter::getImage<double>() {
+    // our clones may be asking at the same time. 
+    std::call_once(design->double_once, [this]() {
+	// transform the impulse response again, in double precision, and
+	// scale it the same way we scaled the float image. 
+	auto & double_image = design->double_image; 
+	AlignedVector<std::complex<double>> hd(buffer_size, std::complex<double>(0.0, 0.0));
+	std::copy(design->taps.begin(), design->taps.end(), hd.begin());
+	double_image.H.resize(buffer_size);
+	fft->fft(hd, double_image.H);
+	for(auto & v : double_image.H) {
+	  v = v * design->image_scale;
+	}
+	makeHalfImage(double_image, buffer_size);
+      });
+    return design->double_image; 
+  }
+
+  template<>
+  Filter::Scratch<float> & Filter::getScratch<float>() {
+    return float_scratch; 
+  }
+
+  template<>
+  Filter::Scratch<double> & Filter::getScratch<double>() {
+    return double_scratch; 
   }
-    
   
   void Filter::makeFilter(FilterSpec & filter_spec, 
 			  unsigned int _buffer_size, 
@@ -152,14 +249,271 @@ namespace SoDa {
     buffer_size = _buffer_size;
     auto num_taps = filter_spec.getTaps();    
 
+    // have we built this one before? 
+    auto key = designKey(filter_spec, buffer_size, gain, window);
+    auto design = findDesign(key, buffer_size);
+    if(design != nullptr) {
+      useDesign(design);
+      return; 
+    }
+    
+    if(window == EQUIRIPPLE) {
+      // no prototype, no window. The Remez exchange makes the taps.
+      Remez remez(filter_spec);
+      std::vector<std::complex<float>> taps;
+      remez.design(num_taps, taps);
+      makeImage(taps, gain);
+      saveDesign(key);
+      return; 
+    }
+
+    // Kaiser's formulas for the window shape and length assume that
+    // the window is applied to the ideal impulse response.  A
+    // prototype sampled at only num_taps frequencies gives a periodic
+    // sinc instead, which doesn't die away toward the ends of the
+    // window, and that costs several dB of stop band.  So sample the
+    // prototype more finely and trim the impulse response back to
+    // num_taps.
+    unsigned int oversample = (window == KAISER) ? KAISER_OVERSAMPLE : 1;
+    
     // first create a frequency domain ideal filter:
-    std::vector<std::complex<float>> Hproto(num_taps);
+    std::vector<std::complex<float>> Hproto(num_taps * oversample);
 
+    filter_spec.setTaps(num_taps * oversample);
     filter_spec.fillHproto(Hproto);
+    filter_spec.setTaps(num_taps);
+
+    makeFilter(Hproto, buffer_size, gain, window, filter_spec.getStopBandAttenuation(), num_taps);
+
+    saveDesign(key);
+  }
+
+  // The design cache, and the design file directory.
+  // (all protected by design_mutex)
+  static std::mutex design_mutex;
+  // Each design remembers its place in design_order, so that a hit
+  // can move it to the back.  The front is the least recently used. 
+  struct DesignEntry {
+    Filter::DesignPtr design; 
+    std::list<std::string>::iterator order; 
+  };
+  static std::map<std::string, DesignEntry> designs;
+  static std::list<std::string> design_order; // least recently used first
+  // if this isn't empty, designs are saved here
+  static std::string design_path; 
+
+  // FNV-1a -- the design file name is the hash of the recipe
+  static uint64_t hashKey(const std::string & key) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(unsigned char c : key) {
+      hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash; 
+  }
+
+  static std::string designFileName(const std::string & dir, const std::string & key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.design", (unsigned long long) hashKey(key));
+    return dir + "/" + name; 
+  }
+  
+  std::string Filter::designKey(FilterSpec & filter_spec, 
+				unsigned int buffer_size, 
+				float gain, 
+				WindowChoice window) {
+    // floats are written in hex, so that the key is exact. 
+    std::string key;
+    char buf[128]; 
+    snprintf(buf, sizeof(buf), "V%u fs %a type %d taps %u A %a ripple %a window %d gain %a size %u :", 
+	     DESIGN_VERSION,
+	     double(filter_spec.getSampleRate()), int(filter_spec.getFilterType()), 
+	     filter_spec.getTaps(), 
+	     double(filter_spec.getStopBandAttenuation()), double(filter_spec.getPassBandRipple()), 
+	     int(window), double(gain), buffer_size);
+    key = buf; 
+    for(const auto & c : filter_spec.getSpec()) {
+      snprintf(buf, sizeof(buf), " %a %a", double(c.freq), double(c.gain));
+      key += buf; 
+    }
+    return key; 
+  }
 
-    makeFilter(Hproto, buffer_size, gain, window);
+  // caller must hold design_mutex. Put a design in the cache (or
+  // replace it) as the most recently used, and make room if we need to. 
+  static void cacheDesign(const std::string & key, Filter::DesignPtr design) {
+    auto it = designs.find(key);
+    if(it != designs.end()) {
+      design_order.splice(design_order.end(), design_order, it->second.order);
+      it->second.design = design; 
+      return; 
+    }
+    design_order.push_back(key);
+    designs[key] = DesignEntry{design, std::prev(design_order.end())};
+    if(designs.size() > Filter::DESIGN_CACHE_LIMIT) {
+      designs.erase(design_order.front());
+      design_order.pop_front();
+    }
+  }
+  
+  Filter::DesignPtr Filter::findDesign(const std::string & key, unsigned int buffer_size) {
+    std::lock_guard<std::mutex> lock(design_mutex);
+    auto it = designs.find(key);
+    if(it != designs.end()) {
+      // a hit makes this the most recently used design
+      design_order.splice(design_order.end(), design_order, it->second.order);
+      return it->second.design;
+    }
+
+    if(design_path.empty()) return nullptr;
+
+    auto design = readDesignFile(designFileName(design_path, key), key, buffer_size);
+    if(design != nullptr) {
+      cacheDesign(key, design);
+    }
+    return design; 
+  }
+
+  void Filter::saveDesign(const std::string & key) {
+    std::lock_guard<std::mutex> lock(design_mutex);
+    cacheDesign(key, design);
+    if(!design_path.empty()) {
+      writeDesignFile(designFileName(design_path, key), key, *design);
+    }
+  }
+
+  void Filter::useDesign(DesignPtr _design) {
+    // share the image with every other filter built from this recipe
+    design = _design; 
+    fft = std::unique_ptr<FFT>(new FFT(buffer_size));
+  }
+
+  // A design file is
+  //    the magic string "SoDaFilterDesign" (16 bytes)
+  //    the format version, a byte order mark, and the hash of the recipe
+  //    the recipe length and the recipe
+  //    the number of taps, the buffer size, and the image scale
+  //    the taps and the frequency image
+  // all in the native byte order.
+  static const char design_magic[] = "SoDaFilterDesign"; 
+  static const uint32_t design_bom = 0x01020304; 
+
+  Filter::DesignPtr Filter::readDesignFile(const std::string & path, const std::string & key, 
+					   unsigned int buffer_size) {
+    FILE * df = fopen(path.c_str(), "rb");
+    if(df == nullptr) return nullptr;
+
+    std::shared_ptr<Design> design; 
+    char magic[16];
+    uint32_t version, bom, key_len, taps_len, image_len;
+    uint64_t hash;
+    double scale; 
+    bool ok = (fread(magic, 1, 16, df) == 16) && (memcmp(magic, design_magic, 16) == 0)
+      && (fread(&version, sizeof(version), 1, df) == 1) && (version == DESIGN_VERSION)
+      && (fread(&bom, sizeof(bom), 1, df) == 1) && (bom == design_bom)
+      && (fread(&hash, sizeof(hash), 1, df) == 1) && (hash == hashKey(key))
+      && (fread(&key_len, sizeof(key_len), 1, df) == 1) && (key_len == key.size());
+    if(ok) {
+      // a different recipe with the same hash won't do. 
+      std::string file_key(key_len, ' ');
+      ok = (fread(&file_key[0], 1, key_len, df) == key_len) && (file_key == key)
+	&& (fread(&taps_len, sizeof(taps_len), 1, df) == 1)
+	&& (fread(&image_len, sizeof(image_len), 1, df) == 1)
+	&& (fread(&scale, sizeof(scale), 1, df) == 1)
+	&& (taps_len <= image_len) && (image_len == buffer_size);
+    }
+    if(ok) {
+      design = std::make_shared<Design>();
+      design->taps.resize(taps_len);
+      design->float_image.H.resize(image_len);
+      design->image_scale = scale;
+      ok = (fread(design->taps.data(), sizeof(std::complex<float>), taps_len, df) == taps_len)
+	&& (fread(design->float_image.H.data(), sizeof(std::complex<float>), image_len, df) == image_len);
+    }
+    fclose(df);
+    
+    if(!ok) return nullptr; 
+    makeHalfImage(design->float_image, image_len);
+    return design; 
+  }
+
+  bool Filter::writeDesignFile(const std::string & path, const std::string & key, 
+			       const Design & design) {
+    // write to a temporary and rename it into place, so readers
+    // never see a partial file. Two processes writing the same
+    // design write the same bits, so there's no need for a lock. 
+    auto tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+    FILE * df = fopen(tmp_path.c_str(), "wb");
+    if(df == nullptr) return false;
+
+    uint32_t version = DESIGN_VERSION;
+    uint64_t hash = hashKey(key);
+    uint32_t key_len = key.size();
+    uint32_t taps_len = design.taps.size();
+    uint32_t image_len = design.float_image.H.size();
+    bool ret = (fwrite(design_magic, 1, 16, df) == 16)
+      && (fwrite(&version, sizeof(version), 1, df) == 1)
+      && (fwrite(&design_bom, sizeof(design_bom), 1, df) == 1)
+      && (fwrite(&hash, sizeof(hash), 1, df) == 1)
+      && (fwrite(&key_len, sizeof(key_len), 1, df) == 1)
+      && (fwrite(key.data(), 1, key_len, df) == key_len)
+      && (fwrite(&taps_len, sizeof(taps_len), 1, df) == 1)
+      && (fwrite(&image_len, sizeof(image_len), 1, df) == 1)
+      && (fwrite(&design.image_scale, sizeof(design.image_scale), 1, df) == 1)
+      && (fwrite(design.taps.data(), sizeof(std::complex<float>), taps_len, df) == taps_len)
+      && (fwrite(design.float_image.H.data(), sizeof(std::complex<float>), image_len, df) == image_len);
+    ret = (fclose(df) == 0) && ret;
+    if(ret) {
+      ret = (rename(tmp_path.c_str(), path.c_str()) == 0);
+    }
+    if(!ret) {
+      unlink(tmp_path.c_str());
+    }
+    return ret; 
+  }
+  
+  void Filter::clearDesignCache() {
+    std::lock_guard<std::mutex> lock(design_mutex);
+    designs.clear();
+    design_order.clear();
+  }
+
+  unsigned int Filter::getDesignCacheSize() {
+    std::lock_guard<std::mutex> lock(design_mutex);
+    return designs.size(); 
+  }
+
+  bool Filter::enableDesignFiles(const std::string & path) {
+    std::lock_guard<std::mutex> lock(design_mutex);
+    design_path = path.empty() ? getDefaultDesignPath() : path;
+    std::error_code ec;
+    std::filesystem::create_directories(design_path, ec);
+    return std::filesystem::is_directory(design_path, ec);
+  }
+
+  void Filter::disableDesignFiles() {
+    std::lock_guard<std::mutex> lock(design_mutex);
+    design_path.clear();
+  }
+
+  std::string Filter::getDefaultDesignPath() {
+    const char * env_path = getenv("SODA_FILTER_DESIGNS");
+    if((env_path != nullptr) && (env_path[0] != '\0')) {
+      return std::string(env_path);
+    }
+    return FFT::getCacheDirectory() + "/filter_designs";
   }
 
+  FilterSpec::TapEstimate Filter::tapEstimate(WindowChoice window) {
+    switch (window) {
+    case KAISER:
+      return FilterSpec::KAISER;
+    case EQUIRIPPLE:
+      return FilterSpec::EQUIRIPPLE;
+    default:
+      return FilterSpec::HARRIS; 
+    }
+  }
+  
   void Filter::hammingWindow(std::vector<float> & w) {
     int M = w.size();
     
@@ -187,79 +541,249 @@ namespace SoDa {
 	+ 0.08 * cos(anginc * float(i) * 2.0);
     }
   }
+
+  void Filter::hammingWindow(std::vector<double> & w) {
+    int M = w.size();
+    
+    double anginc = 2 * M_PI / ((double) (M - 1));
+    for(int i = 0; i < M; i++) {
+      w[i] = 0.54 - 0.46 * cos(anginc * (double(i)));
+    }
+  }
+
+  void Filter::hannWindow(std::vector<double> & w) {
+    int M = w.size();
+    
+    double anginc = 2 * M_PI / ((double) (M - 1));
+    for(int i = 0; i < M; i++) {
+      w[i] = 0.5 - 0.5 * cos(anginc * (double(i)));
+    }
+  }
+
+  void Filter::blackmanWindow(std::vector<double> & w) {
+    int M = w.size();
+    
+    double anginc = 2 * M_PI / ((double) (M - 1));
+    for(int i = 0; i < M; i++) {
+      w[i] = 0.42 - 0.5 * cos(anginc * (double(i))) 
+	+ 0.08 * cos(anginc * double(i) * 2.0);
+    }
+  }
   
   
-  unsigned int Filter::apply(std::vector<std::complex<float>> & in_buf, 
-			     std::vector<std::complex<float>> & out_buf, 
-			     InOutMode in_out_mode) {
-    if((in_buf.size() != buffer_size) || (out_buf.size() != buffer_size)) {
-      throw BadBufferSize("apply", in_buf.size(), out_buf.size(), buffer_size); 
+  // the zeroth order modified Bessel function of the first kind,
+  // from its power series. The terms fall off fast enough for any
+  // beta we'd use. 
+  static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double q = 0.25 * x * x; 
+    for(int k = 1; k < 200; k++) {
+      term = term * q / (double(k) * double(k));
+      sum += term; 
+      if(term < 1e-12 * sum) break; 
+    }
+    return sum; 
+  }
+  
+  void Filter::kaiserWindow(std::vector<float> & w, float beta) {
+    int M = w.size();
+    if(M == 1) {
+      w[0] = 1.0;
+      return; 
+    }
+    
+    double denom = besselI0(beta);
+    for(int i = 0; i < M; i++) {
+      double r = 2.0 * double(i) / double(M - 1) - 1.0;
+      w[i] = besselI0(beta * sqrt(std::max(0.0, 1.0 - r * r))) / denom;
+    }
+  }
+
+  float Filter::kaiserBeta(float A) {
+    if(A > 50.0) return 0.1102 * (A - 8.7);
+    else if(A >= 21.0) return 0.5842 * pow(A - 21.0, 0.4) + 0.07886 * (A - 21.0);
+    else return 0.0; 
+  }
+  
+  template<typename T>
+  unsigned int Filter::applyT(const std::complex<T> * in_buf, size_t in_size, 
+			      std::complex<T> * out_buf, size_t out_size, 
+			      InOutMode in_out_mode) {
+    if((in_size != buffer_size) || (out_size != buffer_size)) {
+      throw BadBufferSize("apply", in_size, out_size, buffer_size); 
     }
+    auto & img = getImage<T>();
+    auto & temp_buf = getScratch<T>().temp_buf; 
     if(temp_buf.size() != buffer_size) {
       temp_buf.resize(buffer_size); 
     }
 
-    std::vector<std::complex<float>> * tbuf_ptr;
+    // the transform of the input lands in temp_buf, unless
+    // the caller has already done it for us.
+    const std::complex<T> * spec_ptr;
     if(in_out_mode.xform_in) {
       // first do the transform
-      fft->fft(in_buf, temp_buf);
-      tbuf_ptr = & temp_buf; 
+      fft->fft(in_buf, temp_buf.data(), buffer_size);
+      spec_ptr = temp_buf.data(); 
     }
     else {
       // we're already taking a transform as input. 
-      tbuf_ptr = & in_buf; 
+      spec_ptr = in_buf; 
     }
-    
-    float scale = 1.0 / float(H.size());
+
+    // H already includes the 1/buffer_size normalization
+    auto & H = img.H; 
     if(in_out_mode.xform_out) {
-      // now multiply
-      for(int i = 0; i < tbuf_ptr->size(); i++) {
-	(*tbuf_ptr)[i] = (*tbuf_ptr)[i] * H[i] * scale;
-      }
+      // now multiply -- into temp_buf, never into the caller's input
+      VectorKernels::mul(spec_ptr, H.data(), temp_buf.data(), buffer_size);
       // invert
-      fft->ifft(*tbuf_ptr, out_buf); 
+      fft->ifft(temp_buf.data(), out_buf, buffer_size);
     }
     else {
       // they want frequency output
       // multiply directly into output buffer
-      for(int i = 0; i < out_buf.size(); i++) {
-	out_buf[i] = (*tbuf_ptr)[i] * H[i] * scale;
-      }
+      VectorKernels::mul(spec_ptr, H.data(), out_buf, buffer_size);
     }
-    return in_buf.size();
+    return in_size;
   }
 
-  unsigned int Filter::apply(std::vector<float> & in_buf, 
-			     std::vector<float> & out_buf, 
+  unsigned int Filter::apply(std::vector<std::complex<float>> & in_buf, 
+			     std::vector<std::complex<float>> & out_buf, 
 			     InOutMode in_out_mode) {
-    if((in_buf.size() != buffer_size) || (out_buf.size() != buffer_size)) {
-      throw BadBufferSize("apply", in_buf.size(), out_buf.size(), buffer_size); 
-    }
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), in_out_mode);
+  }
 
-    if(temp_in_buf.size() != buffer_size) {
-      temp_in_buf.resize(buffer_size); 
-    }
-    if(temp_out_buf.size() != buffer_size) {
-      temp_out_buf.resize(buffer_size); 
+  unsigned int Filter::apply(AlignedVector<std::complex<float>> & in_buf, 
+			     AlignedVector<std::complex<float>> & out_buf, 
+			     InOutMode in_out_mode) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), in_out_mode);
+  }
+
+  unsigned int Filter::apply(std::vector<std::complex<double>> & in_buf, 
+			     std::vector<std::complex<double>> & out_buf, 
+			     InOutMode in_out_mode) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), in_out_mode);
+  }
+
+  unsigned int Filter::apply(AlignedVector<std::complex<double>> & in_buf, 
+			     AlignedVector<std::complex<double>> & out_buf, 
+			     InOutMode in_out_mode) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), in_out_mode);
+  }
+
+  unsigned int Filter::apply(const std::complex<float> * in_buf, 
+			     std::complex<float> * out_buf, 
+			     unsigned int length, 
+			     InOutMode in_out_mode) {
+    return applyT(in_buf, length, out_buf, length, in_out_mode);
+  }
+
+  unsigned int Filter::apply(const std::complex<double> * in_buf, 
+			     std::complex<double> * out_buf, 
+			     unsigned int length, 
+			     InOutMode in_out_mode) {
+    return applyT(in_buf, length, out_buf, length, in_out_mode);
+  }
+  
+  template<typename T>
+  unsigned int Filter::applyRealT(const T * in_buf, size_t in_size, 
+				  T * out_buf, size_t out_size) {
+    if((in_size != buffer_size) || (out_size != buffer_size)) {
+      throw BadBufferSize("apply", in_size, out_size, buffer_size); 
     }
-    // first fill a complex vector
-    for(int i = 0; i < in_buf.size(); i++) {
-      temp_in_buf[i] = std::complex<float>(in_buf[i], 0.0); 
+
+    auto & img = getImage<T>();
+    auto & temp_half_buf = getScratch<T>().temp_half_buf; 
+    if(temp_half_buf.size() != img.H_half.size()) {
+      temp_half_buf.resize(img.H_half.size()); 
     }
-    // now apply 
-    apply(temp_in_buf, temp_out_buf);
 
-    for(int i = 0; i < out_buf.size(); i++) {
-      out_buf[i] = temp_out_buf[i].real();
+    // a real input has a conjugate-symmetric transform, so we
+    // only need to push half of it through the filter. 
+    fft->rfft(in_buf, temp_half_buf.data(), buffer_size);
+    applyHalfSpectrum(temp_half_buf, temp_half_buf);
+    fft->irfft(temp_half_buf.data(), out_buf, buffer_size);
+
+    return in_size;    
+  }
+  
+  unsigned int Filter::apply(std::vector<float> & in_buf, 
+			     std::vector<float> & out_buf, 
+			     InOutMode in_out_mode) {
+    return applyRealT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size()); 
+  }
+
+  unsigned int Filter::apply(AlignedVector<float> & in_buf, 
+			     AlignedVector<float> & out_buf, 
+			     InOutMode in_out_mode) {
+    return applyRealT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size()); 
+  }
+
+  unsigned int Filter::apply(std::vector<double> & in_buf, 
+			     std::vector<double> & out_buf, 
+			     InOutMode in_out_mode) {
+    return applyRealT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size()); 
+  }
+
+  unsigned int Filter::apply(AlignedVector<double> & in_buf, 
+			     AlignedVector<double> & out_buf, 
+			     InOutMode in_out_mode) {
+    return applyRealT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size()); 
+  }
+
+  unsigned int Filter::apply(const float * in_buf, 
+			     float * out_buf, 
+			     unsigned int length, 
+			     InOutMode in_out_mode) {
+    return applyRealT(in_buf, length, out_buf, length); 
+  }
+
+  unsigned int Filter::apply(const double * in_buf, 
+			     double * out_buf, 
+			     unsigned int length, 
+			     InOutMode in_out_mode) {
+    return applyRealT(in_buf, length, out_buf, length); 
+  }
+
+  template<typename T>
+  unsigned int Filter::applyHalfSpectrumT(AlignedVector<std::complex<T>> & in_buf, 
+					  AlignedVector<std::complex<T>> & out_buf) {
+    auto & img = getImage<T>();
+    auto & H_half = img.H_half; 
+    if((in_buf.size() != H_half.size()) || (out_buf.size() != H_half.size())) {
+      throw BadBufferSize("applyHalfSpectrum", in_buf.size(), out_buf.size(), H_half.size()); 
     }
-    return in_buf.size();    
+
+    VectorKernels::mul(in_buf.data(), H_half.data(), out_buf.data(), H_half.size());
+    return in_buf.size();
+  }
+  
+  unsigned int Filter::applyHalfSpectrum(AlignedVector<std::complex<float>> & in_buf, 
+					 AlignedVector<std::complex<float>> & out_buf) {
+    return applyHalfSpectrumT(in_buf, out_buf);
+  }
+
+  unsigned int Filter::applyHalfSpectrum(AlignedVector<std::complex<double>> & in_buf, 
+					 AlignedVector<std::complex<double>> & out_buf) {
+    return applyHalfSpectrumT(in_buf, out_buf);
   }
   
+  void Filter::getImpulseResponse(std::vector<std::complex<float>> & taps) {
+    // image_scale includes the 1/buffer_size for the inverse transform.
+    // The taps don't need that. 
+    float scale = design->image_scale * double(buffer_size);
+    taps.resize(design->taps.size());
+    for(int i = 0; i < taps.size(); i++) {
+      taps[i] = design->taps[i] * scale; 
+    }
+  }
   
   std::pair<float, float> Filter::getFilterEdges() {
     // scan from the bottom and top to find the first
     // H sample over 0.5
     int hi, lo;
+    auto & H = design->float_image.H; 
     std::vector<float> Himg(H.size());
     int half_size = H.size() / 2;
     for(int i = 0; i < H.size(); i++) {
@@ -270,7 +794,8 @@ namespace SoDa {
       else {
 	j = i - half_size; 
       }
-      Himg[i] = std::abs(H[j]);
+      // (undo the 1/buffer_size normalization in H)
+      Himg[i] = std::abs(H[j]) * float(buffer_size);
     }
     
     for(int i = 0; i < Himg.size(); i++) {
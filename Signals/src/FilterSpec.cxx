@@ -27,6 +27,7 @@
  */
 
 #include "FilterSpec.hxx"
+#include "Remez.hxx"
 #include <cmath>
 #include <Utils/include/Format.hxx>
 
@@ -35,7 +36,7 @@ namespace SoDa {
 			 FType filter_type
 			 ) :
     sorted(false), filter_type(filter_type), taps(taps), sample_rate(sample_rate),
-    stop_band_attenuation_dB(40.0)
+    stop_band_attenuation_dB(40.0), pass_band_ripple_dB(0.1)
   {
   }
 
@@ -45,7 +46,7 @@ namespace SoDa {
 			 float stop_band_attenuation_dB) :
     sorted(false), filter_type(filter_type), 
     sample_rate(sample_rate),
-    stop_band_attenuation_dB(stop_band_attenuation_dB)
+    stop_band_attenuation_dB(stop_band_attenuation_dB), pass_band_ripple_dB(0.1)
   {
     auto low_stop = -0.5 * sample_rate;
     auto high_stop = 0.5 * sample_rate;
@@ -58,12 +59,19 @@ namespace SoDa {
     add(high_stop, 0.0);
   }
   
-  unsigned int FilterSpec::estimateTaps(unsigned int min_taps, unsigned int max_taps) {
+  unsigned int FilterSpec::estimateTaps(unsigned int min_taps, unsigned int max_taps, TapEstimate method) {
     // find the narrowest transition region
     if(!sorted) sortSpec();
 
-    // now crawl...
-    bool looking = true;
+    if(method == EQUIRIPPLE) {
+      // The Remez exchange can tell us exactly. 
+      Remez remez(*this);
+      taps = remez.minimumTaps(min_taps, max_taps);
+      return taps; 
+    }
+    
+    // now crawl... A transition is the space between two neighboring
+    // corners with different gains.
     float min_interval = 10e9;
     float last_gain;
     float last_corner;
@@ -73,15 +81,36 @@ namespace SoDa {
       if(v.gain != last_gain) {
 	float inter = v.freq - last_corner;
 	if(inter < min_interval) min_interval = inter;
-	last_gain = v.gain;
-	last_corner = v.freq;
       }
+      last_gain = v.gain;
+      last_corner = v.freq;
     }
     
-    // now use fred harris's rule for the number of filter taps?
-    float ftaps = sample_rate * stop_band_attenuation_dB / (min_interval * 22);
+    unsigned int comp_taps;
+    if(method == KAISER) {
+      // Each corner is a step in the prototype (see fillHproto) and
+      // the window smears that step evenly across its transition
+      // band. So the window's transition band can be twice as wide as
+      // the space between corners before it spills past the stop
+      // corner -- less the width of one prototype bin, since the step
+      // can land a bin away from its corner. (Filter samples a Kaiser
+      // prototype 8 times more finely than the tap count.) The bin
+      // width depends on the tap count, so go around a few times. 
+      comp_taps = kaiserTaps(sample_rate, 2.0 * min_interval, stop_band_attenuation_dB);
+      for(int i = 0; i < 20; i++) {
+	float half_width = min_interval - sample_rate / float(8 * comp_taps);
+	if(half_width <= 0.0) half_width = 0.5 * min_interval / float(i + 1);
+	auto new_taps = kaiserTaps(sample_rate, 2.0 * half_width, stop_band_attenuation_dB);
+	if(new_taps == comp_taps) break; 
+	comp_taps = new_taps;
+      }
+    }
+    else {
+      // now use fred harris's rule for the number of filter taps?
+      float ftaps = sample_rate * stop_band_attenuation_dB / (min_interval * 22);
 
-    unsigned int comp_taps = 2 * int(ftaps / 2) + 1; // make sure it is odd
+      comp_taps = 2 * int(ftaps / 2) + 1; // make sure it is odd
+    }
 
     taps = std::max(comp_taps, min_taps);
     taps = std::min(taps, max_taps);
@@ -89,6 +118,14 @@ namespace SoDa {
     return taps;
   }
 
+  unsigned int FilterSpec::kaiserTaps(float sample_rate, float transition_width, 
+				      float stop_band_attenuation_dB) {
+    double dw = 2.0 * M_PI * double(transition_width) / double(sample_rate);
+    double ftaps = (double(stop_band_attenuation_dB) - 7.95) / (2.285 * dw) + 1.0;
+    if(ftaps < 1.0) ftaps = 1.0; 
+    return 2 * (unsigned int)(ftaps / 2) + 1; // make sure it is odd
+  }
+
   void FilterSpec::fillHproto(std::vector<std::complex<float>> & Hproto) {
     if(!sorted) sortSpec();
     Hproto.resize(taps);
@@ -51,10 +51,11 @@ namespace SoDa {
   }
   
   template<typename T> 
-  void genGet(std::vector<std::complex<T>> & out, 
+  void genGet(std::complex<T> * out, size_t len, 
 	      double & angle, double ang_incr, 
 	      NCO::SumIt sum) {
-    for(auto & v : out) {
+    for(size_t i = 0; i < len; i++) {
+      auto & v = out[i]; 
       if(sum == NCO::ADD) {
 	v += std::complex<T>(cos(angle), sin(angle));
       }
@@ -68,11 +69,19 @@ namespace SoDa {
   }
   
   void NCO::get(std::vector<std::complex<float>> & out, SumIt sum) {
-    genGet<float>(out, cur_angle, ang_incr, sum);
+    genGet<float>(out.data(), out.size(), cur_angle, ang_incr, sum);
   }
 
   void NCO::get(std::vector<std::complex<double>> & out, SumIt sum) {
-    genGet<double>(out, cur_angle, ang_incr, sum);
+    genGet<double>(out.data(), out.size(), cur_angle, ang_incr, sum);
+  }
+
+  void NCO::get(std::complex<float> * out, unsigned int length, SumIt sum) {
+    genGet<float>(out, length, cur_angle, ang_incr, sum);
+  }
+
+  void NCO::get(std::complex<double> * out, unsigned int length, SumIt sum) {
+    genGet<double>(out, length, cur_angle, ang_incr, sum);
   }
 
   NCO::FreqOutOfBounds::FreqOutOfBounds(double fs, double fr) : 
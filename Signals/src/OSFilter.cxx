@@ -29,7 +29,9 @@
 #include "OSFilter.hxx"
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include "FFT.hxx"
+#include "VectorKernels.hxx"
 #include <Utils/include/Format.hxx>
 
 namespace SoDa {
@@ -39,7 +41,8 @@ namespace SoDa {
 		     float sample_rate, unsigned int buffer_size, 
 		     float stop_band_attenuation,
 		     float gain, 
-		     Filter::WindowChoice window) {
+		     Filter::WindowChoice window,
+		     Method _method) : method(_method) {
 
     
     FilterSpec fspec(sample_rate, low_cutoff, high_cutoff, skirt,
@@ -52,32 +55,42 @@ namespace SoDa {
   OSFilter::OSFilter(FilterSpec & filter_spec, 
 		     unsigned int buffer_size,
 		     float gain, 
-		     Filter::WindowChoice window) {    
+		     Filter::WindowChoice window,
+		     Method _method) : method(_method) {    
     makeOSFilter(filter_spec, buffer_size, gain, window); 
   }
 
-  OSFilter::OSFilter() {
+  OSFilter::OSFilter() : method(OVERLAP_SAVE), num_taps(0) {
     // don't do anything.  We'll set it up in a little while. 
   }
   
+  std::shared_ptr<OSFilter> OSFilter::clone() {
+    auto ret = std::make_shared<OSFilter>();
+    ret->buffer_size = buffer_size;
+    ret->method = method; 
+    // share the coefficients, but not the scratch space
+    ret->filter_p = std::unique_ptr<Filter>(new Filter(*filter_p));
+    // the overlap history starts out empty. 
+    ret->x_augmented.resize(x_augmented.size());
+    ret->y_augmented.resize(y_augmented.size());
+    ret->num_taps = num_taps; 
+    return ret; 
+  }
+  
   void OSFilter::makeGenericFilter(std::vector<std::complex<float>> & H,
-				   unsigned int num_taps, 
+				   unsigned int _num_taps, 
 				   unsigned int _buffer_size, 
 				   float gain,
 				   Filter::WindowChoice window_choice
 				   ) {
     buffer_size = _buffer_size; 
+    num_taps = _num_taps; 
 
     unsigned int fft_size = buffer_size + num_taps - 1;
     filter_p = std::unique_ptr<Filter>(new Filter(H, fft_size, gain, window_choice));
     // now size all the buffers. 
     x_augmented.resize(fft_size);
     y_augmented.resize(fft_size);
-    X.resize(fft_size);
-    Y.resize(fft_size);
-    save_buf.resize(num_taps - 1);
-    real_in.resize(buffer_size);
-    real_out.resize(buffer_size);
   }
   
   void OSFilter::makeOSFilter(FilterSpec & filter_spec, 
@@ -88,7 +101,7 @@ namespace SoDa {
     buffer_size = _buffer_size; 
 
     // taps will be something like 2 * sample_rate / skirt  + odd;
-    uint32_t gtaps = filter_spec.estimateTaps(50, 500);
+    uint32_t gtaps = filter_spec.estimateTaps(50, 500, Filter::tapEstimate(window));
     
     // add 4 and make gtaps even (for a reason.)
     gtaps += 4;
@@ -106,61 +119,239 @@ namespace SoDa {
     // now size all the buffers. 
     x_augmented.resize(good_size);
     y_augmented.resize(good_size);
-    X.resize(good_size);
-    Y.resize(good_size);
-    save_buf.resize(taps - 1);
-    real_in.resize(buffer_size);
-    real_out.resize(buffer_size);
+    num_taps = taps; 
   }
 
 
-  unsigned int OSFilter::apply(std::vector<std::complex<float>> & in_buf, 
-			       std::vector<std::complex<float>> & out_buf,
-			       float gain) {
-    if((in_buf.size() != buffer_size) || (out_buf.size() != buffer_size)) {
-      throw BadBufferSize("applyVCF", in_buf.size(), out_buf.size(), buffer_size); 
+  // copy the good output out of the augmented buffer, applying the
+  // gain on the way.  The filter's own gain is already in its image,
+  // so most callers ask for 1.0 and this is just a copy. 
+  template<typename ST, typename GT>
+  static void copyOut(const ST * src, GT gain, ST * dst, unsigned int count) {
+    if(gain == GT(1.0)) {
+      std::copy(src, src + count, dst);
+    }
+    else {
+      VectorKernels::scale(src, gain, dst, count);
+    }
+  }
+  
+  template<typename ST>
+  void OSFilter::initAugmented(AlignedVector<ST> & xa, AlignedVector<ST> & ya, Stream<ST> & stream) {
+    // the augmented buffers start out empty (and zero filled)
+    if(xa.size() != x_augmented.size()) {
+      xa.assign(x_augmented.size(), ST(0.0));
+      ya.resize(x_augmented.size());
+    }
+    if((method == OVERLAP_ADD) && (stream.tail.size() != num_taps - 1)) {
+      stream.tail.assign(num_taps - 1, ST(0.0));
+    }
+  }
+
+  template<typename ST>
+  unsigned int OSFilter::runBlock(AlignedVector<ST> & xa, AlignedVector<ST> & ya, Stream<ST> & stream) {
+    if(method == OVERLAP_SAVE) {
+      // see pushT for how the ring works. 
+      filter_p->apply(xa, ya);
+      unsigned int ret = stream.write_pos; 
+      stream.write_pos = (stream.write_pos + buffer_size) % xa.size();
+      return ret; 
+    }
+
+    // Overlap-and-add. The input is at the start of xa, and the rest
+    // of xa is zero, so the circular convolution is the linear one.
+    // If the input is all zero, so is the convolution. 
+    auto & tail = stream.tail; 
+    bool quiet = std::all_of(xa.begin(), xa.begin() + buffer_size, 
+			     [](const ST & v) { return v == ST(0.0); });
+    if(quiet) {
+      std::fill(ya.begin(), ya.end(), ST(0.0));
+    }
+    else {
+      filter_p->apply(xa, ya);
+    }
+
+    // add in what the earlier blocks left for us
+    unsigned int head = std::min((unsigned int) tail.size(), buffer_size);
+    for(int i = 0; i < head; i++) {
+      ya[i] += tail[i];
     }
+    // and save what spills past this block. If the filter is longer
+    // than the block, some of the old tail is still pending too. 
+    for(int i = 0; i < tail.size(); i++) {
+      unsigned int old = i + buffer_size; 
+      tail[i] = ya[old] + ((old < tail.size()) ? tail[old] : ST(0.0));
+    }
+    return 0; 
+  }
+
+  // The augmented buffer is a ring.  Each block's input overwrites
+  // the oldest buffer_size samples, starting at stream.write_pos, and
+  // the rest of the ring is the overlap from the blocks before.  That
+  // is the usual [overlap | input] buffer rotated by write_pos, and
+  // since the FFT filter does a circular convolution, the output is
+  // rotated by the same amount.  So the good output lands right where
+  // the input went, and the overlap never has to be moved. 
+  // (For overlap-and-add, write_pos stays at zero.)
+  template<typename ST>
+  unsigned int OSFilter::pushT(const ST * in_buf, size_t in_size, 
+			       AlignedVector<ST> & xa,
+			       AlignedVector<ST> & ya, 
+			       Stream<ST> & stream) {
+    initAugmented(xa, ya, stream);
+    stream.out.configure(0, buffer_size);
     
-    // copy from the end of x_augmented to the start
-    uint32_t end_start = x_augmented.size() - save_buf.size();
-    for(int i = 0; i < save_buf.size(); i++) {
-      x_augmented.at(i) = x_augmented.at(end_start + i); 
+    size_t in_pos = 0; 
+    while(in_pos < in_size) {
+      unsigned int pos = (stream.write_pos + stream.fill) % xa.size();
+      // stop at the end of the block, and at the end of the ring
+      unsigned int count = std::min(size_t(buffer_size - stream.fill), in_size - in_pos);
+      count = std::min(count, (unsigned int) (xa.size() - pos)); 
+      std::copy(in_buf + in_pos, in_buf + in_pos + count, xa.begin() + pos);
+      in_pos += count;
+      stream.fill += count;
+
+      if(stream.fill == buffer_size) {
+	auto out_pos = runBlock(xa, ya, stream);
+	// the block goes to the queue, and we get an empty ya back.
+	stream.out.push(ya, out_pos);
+	stream.fill = 0; 
+      }
+    }
+    return in_size; 
+  }
+
+  template<typename ST>
+  unsigned int OSFilter::pullT(ST * out_buf, size_t out_size, float gain, 
+			       Stream<ST> & stream) {
+    decltype(std::abs(ST())) g = gain; 
+    return stream.out.pull(out_size, 
+			   [out_buf, g](const ST * src, unsigned int out_pos, unsigned int count) {
+			     copyOut(src, g, out_buf + out_pos, count);
+			   });
+  }
+  
+  template<typename ST>
+  unsigned int OSFilter::applyT(const ST * in_buf, size_t in_size, 
+				ST * out_buf, size_t out_size, 
+				float gain, 
+				AlignedVector<ST> & xa,
+				AlignedVector<ST> & ya, 
+				Stream<ST> & stream, 
+				const std::string & st) {
+    if((in_size != buffer_size) || (out_size != buffer_size)) {
+      throw BadBufferSize(st, in_size, out_size, buffer_size); 
     }
-    // now fill the rest
-    for(int i = save_buf.size(); i < x_augmented.size(); i++) {
-      int j = i - save_buf.size();
-      x_augmented.at(i) = in_buf.at(j); 
+    if(stream.fill != 0) {
+      throw BadBufferSize(st + " (after a partial push)", in_size, out_size, buffer_size - stream.fill); 
     }
+
+    initAugmented(xa, ya, stream);
+
+    // the input goes over the oldest samples in the ring (see pushT),
+    // in two pieces if it wraps around the end.
+    unsigned int pos = stream.write_pos; 
+    unsigned int first = std::min(size_t(xa.size() - pos), in_size);
+    std::copy(in_buf, in_buf + first, xa.begin() + pos);
+    std::copy(in_buf + first, in_buf + in_size, xa.begin());
+    
     // apply the filter.
-    filter_p->apply(x_augmented, y_augmented); 
+    pos = runBlock(xa, ya, stream);
 
-    // throw away the early samples
-    for(int i = 0;  i < out_buf.size(); i++) {
-      out_buf.at(i) = y_augmented.at(i + save_buf.size()) * gain;
-    }
+    // and the output comes from the same place. 
+    // (the gain is a float or double, to match the sample precision)
+    decltype(std::abs(ST())) g = gain; 
+    first = std::min(size_t(ya.size() - pos), out_size);
+    copyOut(ya.data() + pos, g, out_buf, first);
+    copyOut(ya.data(), g, out_buf + first, out_size - first);
 
-    return out_buf.size(); 
+    return out_size; 
+  }
+  
+  unsigned int OSFilter::apply(std::vector<std::complex<float>> & in_buf, 
+			       std::vector<std::complex<float>> & out_buf,
+			       float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, x_augmented, y_augmented, stream, "applyVCF");
   }
 
   unsigned int OSFilter::apply(std::vector<float> & in_buf, 
 			       std::vector<float> & out_buf, 
 			       float gain) {
-    if((in_buf.size() != buffer_size) || (out_buf.size() != buffer_size)) {
-      throw BadBufferSize("applyVF", in_buf.size(), out_buf.size(), buffer_size); 
-    }
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, x_real_augmented, y_real_augmented, real_stream, "applyVF");
+  }
 
-    for(int i = 0; i < in_buf.size(); i++) {
-      real_in.at(i) = std::complex<float>(in_buf.at(i), 0.0);
-    }
-    
-    apply(real_in, real_out, gain);
-    
-    for(int i = 0; i < out_buf.size(); i++) {
-      out_buf.at(i) = real_out.at(i).real();
-    }
-    return in_buf.size();    
+  unsigned int OSFilter::apply(std::vector<std::complex<double>> & in_buf, 
+			       std::vector<std::complex<double>> & out_buf,
+			       float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, x_double_augmented, y_double_augmented, double_stream, "applyVCD");
   }
 
+  unsigned int OSFilter::apply(std::vector<double> & in_buf, 
+			       std::vector<double> & out_buf, 
+			       float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, x_real_double_augmented, y_real_double_augmented, real_double_stream, "applyVD");
+  }
+
+  unsigned int OSFilter::apply(const std::complex<float> * in_buf, 
+			       std::complex<float> * out_buf,
+			       unsigned int length, 
+			       float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, x_augmented, y_augmented, stream, "applyPCF");
+  }
+
+  unsigned int OSFilter::apply(const float * in_buf, 
+			       float * out_buf, 
+			       unsigned int length, 
+			       float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, x_real_augmented, y_real_augmented, real_stream, "applyPF");
+  }
+
+  unsigned int OSFilter::apply(const std::complex<double> * in_buf, 
+			       std::complex<double> * out_buf,
+			       unsigned int length, 
+			       float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, x_double_augmented, y_double_augmented, double_stream, "applyPCD");
+  }
+
+  unsigned int OSFilter::apply(const double * in_buf, 
+			       double * out_buf, 
+			       unsigned int length, 
+			       float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, x_real_double_augmented, y_real_double_augmented, real_double_stream, "applyPD");
+  }
+
+  unsigned int OSFilter::push(const std::complex<float> * in_buf, unsigned int length) {
+    return pushT(in_buf, length, x_augmented, y_augmented, stream);
+  }
+
+  unsigned int OSFilter::push(const float * in_buf, unsigned int length) {
+    return pushT(in_buf, length, x_real_augmented, y_real_augmented, real_stream);
+  }
+
+  unsigned int OSFilter::push(const std::complex<double> * in_buf, unsigned int length) {
+    return pushT(in_buf, length, x_double_augmented, y_double_augmented, double_stream);
+  }
+
+  unsigned int OSFilter::push(const double * in_buf, unsigned int length) {
+    return pushT(in_buf, length, x_real_double_augmented, y_real_double_augmented, real_double_stream);
+  }
+
+  unsigned int OSFilter::pull(std::complex<float> * out_buf, unsigned int length, float gain) {
+    return pullT(out_buf, length, gain, stream);
+  }
+
+  unsigned int OSFilter::pull(float * out_buf, unsigned int length, float gain) {
+    return pullT(out_buf, length, gain, real_stream);
+  }
+
+  unsigned int OSFilter::pull(std::complex<double> * out_buf, unsigned int length, float gain) {
+    return pullT(out_buf, length, gain, double_stream);
+  }
+
+  unsigned int OSFilter::pull(double * out_buf, unsigned int length, float gain) {
+    return pullT(out_buf, length, gain, real_double_stream);
+  }
+  
   OSFilter::BadBufferSize::BadBufferSize(const std::string & st, 
 					 unsigned int in, 
 					 unsigned int out, 
@@ -175,9 +366,10 @@ namespace SoDa {
   std::shared_ptr<OSFilter> OSFilter::make(FilterSpec & filter_spec, 
 					   unsigned int buffer_size,
 					   float gain, 
-					   Filter::WindowChoice window) {
+					   Filter::WindowChoice window,
+					   Method method) {
     auto ret = std::make_shared<OSFilter>(filter_spec, buffer_size,
-					  gain, window);
+					  gain, window, method);
     return ret; 
   }
 
@@ -188,7 +380,8 @@ namespace SoDa {
 					   unsigned int buffer_size,
 					   float stop_band_attenuation,
 					   float gain,
-					   Filter::WindowChoice window) {
+					   Filter::WindowChoice window,
+					   Method method) {
     auto ret = std::make_shared<OSFilter>(low_cutoff,
 				      high_cutoff,
 				      skirt,
@@ -196,7 +389,8 @@ namespace SoDa {
 				      buffer_size,
 				      stop_band_attenuation, 
 				      gain,
-				      window);
+				      window,
+				      method);
     return ret; 
     
   }
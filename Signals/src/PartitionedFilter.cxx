@@ -0,0 +1,280 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PartitionedFilter.hxx"
+#include "FIRFilter.hxx"
+#include "VectorKernels.hxx"
+#include <Utils/include/Format.hxx>
+#include <algorithm>
+#include <type_traits>
+
+namespace SoDa {
+
+  PartitionedFilter::PartitionedFilter(float low_cutoff, float high_cutoff, float skirt, 
+				       float sample_rate, unsigned int buffer_size, 
+				       float stop_band_attenuation,
+				       float gain, 
+				       Filter::WindowChoice window) {
+    FilterSpec fspec(sample_rate, low_cutoff, high_cutoff, skirt,
+		     FilterSpec::COMPLEX,
+		     stop_band_attenuation);
+    fspec.estimateTaps(3, 16385, Filter::tapEstimate(window));
+    makePartitionedFilter(fspec, buffer_size, gain, window); 
+  }
+
+  PartitionedFilter::PartitionedFilter(FilterSpec & filter_spec, 
+				       unsigned int buffer_size,
+				       float gain, 
+				       Filter::WindowChoice window) {    
+    makePartitionedFilter(filter_spec, buffer_size, gain, window); 
+  }
+
+  void PartitionedFilter::makePartitionedFilter(FilterSpec & filter_spec, 
+						unsigned int _buffer_size,
+						float gain, 
+						Filter::WindowChoice window) {
+    buffer_size = _buffer_size;
+    if(buffer_size == 0) {
+      throw BadBufferSize("PartitionedFilter", 0, 0, 1);
+    }
+    
+    // Same design as FIRFilter -- let Filter do it on a fine grid.
+    unsigned int design_size = FFT::findGoodSize(std::max(8 * filter_spec.getTaps(), 1024u));
+    Filter design(filter_spec, design_size, gain, window);
+    design.getImpulseResponse(taps);
+    edges = design.getFilterEdges();
+
+    num_partitions = (taps.size() + buffer_size - 1) / buffer_size; 
+    // Overlap-save needs at least 2B - 1 points. 2B itself can have a
+    // big prime factor (B = 257, say) so take the next good size up.
+    fft_len = FFT::findGoodSize(2 * buffer_size);
+    fft = std::unique_ptr<FFT>(new FFT(fft_len));
+  }
+
+  void PartitionedFilter::getImpulseResponse(std::vector<std::complex<float>> & h) {
+    h = taps; 
+  }
+
+  template<typename T>
+  void PartitionedFilter::makePartitions(Partitions<T> & p, bool real_taps) {
+    unsigned int N = fft_len; 
+    // real streams only need the half spectrum
+    p.bins = real_taps ? fft->getHalfSpectrumSize() : N;
+    p.H.assign(num_partitions * p.bins, std::complex<T>(0.0, 0.0));
+    AlignedVector<std::complex<T>> piece(N);
+    AlignedVector<T> piece_real(N);
+    T scale = 1.0 / T(N);
+    for(unsigned int k = 0; k < num_partitions; k++) {
+      // piece k is taps kB to (k+1)B - 1, zero padded to N
+      std::fill(piece.begin(), piece.end(), std::complex<T>(0.0, 0.0));
+      std::fill(piece_real.begin(), piece_real.end(), T(0.0));
+      for(unsigned int j = 0; j < buffer_size; j++) {
+	unsigned int idx = k * buffer_size + j; 
+	if(idx >= taps.size()) break; 
+	piece[j] = taps[idx];
+	piece_real[j] = taps[idx].real();
+      }
+      auto Hk = p.H.data() + k * p.bins; 
+      if(real_taps) {
+	fft->rfft(piece_real.data(), Hk, N);
+      }
+      else {
+	fft->fft(piece.data(), Hk, N);
+      }
+      VectorKernels::scale(Hk, scale, Hk, p.bins);
+    }
+
+    p.fdl.assign(num_partitions * p.bins, std::complex<T>(0.0, 0.0));
+    p.newest = 0;
+    p.Y.resize(p.bins);
+    if(real_taps) {
+      p.x_real.assign(N, T(0.0));
+      p.y_real.resize(N);
+    }
+    else {
+      p.x.assign(N, std::complex<T>(0.0, 0.0));
+      p.y.resize(N);
+    }
+  }
+  
+  template<typename ST, typename T>
+  unsigned int PartitionedFilter::applyT(const ST * in_buf, size_t in_size, 
+					 ST * out_buf, size_t out_size, 
+					 float gain, 
+					 Partitions<T> & p, 
+					 const std::string & st) {
+    if((in_size != buffer_size) || (out_size != buffer_size)) {
+      throw BadBufferSize(st, in_size, out_size, buffer_size); 
+    }
+
+    constexpr bool is_real = std::is_same<ST, T>::value; 
+    if(p.H.empty()) {
+      makePartitions(p, is_real);
+    }
+
+    unsigned int B = buffer_size; 
+    unsigned int N = fft_len;
+    unsigned int bins = p.bins; 
+    
+    // the oldest spectrum in the delay line falls off the end, and
+    // the newest takes its place
+    p.newest = (p.newest == 0) ? (num_partitions - 1) : (p.newest - 1);
+    auto X = p.fdl.data() + p.newest * bins; 
+
+    // overlap-and-save on the last N input samples
+    if constexpr (is_real) {
+      std::copy(p.x_real.begin() + B, p.x_real.end(), p.x_real.begin());
+      std::copy(in_buf, in_buf + B, p.x_real.begin() + (N - B));
+      fft->rfft(p.x_real.data(), X, N);
+    }
+    else {
+      std::copy(p.x.begin() + B, p.x.end(), p.x.begin());
+      std::copy(in_buf, in_buf + B, p.x.begin() + (N - B));
+      fft->fft(p.x.data(), X, N);
+    }
+
+    // Y = sum_k X(k blocks ago) H_k
+    VectorKernels::mul(X, p.H.data(), p.Y.data(), bins);
+    for(unsigned int k = 1; k < num_partitions; k++) {
+      unsigned int slot = (p.newest + k) % num_partitions; 
+      VectorKernels::mulAcc(p.fdl.data() + slot * bins, p.H.data() + k * bins, p.Y.data(), bins);
+    }
+
+    // everything but the last B outputs is wrapped around -- throw it away
+    // (irfft scribbles on Y, but it gets rebuilt next time anyway.)
+    if constexpr (is_real) {
+      fft->irfft(p.Y.data(), p.y_real.data(), N);
+      std::copy(p.y_real.begin() + (N - B), p.y_real.end(), out_buf);
+    }
+    else {
+      fft->ifft(p.Y.data(), p.y.data(), N);
+      std::copy(p.y.begin() + (N - B), p.y.end(), out_buf);
+    }
+    
+    if(gain != 1.0) {
+      // (the gain is a float or double, to match the sample precision)
+      T g = gain; 
+      VectorKernels::scale(out_buf, g, out_buf, B);
+    }
+    
+    return out_size; 
+  }
+
+  unsigned int PartitionedFilter::apply(std::vector<std::complex<float>> & in_buf, 
+					std::vector<std::complex<float>> & out_buf,
+					float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, parts, "applyVCF");
+  }
+
+  unsigned int PartitionedFilter::apply(std::vector<float> & in_buf, 
+					std::vector<float> & out_buf, 
+					float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, parts_real, "applyVF");
+  }
+
+  unsigned int PartitionedFilter::apply(std::vector<std::complex<double>> & in_buf, 
+					std::vector<std::complex<double>> & out_buf,
+					float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, parts_double, "applyVCD");
+  }
+
+  unsigned int PartitionedFilter::apply(std::vector<double> & in_buf, 
+					std::vector<double> & out_buf, 
+					float gain) {
+    return applyT(in_buf.data(), in_buf.size(), out_buf.data(), out_buf.size(), gain, parts_real_double, "applyVD");
+  }
+
+  unsigned int PartitionedFilter::apply(const std::complex<float> * in_buf, 
+					std::complex<float> * out_buf,
+					unsigned int length, 
+					float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, parts, "applyPCF");
+  }
+
+  unsigned int PartitionedFilter::apply(const float * in_buf, 
+					float * out_buf,
+					unsigned int length, 
+					float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, parts_real, "applyPF");
+  }
+
+  unsigned int PartitionedFilter::apply(const std::complex<double> * in_buf, 
+					std::complex<double> * out_buf,
+					unsigned int length, 
+					float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, parts_double, "applyPCD");
+  }
+
+  unsigned int PartitionedFilter::apply(const double * in_buf, 
+					double * out_buf,
+					unsigned int length, 
+					float gain) {
+    return applyT(in_buf, length, out_buf, length, gain, parts_real_double, "applyPD");
+  }
+
+  double PartitionedFilter::getSampleCost(unsigned int num_taps, unsigned int buffer_size) {
+    unsigned int num_partitions = (num_taps + buffer_size - 1) / buffer_size; 
+    unsigned int N = FFT::findGoodSize(2 * buffer_size); 
+    // forward and inverse transforms, and a multiply-add per bin per
+    // partition (which costs about the same as a tap)
+    double block_cost = 2.0 * FFT::getTransformCost(N) 
+      + double(num_partitions) * double(N) * FIRFilter::getTapCost();
+    return block_cost / double(buffer_size); 
+  }
+  
+  PartitionedFilter::BadBufferSize::BadBufferSize(const std::string & st, 
+						  unsigned int in, 
+						  unsigned int out, 
+						  unsigned int req) :
+	std::runtime_error(SoDa::Format("PartitionedFilter::%3 input and output buffer sizes (%0 and %1) must be equal to %2\n")
+			   .addI(in)
+			   .addI(out)
+			   .addI(req)
+			   .addS(st)
+			   .str()) { }
+
+  PartitionedFilterPtr PartitionedFilter::make(FilterSpec & filter_spec, 
+					       unsigned int buffer_size,
+					       float gain, 
+					       Filter::WindowChoice window) {
+    return std::make_shared<PartitionedFilter>(filter_spec, buffer_size, gain, window);
+  }
+
+  PartitionedFilterPtr PartitionedFilter::make(float low_cutoff, 
+					       float high_cutoff, 
+					       float skirt,
+					       float sample_rate, 
+					       unsigned int buffer_size,
+					       float stop_band_attenuation,
+					       float gain,
+					       Filter::WindowChoice window) {
+    return std::make_shared<PartitionedFilter>(low_cutoff, high_cutoff, skirt,
+					       sample_rate, buffer_size,
+					       stop_band_attenuation, gain, window);
+  }
+}
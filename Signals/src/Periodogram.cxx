@@ -34,37 +34,18 @@ namespace SoDa {
   Periodogram::Periodogram(unsigned int segment_length, 
 			   float _alpha,
 			   Filter::WindowChoice window_choice) : 
-    segment_length(segment_length) {
+    segment_length(segment_length), window_choice(window_choice) {
 
     setAlpha(_alpha);
     
     fft_scale = 1.0 / double(segment_length);
     
-    acc_buffer.resize(segment_length);
-    input_save_buffer.resize(segment_length);
-    fft_in_buffer.resize(segment_length);
-    fft_out_buffer.resize(segment_length);    
-
-    input_save_buffer_valid_count = 0;
-    accumulation_count = 0; 
-    
     // build the FFT
     fft_p = std::unique_ptr<FFT>(new FFT(segment_length));
 
-    // create the window
-    window.resize(segment_length);
-    switch (window_choice) {
-    case Filter::HAMMING:
-      Filter::hammingWindow(window);
-      break; 
-    case Filter::BLACKMAN:
-      Filter::blackmanWindow(window);
-      break; 
-    case Filter::HANN:
-    default:
-      Filter::hannWindow(window);
-      break; 
-    }
+    // the float accumulator is always there, so that get works before
+    // the first accumulate. 
+    initWork(float_work);
     
     clear();
   }
@@ -78,23 +59,85 @@ namespace SoDa {
     beta = 1.0 - alpha;
   }
 
-  int acc_in_count = 0;
+  template<>
+  Periodogram::Work<float> & Periodogram::getWork<float>() {
+    return float_work; 
+  }
+
+  template<>
+  Periodogram::Work<double> & Periodogram::getWork<double>() {
+    return double_work; 
+  }
+  
+  template<typename T>
+  void Periodogram::initWork(Work<T> & w) {
+    if(w.input_save_buffer.size() == segment_length) return; 
+    
+    w.input_save_buffer.resize(segment_length);
+    w.fft_in_buffer.resize(segment_length);
+    w.fft_out_buffer.resize(segment_length);
+    w.acc_buffer.assign(segment_length, T(0)); 
+
+    // create the window in the working precision
+    w.window.resize(segment_length);
+    switch (window_choice) {
+    case Filter::HAMMING:
+      Filter::hammingWindow(w.window);
+      break; 
+    case Filter::BLACKMAN:
+      Filter::blackmanWindow(w.window);
+      break; 
+    case Filter::HANN:
+    default:
+      Filter::hannWindow(w.window);
+      break; 
+    }
+  }
   
   void Periodogram::accumulate(const std::vector<std::complex<float>> & in) {
+    accumulateT(in.data(), in.size()); 
+  }
+  
+  void Periodogram::accumulate(const std::complex<float> * in, unsigned int length) {
+    accumulateT(in, length); 
+  }
+
+  void Periodogram::accumulate(const std::vector<std::complex<double>> & in) {
+    accumulateT(in.data(), in.size()); 
+  }
+  
+  void Periodogram::accumulate(const std::complex<double> * in, unsigned int length) {
+    accumulateT(in, length); 
+  }
+  
+  template<typename T>
+  void Periodogram::accumulateT(const std::complex<T> * in, unsigned int length) {
+    auto & w = getWork<T>();
+    initWork(w);
+    auto & input_save_buffer = w.input_save_buffer;
+    auto & acc_buffer = w.acc_buffer;
+    auto & fft_in_buffer = w.fft_in_buffer;
+    auto & fft_out_buffer = w.fft_out_buffer;
+    auto & window = w.window; 
+
+    T a = alpha;
+    T b = beta;
+    T scale = fft_scale; 
+    
     size_t curpos = 0; 
 
-    while(curpos != in.size()) {
+    while(curpos != length) {
       // fill the end of the save_buffer with the input buffer
-      size_t max_fill = segment_length - input_save_buffer_valid_count; 
-      auto stuff_len = std::min(max_fill, in.size() - curpos); 
+      size_t max_fill = segment_length - w.input_save_buffer_valid_count; 
+      auto stuff_len = std::min(max_fill, size_t(length) - curpos); 
 
-      std::copy(in.begin() + curpos, in.begin() + curpos + stuff_len, 
-		input_save_buffer.begin() + input_save_buffer_valid_count);
-      input_save_buffer_valid_count += stuff_len; 
+      std::copy(in + curpos, in + curpos + stuff_len, 
+		input_save_buffer.begin() + w.input_save_buffer_valid_count);
+      w.input_save_buffer_valid_count += stuff_len; 
       curpos += stuff_len; 
 
       // is the save_buffer full? -- if not, return; 
-      if(input_save_buffer_valid_count != segment_length) return; 
+      if(w.input_save_buffer_valid_count != segment_length) return; 
       
       // else
       // apply the window
@@ -107,46 +150,70 @@ namespace SoDa {
 
       // accumulate
       for(int i = 0; i < segment_length; i++) {
-	acc_buffer[i] = alpha * std::abs(fft_out_buffer[i]) * fft_scale + beta * acc_buffer[i];
-	//	acc_buffer[i] = fft_out_buffer[i] +  acc_buffer[i]; 	
+	acc_buffer[i] = a * std::abs(fft_out_buffer[i]) * scale + b * acc_buffer[i];
       }
-      accumulation_count++; 
+      w.accumulation_count++; 
 
       // move the last half of the buffer to the first half
       std::copy(input_save_buffer.begin() + (segment_length >> 1), 
 		input_save_buffer.end(), 
 		input_save_buffer.begin()); 
       
-      input_save_buffer_valid_count = segment_length >> 1;
+      w.input_save_buffer_valid_count = segment_length >> 1;
     }
   }
 
   void Periodogram::get(std::vector<float> & res) const {
-    res.resize(acc_buffer.size());
+    getT(float_work, res); 
+  }
+
+  void Periodogram::get(std::vector<double> & res) const {
+    getT(double_work, res); 
+  }
+
+  template<typename T>
+  void Periodogram::getT(const Work<T> & w, std::vector<T> & res) const {
+    // an accumulator we haven't used yet is all zeros
+    if(w.acc_buffer.size() != segment_length) {
+      res.assign(segment_length, T(0));
+      return; 
+    }
+    
+    res.resize(w.acc_buffer.size());
     // fft shift the acc buffer into the result buffer
-    int len = acc_buffer.size(); 
+    int len = w.acc_buffer.size(); 
     int half_idx = len / 2;
     for(int i = 0; i < half_idx; i++) {
-      res[i] = acc_buffer[half_idx + i];
-      res[half_idx + i] = acc_buffer[i];
+      res[i] = w.acc_buffer[half_idx + i];
+      res[half_idx + i] = w.acc_buffer[i];
     }
     return; 
   }
     
-  float Periodogram::getScaleFactor() {
+  template<typename T>
+  T Periodogram::getScaleFactor() {
     if(alpha == 1.0) {
-      return 1.0 / float(accumulation_count); 
+      return T(1.0) / T(getWork<T>().accumulation_count); 
     }
     else {
       return 1.0; 
     }
   }
-  
-  void Periodogram::clear() {
-    input_save_buffer_valid_count = 0; 
-    accumulation_count = 0; 
-    for(auto & v : acc_buffer) {
+
+  template float Periodogram::getScaleFactor<float>();
+  template double Periodogram::getScaleFactor<double>();
+
+  template<typename T>
+  void Periodogram::clearWork(Work<T> & w) {
+    w.input_save_buffer_valid_count = 0; 
+    w.accumulation_count = 0; 
+    for(auto & v : w.acc_buffer) {
       v = 0.0; 
     }
   }
+  
+  void Periodogram::clear() {
+    clearWork(float_work);
+    clearWork(double_work);
+  }
 }
@@ -47,15 +47,48 @@ namespace SoDa {
     }
   }
 
+  // When the FFT class is choosing sizes from measurements, look
+  // for a block multiple k (Lx = k * D, Ly = k * U) that makes the
+  // pair of transforms cheap. The candidates are min_k and the
+  // 2^n * 3^m * 5^p * 7^q values of k up to 2 * min_k. We're after
+  // the cost per useful input sample, not per transform.
+  static uint32_t chooseBlockMultiple(uint32_t min_k, uint32_t U, uint32_t D, uint32_t save_count) {
+    auto costPerSample = [U, D, save_count](uint32_t k) {
+      return (FFT::getTransformCost(k * D) + FFT::getTransformCost(k * U)) 
+	/ double(k * D - save_count);
+    };
+
+    uint32_t best_k = min_k; 
+    double best_cost = costPerSample(min_k);
+    uint64_t max_k = 2 * uint64_t(min_k);
+    for(uint64_t vn = 1; vn <= max_k; vn *= 2) {
+      for(uint64_t vm = vn; vm <= max_k; vm *= 3) {
+	for(uint64_t vp = vm; vp <= max_k; vp *= 5) {
+	  for(uint64_t vq = vp; vq <= max_k; vq *= 7) {
+	    if((vq <= min_k) || ((vq * D) <= save_count)) continue; 
+	    double cost = costPerSample(vq);
+	    if(cost < best_cost) {
+	      best_cost = cost;
+	      best_k = vq; 
+	    }
+	  }
+	}
+      }
+    }
+    return best_k; 
+  }
+
   ReSamplerPtr ReSampler::make(float FS_in,
 			       float FS_out,
-			       float time_span_min) {
-    return std::make_shared<ReSampler>(FS_in, FS_out, time_span_min); 
+			       float time_span_min,
+			       Filter::WindowChoice window) {
+    return std::make_shared<ReSampler>(FS_in, FS_out, time_span_min, window); 
   }
   
   ReSampler::ReSampler(float FS_in,
 		       float FS_out,
-		       float time_span_min) {
+		       float time_span_min,
+		       Filter::WindowChoice window) {
     uint32_t i_fs_in = ((uint32_t) FS_in);
     uint32_t i_fs_out = ((uint32_t) FS_out);
     auto gcd = getGCD(i_fs_in, i_fs_out);
@@ -81,10 +114,32 @@ namespace SoDa {
     double skirt_proportion = std::max(FS_in, FS_out) / (passband * (0.5 - corner_factor));
 
     double supression = 60.0;
-    // use fred harris's estimate.
-    // transition band is 10 % of FS_out
-    uint32_t num_taps = int(0.5 + skirt_proportion * supression / 22.0); 
-    if((num_taps % 2) == 0) num_taps++;
+    double skirt = 0.015 * cutoff; 
+    uint32_t num_taps;
+    if(window == Filter::EQUIRIPPLE) {
+      // An equiripple design meets its corners exactly, so pass
+      // everything up to the cutoff and stop at the Nyquist rate of
+      // the slower stream. 
+      skirt = 0.5 * passband - cutoff; 
+      FilterSpec spec(std::max(FS_in, FS_out), -cutoff, cutoff, skirt, 
+		      FilterSpec::COMPLEX, supression);
+      num_taps = spec.estimateTaps(3, 4001, FilterSpec::EQUIRIPPLE);
+    }
+    else if(window == Filter::KAISER) {
+      // The filter's edge is at cutoff plus its (tiny) skirt, and the
+      // window spreads the edge evenly on both sides. Leave room
+      // for half of the spread between the edge and the Nyquist
+      // rate of the slower stream. 
+      double edge = 1.015 * cutoff; 
+      num_taps = FilterSpec::kaiserTaps(std::max(FS_in, FS_out), 
+					2.0 * (0.5 * passband - edge), supression);
+    }
+    else {
+      // use fred harris's estimate.
+      // transition band is 10 % of FS_out
+      num_taps = int(0.5 + skirt_proportion * supression / 22.0); 
+      if((num_taps % 2) == 0) num_taps++;
+    }
     if(num_taps < 121) num_taps = 121;
     
     // now find the input buffer size -- make it long enough to span time_span_min
@@ -99,10 +154,6 @@ namespace SoDa {
     
     scale_factor = float(D) / float(U);
     
-    auto k = (min_in_samples + D - 1) / D;
-    Lx = k * D;
-    Ly = k * U;
-
     // setup the save buffer -- it is at least as long as the filter, and must
     // be a multiple of D.
     int savek = (num_taps + D - 1) / D;
@@ -110,6 +161,13 @@ namespace SoDa {
 
     // it must be longer than the filter by at least one. 
     if(save_count < (num_taps + 1)) save_count = save_count + D;
+
+    auto k = (min_in_samples + D - 1) / D;
+    if(FFT::measuredSizesEnabled()) {
+      k = chooseBlockMultiple(k, U, D, save_count);
+    }
+    Lx = k * D;
+    Ly = k * U;
     
     // remember our discard
     discard_count = save_count * U / D;
@@ -121,35 +179,22 @@ namespace SoDa {
     if(FS_out > FS_in) {
       float up_ratio = float(FS_out / FS_in);
       lpf_p = std::unique_ptr<SoDa::Filter>(new SoDa::Filter(-cutoff, cutoff, 
-							     0.015 * cutoff, 
+							     skirt, 
 							     FS_out, 
 							     num_taps, Ly,
-							     up_ratio));
+							     up_ratio, window));
     }
     else {
       // downsampling, filter on the X buffer before the cut-down
       lpf_p = std::unique_ptr<SoDa::Filter>(new SoDa::Filter(-cutoff, cutoff, 
-							     0.015 * cutoff, 
+							     skirt, 
 							     FS_in, 
-							     num_taps, Lx));
+							     num_taps, Lx, 
+							     1.0, window));
     }
 
-    
-    // create the input and output buffers
-    x.resize(Lx);
-    y.resize(Ly);
-    X.resize(Lx);
-    Y.resize(Ly);
-    
-    // zero the input buffer since we use the
-    // end of it for the save buffer. 
-    for(auto & s : x) {
-      s = std::complex<float>(0.0,0.0);
-    }
-    // zero the output Y vector, as we may be upsampling
-    for(auto & s : Y) {
-      s = std::complex<float>(0.0,0.0);
-    }
+    // the input and output buffers are created the first time
+    // we see a buffer of a given type. 
 
     // create the input and output FFTs.
     in_fft_p = std::unique_ptr<SoDa::FFT>(new SoDa::FFT(Lx));
@@ -174,24 +219,56 @@ namespace SoDa {
     return save_count + 1;
   }
   
-  int apcount = 0; 
-  uint32_t ReSampler::apply(std::vector<std::complex<float>> & in,
-			    std::vector<std::complex<float>> & out) {
-    if(in.size() != getInputBufferSize()) {
-      throw BadBufferSize("Input", in.size(), getInputBufferSize());
+  template<>
+  ReSampler::Work<float> & ReSampler::getWork<float>() {
+    return float_work; 
+  }
+
+  template<>
+  ReSampler::Work<double> & ReSampler::getWork<double>() {
+    return double_work; 
+  }
+  
+  template<typename T>
+  void ReSampler::initWork(Work<T> & w) {
+    auto & x = w.x;
+    if(x.size() != Lx) {
+      // first time through.
+      // zero the input buffer since we use the
+      // end of it for the save buffer. 
+      x.assign(Lx, std::complex<T>(0.0, 0.0));
+      w.X.resize(Lx);
+      w.y.resize(Ly);
+      // zero the output Y vector, as we may be upsampling
+      w.Y.assign(Ly, std::complex<T>(0.0, 0.0));
     }
+  }
 
-    if(out.size() != getOutputBufferSize()) {
-      throw BadBufferSize("Output", out.size(), getOutputBufferSize());
+  template<typename T>
+  void ReSampler::initRealWork(Work<T> & w) {
+    if(w.x_real.size() != Lx) {
+      // first time through -- zero the save region
+      w.x_real.assign(Lx, 0.0);
+      w.y_real.resize(Ly);
+      w.X_half.resize(in_fft_p->getHalfSpectrumSize());
+      w.Y_half.resize(out_fft_p->getHalfSpectrumSize());
     }
+  }
 
+  template<typename VT>
+  void ReSampler::shiftSave(VT & x) {
     // first do the overlap-and-save thing.
     for(int i = 0; i < save_count; i++) {
-      x.at(i) = x.at(x.size() - save_count + i);
-    }
-    for(int i = save_count; i < Lx; i++) {
-      x.at(i) = in.at(i - save_count); 
+      x[i] = x[x.size() - save_count + i];
     }
+  }
+  
+  template<typename T>
+  void ReSampler::runBlock(Work<T> & w) {
+    auto & x = w.x;
+    auto & X = w.X;
+    auto & y = w.y;
+    auto & Y = w.Y; 
     
     // now do the FFT
     in_fft_p->fft(x, X);
@@ -223,7 +300,6 @@ namespace SoDa {
 	  Y.at(i) = X.at(i);
 	}
 	else {
-	  auto yi = (Ly - 1) - (Lx - 1) + i;
 	  Y.at((Ly - 1) -(Lx - 1) + i) = X.at(i);
 	}
       }
@@ -234,35 +310,228 @@ namespace SoDa {
 
     // do the inverse FFT
     out_fft_p->ifft(Y, y);
+  }
+
+  template<typename T>
+  void ReSampler::runRealBlock(Work<T> & w) {
+    auto & x_real = w.x_real;
+    auto & y_real = w.y_real;
+    auto & X_half = w.X_half;
+    auto & Y_half = w.Y_half; 
+
+    // the input is real, so we only need the DC-and-up half of the spectrum.
+    in_fft_p->rfft(x_real, X_half);
+
+    if(Ly < Lx) {
+      // downsampling -- filter, then take the bottom of the spectrum
+      lpf_p->applyHalfSpectrum(X_half, X_half);
+      for(int i = 0; i < Y_half.size(); i++) {
+	Y_half[i] = X_half[i];
+      }
+    }
+    else {
+      // upsampling -- stuff the bottom of the spectrum, then filter.
+      // irfft scribbles on Y_half, so the top gets zeroed every time.
+      for(int i = 0; i < Y_half.size(); i++) {
+	Y_half[i] = (i < Lx / 2) ? X_half[i] : std::complex<T>(0.0, 0.0);
+      }
+      lpf_p->applyHalfSpectrum(Y_half, Y_half);
+    }
+
+    out_fft_p->irfft(Y_half, y_real);
+  }
+  
+  template<typename T>
+  uint32_t ReSampler::applyT(const std::complex<T> * in, size_t in_size, 
+			     std::complex<T> * out, size_t out_size) {
+    if(in_size != getInputBufferSize()) {
+      throw BadBufferSize("Input", in_size, getInputBufferSize());
+    }
+
+    if(out_size != getOutputBufferSize()) {
+      throw BadBufferSize("Output", out_size, getOutputBufferSize());
+    }
+
+    auto & w = getWork<T>();
+    if(w.stream.fill != 0) {
+      throw BadBufferSize("Input (after a partial push)", in_size, getInputBufferSize() - w.stream.fill);
+    }
+    initWork(w);
+    auto & x = w.x;
+    auto & y = w.y;
+    
+    shiftSave(x);
+    for(int i = save_count; i < Lx; i++) {
+      x.at(i) = in[i - save_count]; 
+    }
+
+    runBlock(w);
       
     // and copy to the output
     for(int i = 0; i < getOutputBufferSize(); i++) {
-      out.at(i) = y.at(i + discard_count);
+      out[i] = y.at(i + discard_count);
     }
 
-    apcount++; 
-    
     // and that's it!
     return 0;
   }
 
-  uint32_t ReSampler::apply(std::vector<float> & in,
-			    std::vector<float> & out) {
-    // not exactly optimal, but what were people thinking anyway?
-    std::vector<std::complex<float>> tin(in.size());
-    std::vector<std::complex<float>> tout(out.size());    
-    for(int i = 0; i < in.size(); i++) {
-      tin[i] = std::complex<float>(in[i], 0.0);
+  template<typename T>
+  uint32_t ReSampler::applyRealT(const T * in, size_t in_size, 
+				 T * out, size_t out_size) {
+    if(in_size != getInputBufferSize()) {
+      throw BadBufferSize("Input", in_size, getInputBufferSize());
     }
-    apply(tin, tout);
-    for(int i = 0; i < out.size(); i++) {
-      out[i] = tout[i].real();
+
+    if(out_size != getOutputBufferSize()) {
+      throw BadBufferSize("Output", out_size, getOutputBufferSize());
+    }
+
+    auto & w = getWork<T>();
+    if(w.real_stream.fill != 0) {
+      throw BadBufferSize("Input (after a partial push)", in_size, getInputBufferSize() - w.real_stream.fill);
+    }
+    initRealWork(w);
+    auto & x_real = w.x_real;
+    auto & y_real = w.y_real;
+    
+    // overlap-and-save, just like the complex path
+    shiftSave(x_real);
+    for(int i = save_count; i < Lx; i++) {
+      x_real[i] = in[i - save_count]; 
+    }
+
+    runRealBlock(w);
+
+    for(int i = 0; i < out_size; i++) {
+      out[i] = y_real[i + discard_count];
     }
 
-    return out.size();
+    return out_size;
+  }
+
+  template<typename ST, typename RunBlock>
+  uint32_t ReSampler::pushT(const ST * in, size_t in_size, 
+			    AlignedVector<ST> & x, AlignedVector<ST> & y, 
+			    Stream<ST> & stream, RunBlock run_block) {
+    // the good output is everything past the discard region
+    stream.out.configure(discard_count, getOutputBufferSize());
+    auto in_len = getInputBufferSize();
     
+    size_t in_pos = 0; 
+    while(in_pos < in_size) {
+      // starting a new block? Do the overlap-and-save thing first.
+      if(stream.fill == 0) shiftSave(x);
+
+      uint32_t count = std::min(size_t(in_len - stream.fill), in_size - in_pos);
+      std::copy(in + in_pos, in + in_pos + count, x.begin() + save_count + stream.fill);
+      in_pos += count;
+      stream.fill += count; 
+
+      if(stream.fill == in_len) {
+	run_block();
+	// trade the finished block for an empty output buffer
+	stream.out.push(y);
+	stream.fill = 0; 
+      }
+    }
+    return in_size; 
+  }
+
+  template<typename ST>
+  uint32_t ReSampler::pullT(ST * out, size_t out_size, Stream<ST> & stream) {
+    return stream.out.pull(out_size, 
+			   [out](const ST * src, unsigned int out_pos, unsigned int count) {
+			     std::copy(src, src + count, out + out_pos);
+			   });
+  }
+
+  template<typename T>
+  uint32_t ReSampler::pushComplexT(const std::complex<T> * in, size_t in_size) {
+    auto & w = getWork<T>();
+    initWork(w);
+    return pushT(in, in_size, w.x, w.y, w.stream, [this, &w]() { runBlock(w); });
+  }
+
+  template<typename T>
+  uint32_t ReSampler::pushRealT(const T * in, size_t in_size) {
+    auto & w = getWork<T>();
+    initRealWork(w);
+    return pushT(in, in_size, w.x_real, w.y_real, w.real_stream, [this, &w]() { runRealBlock(w); });
+  }
+  
+  uint32_t ReSampler::apply(std::vector<std::complex<float>> & in,
+			    std::vector<std::complex<float>> & out) {
+    return applyT(in.data(), in.size(), out.data(), out.size());
   }
 
+  uint32_t ReSampler::apply(std::vector<float> & in,
+			    std::vector<float> & out) {
+    return applyRealT(in.data(), in.size(), out.data(), out.size());
+  }
+
+  uint32_t ReSampler::apply(std::vector<std::complex<double>> & in,
+			    std::vector<std::complex<double>> & out) {
+    return applyT(in.data(), in.size(), out.data(), out.size());
+  }
+
+  uint32_t ReSampler::apply(std::vector<double> & in,
+			    std::vector<double> & out) {
+    return applyRealT(in.data(), in.size(), out.data(), out.size());
+  }
+
+  uint32_t ReSampler::apply(const std::complex<float> * in, unsigned int in_length, 
+			    std::complex<float> * out, unsigned int out_length) {
+    return applyT(in, in_length, out, out_length);
+  }
+
+  uint32_t ReSampler::apply(const float * in, unsigned int in_length, 
+			    float * out, unsigned int out_length) {
+    return applyRealT(in, in_length, out, out_length);
+  }
+
+  uint32_t ReSampler::apply(const std::complex<double> * in, unsigned int in_length, 
+			    std::complex<double> * out, unsigned int out_length) {
+    return applyT(in, in_length, out, out_length);
+  }
+
+  uint32_t ReSampler::apply(const double * in, unsigned int in_length, 
+			    double * out, unsigned int out_length) {
+    return applyRealT(in, in_length, out, out_length);
+  }
+
+  uint32_t ReSampler::push(const std::complex<float> * in, unsigned int in_length) {
+    return pushComplexT(in, in_length);
+  }
+
+  uint32_t ReSampler::push(const float * in, unsigned int in_length) {
+    return pushRealT(in, in_length);
+  }
+
+  uint32_t ReSampler::push(const std::complex<double> * in, unsigned int in_length) {
+    return pushComplexT(in, in_length);
+  }
+
+  uint32_t ReSampler::push(const double * in, unsigned int in_length) {
+    return pushRealT(in, in_length);
+  }
+
+  uint32_t ReSampler::pull(std::complex<float> * out, unsigned int out_length) {
+    return pullT(out, out_length, float_work.stream);
+  }
+
+  uint32_t ReSampler::pull(float * out, unsigned int out_length) {
+    return pullT(out, out_length, float_work.real_stream);
+  }
+
+  uint32_t ReSampler::pull(std::complex<double> * out, unsigned int out_length) {
+    return pullT(out, out_length, double_work.stream);
+  }
+
+  uint32_t ReSampler::pull(double * out, unsigned int out_length) {
+    return pullT(out, out_length, double_work.real_stream);
+  }
+  
   ReSampler::BadBufferSize::BadBufferSize(const std::string & st, uint32_t got_size, uint32_t should_be_size) :
 	std::runtime_error(SoDa::Format("ReSampler::BadBufferSize:: %0 buffer was length %1 should have been %2\n")
 			   .addS(st)
@@ -0,0 +1,405 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Remez.hxx"
+#include <cmath>
+#include <algorithm>
+#include <Utils/include/Format.hxx>
+
+namespace SoDa {
+
+  Remez::Remez(FilterSpec & filter_spec) : grid_taps(0) {
+    double sample_rate = filter_spec.getSampleRate();
+    real_taps = (filter_spec.getFilterType() == FilterSpec::REAL);
+
+    // the tolerances. The ripple is peak-to-peak, around the gain.
+    double rip = pow(10.0, filter_spec.getPassBandRipple() / 20.0);
+    pass_tolerance = (rip - 1.0) / (rip + 1.0);
+    stop_tolerance = pow(10.0, -filter_spec.getStopBandAttenuation() / 20.0);
+
+    // put the corners on the unit circle, in radians per sample.
+    // +pi and -pi are the same place.
+    std::vector<std::pair<double, double>> pts;
+    auto addPoint = [&](double w, double g) {
+      if(w >= M_PI) w -= 2.0 * M_PI;
+      pts.push_back(std::pair<double, double>(w, std::fabs(g)));
+    };
+    for(const auto & c : filter_spec.getSpec()) {
+      double w = 2.0 * M_PI * double(c.freq) / sample_rate;
+      addPoint(w, c.gain);
+      // a REAL filter's response is the same at -f as at f
+      if(real_taps && (w > 0.0)) addPoint(-w, c.gain);
+    }
+    std::stable_sort(pts.begin(), pts.end(), 
+		     [](const std::pair<double, double> & a, const std::pair<double, double> & b) {
+		       return a.first < b.first; 
+		     });
+    
+    unsigned int n = pts.size();
+    // point j, unwrapped so that we can go around the circle more than once
+    auto freq = [&](unsigned int j) { return pts[j % n].first + 2.0 * M_PI * double(j / n); };
+    auto gain = [&](unsigned int j) { return pts[j % n].second; };
+
+    // Start at the end of a transition band, so that no band
+    // wraps around the end of our list. 
+    const double tiny = 1e-9; 
+    int start = -1;
+    for(unsigned int i = 0; i < n; i++) {
+      if(gain(i) != gain(i + 1)) {
+	start = i + 1;
+	break; 
+      }
+    }
+    if(start < 0) {
+      throw BadSpec("Remez::Remez the specification has no transition bands -- all the corners have the same gain.");
+    }
+    
+    min_transition = 2.0 * M_PI; 
+    bool band_open = false; 
+    for(unsigned int j = start; j < start + n; j++) {
+      double lo = freq(j);
+      double hi = freq(j + 1);
+      if(gain(j) == gain(j + 1)) {
+	if((hi - lo) < tiny) continue; 
+	if(band_open) {
+	  bands.back().hi = hi;
+	}
+	else {
+	  Band b;
+	  b.lo = lo;
+	  b.hi = hi;
+	  b.gain = gain(j);
+	  b.weight = 1.0 / std::max(pass_tolerance * b.gain, stop_tolerance);
+	  bands.push_back(b);
+	  band_open = true; 
+	}
+      }
+      else {
+	if((hi - lo) < tiny) {
+	  throw BadSpec(SoDa::Format("Remez::Remez the gain steps from %0 to %1 at %2 Hz with no transition band.")
+			.addF(gain(j)).addF(gain(j + 1)).addF(pts[j % n].first * sample_rate / (2.0 * M_PI))
+			.str());
+	}
+	min_transition = std::min(min_transition, hi - lo);
+	band_open = false; 
+      }
+    }
+    
+    if(bands.empty()) {
+      throw BadSpec("Remez::Remez the specification has no bands -- no two neighboring corners have the same gain.");
+    }
+  }
+
+  void Remez::makeGrid(unsigned int num_taps) {
+    if(grid_taps == num_taps) return;
+    grid_taps = num_taps; 
+
+    // About 16 grid points per tap, but make sure that there are
+    // plenty of points to choose the extremal frequencies from,
+    // even when the bands are narrow. 
+    double band_width = 0.0;
+    for(const auto & b : bands) band_width += b.hi - b.lo; 
+    double step = std::min(2.0 * M_PI / (16.0 * double(num_taps)),
+			   band_width / (8.0 * double(num_taps + 1)));
+
+    grid_sin.clear();
+    grid_cos.clear();
+    grid_gain.clear();
+    grid_weight.clear();
+    grid_band.clear();
+    for(unsigned int bi = 0; bi < bands.size(); bi++) {
+      const auto & b = bands[bi];
+      unsigned int pts = std::max(2, int(ceil((b.hi - b.lo) / step)) + 1);
+      for(unsigned int i = 0; i < pts; i++) {
+	double w = b.lo + (b.hi - b.lo) * double(i) / double(pts - 1);
+	grid_sin.push_back(sin(0.5 * w));
+	grid_cos.push_back(cos(0.5 * w));
+	grid_gain.push_back(b.gain);
+	grid_weight.push_back(b.weight);
+	grid_band.push_back(bi);
+      }
+    }
+  }
+
+  // The response of a linear phase filter with N = 2M + 1 taps,
+  // centered on tap M, is exp(-jwM) A(w), where A(w) is a
+  // trigonometric polynomial of degree M -- a sum of cos(kw) and
+  // sin(kw) for k = 0...M.  (For a REAL filter, just the cosines.)
+  // That's N functions, so an approximation to the spec with the
+  // smallest weighted error E(w) touches +/- that error at N + 1
+  // frequencies, alternating in sign around the circle.  The Remez
+  // exchange guesses those frequencies, finds the A(w) that makes
+  // the error exactly +/- delta there, then moves the guesses to
+  // the peaks of the error, until the peaks are all the same size.
+  //
+  // Everything is done with barycentric formulas in the half angle,
+  // which are the trigonometric equivalent of the polynomial
+  // formulas in the classic Parks-McClellan program. 
+  double Remez::exchange(unsigned int N, std::vector<std::complex<double>> & h) {
+    unsigned int R = N + 1; 
+    unsigned int G = grid_gain.size();
+
+    // start with the extremal frequencies evenly spread over the grid
+    std::vector<unsigned int> ext(R);
+    for(unsigned int k = 0; k < R; k++) {
+      ext[k] = (unsigned int)((double(k) * double(G - 1)) / double(R - 1) + 0.5);
+    }
+    
+    // sin((a - b)/2) from the half angle sines and cosines
+    auto sinDiff = [&](unsigned int a, unsigned int b) {
+      return grid_sin[a] * grid_cos[b] - grid_cos[a] * grid_sin[b];
+    };
+
+    // barycentric weights 1 / prod_{j != k} sin((x_k - x_j)/2) for the first
+    // count extremal frequencies, scaled so the biggest is 1. (The raw
+    // products over- and underflow for long filters, and all the
+    // formulas are ratios, so the scale doesn't matter.)
+    std::vector<double> logw(R);
+    auto baryWeights = [&](unsigned int count, std::vector<double> & w) {
+      w.resize(count);
+      double maxlog = -1e300; 
+      for(unsigned int k = 0; k < count; k++) {
+	double lg = 0.0;
+	double sg = 1.0;
+	for(unsigned int j = 0; j < count; j++) {
+	  if(j == k) continue; 
+	  double s = sinDiff(ext[k], ext[j]);
+	  lg -= log(std::fabs(s));
+	  if(s < 0.0) sg = -sg; 
+	}
+	logw[k] = lg;
+	w[k] = sg; 
+	maxlog = std::max(maxlog, lg);
+      }
+      for(unsigned int k = 0; k < count; k++) {
+	w[k] = w[k] * exp(logw[k] - maxlog); 
+      }
+    };
+
+    std::vector<double> gamma, bw, A(N), err(G); 
+    double delta = 0.0;
+    double max_err = 0.0; 
+
+    // evaluate the interpolant through the first N extremal points
+    auto interpolate = [&](double s, double c) {
+      double num = 0.0;
+      double den = 0.0;
+      for(unsigned int k = 0; k < N; k++) {
+	double d = s * grid_cos[ext[k]] - c * grid_sin[ext[k]];
+	if(std::fabs(d) < 1e-15) return A[k];
+	double t = bw[k] / d;
+	num += t * A[k];
+	den += t; 
+      }
+      return num / den; 
+    };
+    
+    for(int iter = 0; iter < 100; iter++) {
+      // The weighted error is delta, -delta, delta... at the extremal
+      // frequencies. gamma is the combination of values at those
+      // frequencies that is zero for every A(w) we can make, which
+      // pins down delta.
+      baryWeights(R, gamma);
+      double num = 0.0;
+      double den = 0.0;
+      double sign = 1.0;
+      for(unsigned int k = 0; k < R; k++) {
+	num += gamma[k] * grid_gain[ext[k]];
+	den += sign * gamma[k] / grid_weight[ext[k]];
+	sign = -sign; 
+      }
+      delta = num / den;
+
+      // that gives the values of A(w) at the extremal frequencies
+      baryWeights(N, bw);
+      sign = 1.0; 
+      for(unsigned int k = 0; k < N; k++) {
+	A[k] = grid_gain[ext[k]] - sign * delta / grid_weight[ext[k]];
+	sign = -sign; 
+      }
+
+      // now find the error everywhere
+      max_err = 0.0; 
+      for(unsigned int i = 0; i < G; i++) {
+	err[i] = grid_weight[i] * (grid_gain[i] - interpolate(grid_sin[i], grid_cos[i]));
+	max_err = std::max(max_err, std::fabs(err[i]));
+      }
+
+      if((max_err - std::fabs(delta)) <= 1e-4 * max_err) break; 
+
+      // find the peaks of the error
+      std::vector<std::pair<unsigned int, double>> peaks; 
+      for(unsigned int i = 0; i < G; i++) {
+	double e = err[i];
+	bool has_left = (i > 0) && (grid_band[i - 1] == grid_band[i]);
+	bool has_right = (i + 1 < G) && (grid_band[i + 1] == grid_band[i]);
+	bool is_peak;
+	if(e > 0.0) {
+	  is_peak = (!has_left || (e >= err[i - 1])) && (!has_right || (e > err[i + 1]));
+	}
+	else if(e < 0.0) {
+	  is_peak = (!has_left || (e <= err[i - 1])) && (!has_right || (e < err[i + 1]));
+	}
+	else is_peak = false; 
+	if(!is_peak) continue; 
+
+	// keep the signs alternating -- of two peaks in a row with
+	// the same sign, keep the bigger one.
+	if(!peaks.empty() && ((peaks.back().second > 0.0) == (e > 0.0))) {
+	  if(std::fabs(e) > std::fabs(peaks.back().second)) peaks.back() = std::make_pair(i, e);
+	}
+	else {
+	  peaks.push_back(std::make_pair(i, e));
+	}
+      }
+      // ... all the way around the circle
+      while((peaks.size() > 1) && ((peaks.front().second > 0.0) == (peaks.back().second > 0.0))) {
+	if(std::fabs(peaks.front().second) < std::fabs(peaks.back().second)) peaks.erase(peaks.begin());
+	else peaks.pop_back();
+      }
+      // Too many? Drop the smallest, and then the smaller of its neighbors
+      // (which now have the same sign).  That keeps the alternation.
+      while(peaks.size() > R) {
+	unsigned int s = 0;
+	for(unsigned int i = 1; i < peaks.size(); i++) {
+	  if(std::fabs(peaks[i].second) < std::fabs(peaks[s].second)) s = i; 
+	}
+	peaks.erase(peaks.begin() + s);
+	unsigned int n = peaks.size();
+	unsigned int left = (s + n - 1) % n;
+	unsigned int right = s % n; 
+	peaks.erase(peaks.begin() + ((std::fabs(peaks[left].second) < std::fabs(peaks[right].second)) ? left : right));
+      }
+      // Too few? We can't do any better.
+      if(peaks.size() < R) break;
+
+      for(unsigned int k = 0; k < R; k++) ext[k] = peaks[k].first;
+    }
+
+    // Sample A(w) at N evenly spaced frequencies, and the inverse DFT
+    // of that gives the coefficients of A. Tap m is the coefficient of exp(j(M - m)w). 
+    unsigned int M = (N - 1) / 2;
+    std::vector<double> Aw(N);
+    for(unsigned int n = 0; n < N; n++) {
+      double w = 2.0 * M_PI * double(n) / double(N); 
+      Aw[n] = interpolate(sin(0.5 * w), cos(0.5 * w)); 
+    }
+    h.resize(N);
+    for(unsigned int m = 0; m < N; m++) {
+      int k = int(M) - int(m);
+      std::complex<double> acc(0.0, 0.0);
+      for(unsigned int n = 0; n < N; n++) {
+	// exp(-j 2 pi k n / N), with the argument reduced mod N to keep it accurate
+	long kn = ((long(k) * long(n)) % long(N) + long(N)) % long(N);
+	double ang = -2.0 * M_PI * double(kn) / double(N);
+	acc += Aw[n] * std::complex<double>(cos(ang), sin(ang));
+      }
+      h[m] = acc / double(N);
+    }
+    
+    return max_err; 
+  }
+  
+  double Remez::design(unsigned int num_taps, std::vector<std::complex<float>> & taps) {
+    // The exchange designs filters with an odd number of taps
+    unsigned int N = ((num_taps % 2) == 0) ? num_taps - 1 : num_taps; 
+    if(N < 1) N = 1; 
+    
+    makeGrid(N);
+    std::vector<std::complex<double>> h; 
+    double err = exchange(N, h);
+
+    taps.assign(std::max(num_taps, N), std::complex<float>(0.0, 0.0));
+    unsigned int first = taps.size() - N;
+    for(unsigned int i = 0; i < N; i++) {
+      taps[first + i] = real_taps ? std::complex<float>(h[i].real(), 0.0) : std::complex<float>(h[i]);
+    }
+    
+    return err; 
+  }
+
+  unsigned int Remez::estimateTaps() {
+    double dw = min_transition / (2.0 * M_PI); 
+    double ftaps = (-10.0 * log10(pass_tolerance * stop_tolerance) - 13.0) / (14.6 * dw) + 1.0; 
+    if(ftaps < 1.0) ftaps = 1.0; 
+    return 2 * (unsigned int)(ftaps / 2) + 1; // make sure it is odd
+  }
+  
+  unsigned int Remez::minimumTaps(unsigned int min_taps, unsigned int max_taps) {
+    // only odd lengths
+    min_taps = min_taps | 1;
+    max_taps = ((max_taps % 2) == 0) ? max_taps - 1 : max_taps;
+    if(max_taps <= min_taps) return min_taps; 
+
+    std::vector<std::complex<float>> taps; 
+    auto meets = [&](unsigned int n) { return design(n, taps) <= 1.0; };
+
+    unsigned int n = std::min(std::max(estimateTaps(), min_taps), max_taps);
+    
+    // bracket the answer between a length that fails (fail) and one
+    // that meets the spec (pass)...
+    unsigned int pass, fail;
+    unsigned int step = 2; 
+    if(meets(n)) {
+      pass = n;
+      while(true) {
+	if(pass <= min_taps) return min_taps; 
+	unsigned int t = (pass < min_taps + step) ? min_taps : pass - step; 
+	if(!meets(t)) {
+	  fail = t;
+	  break; 
+	}
+	pass = t;
+	step *= 2; 
+      }
+    }
+    else {
+      fail = n;
+      while(true) {
+	if(fail >= max_taps) return max_taps; 
+	unsigned int t = std::min(fail + step, max_taps);
+	if(meets(t)) {
+	  pass = t;
+	  break; 
+	}
+	fail = t;
+	step *= 2; 
+      }
+    }
+
+    // ... and split the difference
+    while((pass - fail) > 2) {
+      unsigned int t = (fail + (pass - fail) / 2) | 1;
+      if(meets(t)) pass = t;
+      else fail = t; 
+    }
+    return pass; 
+  }
+
+  Remez::BadSpec::BadSpec(const std::string & st) : std::runtime_error(st) { }
+}
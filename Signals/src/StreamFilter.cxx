@@ -0,0 +1,61 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StreamFilter.hxx"
+#include "FIRFilter.hxx"
+#include "OSFilter.hxx"
+
+namespace SoDa {
+  StreamFilterPtr StreamFilter::make(FilterSpec & filter_spec, 
+				     unsigned int buffer_size,
+				     float gain, 
+				     Filter::WindowChoice window) {
+    if(FIRFilter::directIsFaster(filter_spec.getTaps(), buffer_size)) {
+      return FIRFilter::make(filter_spec, buffer_size, gain, window);
+    }
+    else {
+      return OSFilter::make(filter_spec, buffer_size, gain, window);
+    }
+  }
+
+  StreamFilterPtr StreamFilter::make(float low_cutoff, 
+				     float high_cutoff, 
+				     float skirt,
+				     float sample_rate, 
+				     unsigned int buffer_size,
+				     float stop_band_attenuation,
+				     float gain,
+				     Filter::WindowChoice window) {
+    FilterSpec fspec(sample_rate, low_cutoff, high_cutoff, skirt,
+		     FilterSpec::COMPLEX,
+		     stop_band_attenuation);
+    // same estimate as the simple FIRFilter constructor
+    fspec.estimateTaps(3, 501, Filter::tapEstimate(window));
+    return make(fspec, buffer_size, gain, window);
+  }
+}
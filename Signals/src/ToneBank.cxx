@@ -0,0 +1,170 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ToneBank.hxx"
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+namespace SoDa {
+  ToneBank::ToneBank(float sample_rate, const std::vector<float> & freqs, 
+		     unsigned int block_length, Method method) :
+    method(method), block_length(block_length) {
+
+    double N = double(block_length);
+    for(auto f : freqs) {
+      if(fabs(f) > 0.5 * sample_rate) {
+	throw BadFrequency(sample_rate, f);
+      }
+      double w = 2.0 * M_PI * double(f) / double(sample_rate);
+      Tone t;
+      t.coeff = 2.0 * cos(w);
+      t.w_1 = std::polar(1.0, w);
+      t.w_n = std::polar(1.0, w * N);
+      t.w_neg = std::polar(1.0, -w);
+      t.rot = std::polar(1.0, -w * (N - 1.0));
+      tones.push_back(t);
+    }
+
+    if(method == SLIDING_DFT) {
+      history.resize(block_length);
+    }
+    
+    clear();
+  }
+
+  ToneBankPtr ToneBank::make(float sample_rate, const std::vector<float> & freqs, 
+			     unsigned int block_length, Method method) {
+    return std::make_shared<ToneBank>(sample_rate, freqs, block_length, method);
+  }
+
+  void ToneBank::clear() {
+    for(auto & t : tones) {
+      t.s1 = t.s2 = std::complex<double>(0.0, 0.0);
+      t.value = std::complex<float>(0.0, 0.0);
+    }
+    for(auto & h : history) {
+      h = std::complex<double>(0.0, 0.0);
+    }
+    history_idx = 0; 
+    sample_count = 0; 
+  }
+
+  unsigned int ToneBank::goertzelStep(const std::complex<double> & x) {
+    // s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2]
+    for(auto & t : tones) {
+      auto s0 = x + t.coeff * t.s1 - t.s2;
+      t.s2 = t.s1;
+      t.s1 = s0; 
+    }
+    sample_count++;
+    if(sample_count < block_length) return 0;
+
+    // end of the block. s[N-1] - exp(-jw) s[N-2] is the DFT
+    // with its phase referenced to the last sample.  rot
+    // moves the reference to the first sample. 
+    for(auto & t : tones) {
+      t.value = std::complex<float>(t.rot * (t.s1 - t.w_neg * t.s2));
+      t.s1 = t.s2 = std::complex<double>(0.0, 0.0);
+    }
+    sample_count = 0; 
+    return 1; 
+  }
+
+  unsigned int ToneBank::slidingStep(const std::complex<double> & x) {
+    // S[n] = x[n] + exp(jw) S[n-1] - exp(jwN) x[n-N]
+    auto oldest = history[history_idx];
+    history[history_idx] = x;
+    history_idx++;
+    if(history_idx == block_length) history_idx = 0; 
+    
+    for(auto & t : tones) {
+      t.s1 = x + t.w_1 * t.s1 - t.w_n * oldest; 
+    }
+
+    if(sample_count < block_length) {
+      sample_count++;
+      if(sample_count < block_length) return 0;
+    }
+
+    for(auto & t : tones) {
+      t.value = std::complex<float>(t.rot * t.s1);
+    }
+    return 1; 
+  }
+  
+  template<typename ST>
+  unsigned int ToneBank::applyT(const ST * in, unsigned int length) {
+    unsigned int ret = 0; 
+    if(method == GOERTZEL) {
+      for(unsigned int i = 0; i < length; i++) {
+	ret += goertzelStep(std::complex<double>(in[i]));
+      }
+    }
+    else {
+      for(unsigned int i = 0; i < length; i++) {
+	ret += slidingStep(std::complex<double>(in[i]));
+      }
+    }
+    return ret; 
+  }
+
+  unsigned int ToneBank::apply(const std::vector<std::complex<float>> & in) {
+    return applyT(in.data(), in.size());
+  }
+
+  unsigned int ToneBank::apply(const std::vector<float> & in) {
+    return applyT(in.data(), in.size());
+  }
+
+  unsigned int ToneBank::apply(const std::complex<float> * in, unsigned int length) {
+    return applyT(in, length);
+  }
+
+  unsigned int ToneBank::apply(const float * in, unsigned int length) {
+    return applyT(in, length);
+  }
+
+  void ToneBank::get(std::vector<std::complex<float>> & out) const {
+    out.resize(tones.size());
+    for(int i = 0; i < tones.size(); i++) {
+      out[i] = tones[i].value; 
+    }
+  }
+
+  void ToneBank::getMagnitude(std::vector<float> & out) const {
+    out.resize(tones.size());
+    float scale = 1.0 / float(block_length);
+    for(int i = 0; i < tones.size(); i++) {
+      out[i] = std::abs(tones[i].value) * scale; 
+    }
+  }
+  
+  ToneBank::BadFrequency::BadFrequency(double fs, double fr) : 
+    std::runtime_error(SoDa::Format("SoDa::ToneBank Frequency is out-of bounds. Sample Freq %0 Requested Freq %1\n").addF(fs, 'e').addF(fr, 'e').str()) {
+  }
+}
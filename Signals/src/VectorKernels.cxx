@@ -0,0 +1,228 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "VectorKernels.hxx"
+#include "VectorKernelsSIMD.hxx"
+#include <atomic>
+
+namespace SoDa {
+  namespace VectorKernelsImpl {
+    namespace {
+      Table getScalarTable() {
+	Table t;
+	t.mul_f = mulScalar<float>;
+	t.mul_d = mulScalar<double>;
+	t.mul_conj_f = mulConjScalar<float>;
+	t.mul_conj_d = mulConjScalar<double>;
+	t.mul_acc_f = mulAccScalar<float>;
+	t.mul_acc_d = mulAccScalar<double>;
+	t.mul_acc_s_f = mulAccSScalar<float>;
+	t.mul_acc_s_d = mulAccSScalar<double>;
+	t.mul_acc_r_f = mulAccRScalar<float>;
+	t.mul_acc_r_d = mulAccRScalar<double>;
+	t.scale_f = scaleScalar<float>;
+	t.scale_d = scaleScalar<double>;
+	return t; 
+      }
+
+      bool cpuSupports(VectorKernels::ISA isa) {
+	switch(isa) {
+	case VectorKernels::SCALAR:
+	  return true; 
+#ifdef SODA_VECTOR_KERNELS_X86
+	  // __builtin_cpu_supports checks that the OS saves the
+	  // wide registers, too.
+	case VectorKernels::SSE2:
+	  return __builtin_cpu_supports("sse2");
+	case VectorKernels::AVX2:
+	  return __builtin_cpu_supports("avx2");
+	case VectorKernels::AVX512:
+	  return __builtin_cpu_supports("avx512f");
+#endif
+	default:
+	  return false; 
+	}
+      }
+
+      Table getTable(VectorKernels::ISA isa) {
+	switch(isa) {
+#ifdef SODA_VECTOR_KERNELS_X86
+	case VectorKernels::SSE2:
+	  return getSSE2Table();
+	case VectorKernels::AVX2:
+	  return getAVX2Table();
+	case VectorKernels::AVX512:
+	  return getAVX512Table();
+#endif
+	default:
+	  return getScalarTable();
+	}
+      }
+
+      VectorKernels::ISA pickISA() {
+	for(auto isa : { VectorKernels::AVX512, VectorKernels::AVX2, VectorKernels::SSE2 }) {
+	  if(cpuSupports(isa)) return isa; 
+	}
+	return VectorKernels::SCALAR; 
+      }
+
+      struct Entry {
+	VectorKernels::ISA isa;
+	Table table; 
+      };
+      
+      // Every ISA's table is built up front and never changes.  setISA
+      // just swings the pointer, so a thread that is running a kernel
+      // while another calls setISA gets one table or the other, never
+      // a mixture. 
+      struct Dispatch {
+	Dispatch() {
+	  for(int i = 0; i <= VectorKernels::AVX512; i++) {
+	    auto isa = VectorKernels::ISA(i);
+	    entries[i] = Entry{isa, getTable(isa)};
+	  }
+	  current.store(&entries[pickISA()]);
+	}
+	Entry entries[VectorKernels::AVX512 + 1];
+	std::atomic<const Entry *> current; 
+      };
+
+      // made on first use, so we don't care about static init order.
+      Dispatch & dispatch() {
+	static Dispatch d;
+	return d; 
+      }
+
+      const Entry & current() {
+	return *dispatch().current.load(std::memory_order_acquire);
+      }
+      
+      const Table & kernels() {
+	return current().table; 
+      }
+
+      template<typename T>
+      const T * flat(const std::complex<T> * p) { return reinterpret_cast<const T*>(p); }
+      template<typename T>
+      T * flat(std::complex<T> * p) { return reinterpret_cast<T*>(p); }
+    }
+  }
+
+  using namespace VectorKernelsImpl; 
+  
+  void VectorKernels::mul(const std::complex<float> * a, const std::complex<float> * b, 
+			  std::complex<float> * out, unsigned int length) {
+    kernels().mul_f(flat(a), flat(b), flat(out), length);
+  }
+
+  void VectorKernels::mul(const std::complex<double> * a, const std::complex<double> * b, 
+			  std::complex<double> * out, unsigned int length) {
+    kernels().mul_d(flat(a), flat(b), flat(out), length);
+  }
+
+  void VectorKernels::mulConj(const std::complex<float> * a, const std::complex<float> * b, 
+			      std::complex<float> * out, unsigned int length) {
+    kernels().mul_conj_f(flat(a), flat(b), flat(out), length);
+  }
+
+  void VectorKernels::mulConj(const std::complex<double> * a, const std::complex<double> * b, 
+			      std::complex<double> * out, unsigned int length) {
+    kernels().mul_conj_d(flat(a), flat(b), flat(out), length);
+  }
+
+  void VectorKernels::mulAcc(const std::complex<float> * a, const std::complex<float> * b, 
+			     std::complex<float> * acc, unsigned int length) {
+    kernels().mul_acc_f(flat(a), flat(b), flat(acc), length);
+  }
+
+  void VectorKernels::mulAcc(const std::complex<double> * a, const std::complex<double> * b, 
+			     std::complex<double> * acc, unsigned int length) {
+    kernels().mul_acc_d(flat(a), flat(b), flat(acc), length);
+  }
+
+  void VectorKernels::mulAcc(const std::complex<float> * a, std::complex<float> s, 
+			     std::complex<float> * acc, unsigned int length) {
+    kernels().mul_acc_s_f(flat(a), flat(&s), flat(acc), length);
+  }
+
+  void VectorKernels::mulAcc(const std::complex<double> * a, std::complex<double> s, 
+			     std::complex<double> * acc, unsigned int length) {
+    kernels().mul_acc_s_d(flat(a), flat(&s), flat(acc), length);
+  }
+
+  void VectorKernels::mulAcc(const float * a, float s, float * acc, unsigned int length) {
+    kernels().mul_acc_r_f(a, s, acc, length);
+  }
+
+  void VectorKernels::mulAcc(const double * a, double s, double * acc, unsigned int length) {
+    kernels().mul_acc_r_d(a, s, acc, length);
+  }
+
+  void VectorKernels::scale(const float * a, float s, float * out, unsigned int length) {
+    kernels().scale_f(a, s, out, length);
+  }
+
+  void VectorKernels::scale(const double * a, double s, double * out, unsigned int length) {
+    kernels().scale_d(a, s, out, length);
+  }
+
+  void VectorKernels::scale(const std::complex<float> * a, float s, 
+			    std::complex<float> * out, unsigned int length) {
+    kernels().scale_f(flat(a), s, flat(out), 2 * size_t(length));
+  }
+
+  void VectorKernels::scale(const std::complex<double> * a, double s, 
+			    std::complex<double> * out, unsigned int length) {
+    kernels().scale_d(flat(a), s, flat(out), 2 * size_t(length));
+  }
+
+  VectorKernels::ISA VectorKernels::getISA() {
+    return current().isa; 
+  }
+
+  bool VectorKernels::isSupported(ISA isa) {
+    return cpuSupports(isa);
+  }
+
+  bool VectorKernels::setISA(ISA isa) {
+    if(!isSupported(isa)) return false; 
+    auto & d = dispatch();
+    d.current.store(&d.entries[isa], std::memory_order_release);
+    return true; 
+  }
+
+  std::string VectorKernels::getISAName(ISA isa) {
+    switch(isa) {
+    case SCALAR: return "scalar";
+    case SSE2: return "sse2";
+    case AVX2: return "avx2";
+    case AVX512: return "avx512";
+    }
+    return "unknown";
+  }
+}
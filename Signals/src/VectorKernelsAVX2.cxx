@@ -0,0 +1,80 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// AVX2 versions of the VectorKernels.  This file is compiled with -mavx2.
+// (Nothing here needs more than AVX, but the dispatcher asks for AVX2, and
+// any machine worth picking the 256 bit path on has it.)
+
+#include "VectorKernelsSIMD.hxx"
+#include <immintrin.h>
+
+namespace SoDa {
+  namespace VectorKernelsImpl {
+    namespace {
+      struct AVX2Float {
+	typedef float T;
+	typedef __m256 vec;
+	static const size_t C = 4;
+	static vec load(const T * p) { return _mm256_loadu_ps(p); }
+	static void store(T * p, vec v) { _mm256_storeu_ps(p, v); }
+	static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+	static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+	static vec set1(T s) { return _mm256_set1_ps(s); }
+	static vec dupRe(vec b) { return _mm256_moveldup_ps(b); }
+	static vec dupIm(vec b) { return _mm256_movehdup_ps(b); }
+	static vec swap(vec a) { return _mm256_permute_ps(a, 0xb1); }
+	static vec negRe(vec v) { 
+	  return _mm256_xor_ps(v, _mm256_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f));
+	}
+	static vec negIm(vec v) {
+	  return _mm256_xor_ps(v, _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f));
+	}
+      };
+
+      struct AVX2Double {
+	typedef double T;
+	typedef __m256d vec;
+	static const size_t C = 2;
+	static vec load(const T * p) { return _mm256_loadu_pd(p); }
+	static void store(T * p, vec v) { _mm256_storeu_pd(p, v); }
+	static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+	static vec mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+	static vec set1(T s) { return _mm256_set1_pd(s); }
+	static vec dupRe(vec b) { return _mm256_movedup_pd(b); }
+	static vec dupIm(vec b) { return _mm256_permute_pd(b, 0xf); }
+	static vec swap(vec a) { return _mm256_permute_pd(a, 0x5); }
+	static vec negRe(vec v) { return _mm256_xor_pd(v, _mm256_setr_pd(-0.0, 0.0, -0.0, 0.0)); }
+	static vec negIm(vec v) { return _mm256_xor_pd(v, _mm256_setr_pd(0.0, -0.0, 0.0, -0.0)); }
+      };
+    }
+
+    Table getAVX2Table() {
+      return makeTable<AVX2Float, AVX2Double>();
+    }
+  }
+}
@@ -0,0 +1,91 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// AVX-512 versions of the VectorKernels.  This file is compiled with -mavx512f.
+// AVX-512F has no floating point xor (that's in AVX-512DQ), so the sign flips
+// go through the integer side. 
+//
+// The shuffles use the merge-masked forms with every lane selected.
+// The plain forms pass _mm512_undefined_* as the merge source, and
+// gcc's -O3 -Wall warns that it "may be used uninitialized". 
+
+#include "VectorKernelsSIMD.hxx"
+#include <immintrin.h>
+
+namespace SoDa {
+  namespace VectorKernelsImpl {
+    namespace {
+      struct AVX512Float {
+	typedef float T;
+	typedef __m512 vec;
+	static const size_t C = 8;
+	static vec load(const T * p) { return _mm512_loadu_ps(p); }
+	static void store(T * p, vec v) { _mm512_storeu_ps(p, v); }
+	static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+	static vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+	static vec set1(T s) { return _mm512_set1_ps(s); }
+	static vec dupRe(vec b) { return _mm512_mask_moveldup_ps(b, 0xffff, b); }
+	static vec dupIm(vec b) { return _mm512_mask_movehdup_ps(b, 0xffff, b); }
+	static vec swap(vec a) { return _mm512_mask_permute_ps(a, 0xffff, a, 0xb1); }
+	static vec flip(vec v, long long mask) {
+	  return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), _mm512_set1_epi64(mask)));
+	}
+	// the sign bit of the low (even, real) float is bit 31 of each 64 bit lane
+	static vec negRe(vec v) { return flip(v, 0x80000000LL); }
+	static vec negIm(vec v) { return flip(v, (long long)0x8000000000000000ULL); }
+      };
+
+      struct AVX512Double {
+	typedef double T;
+	typedef __m512d vec;
+	static const size_t C = 4;
+	static vec load(const T * p) { return _mm512_loadu_pd(p); }
+	static void store(T * p, vec v) { _mm512_storeu_pd(p, v); }
+	static vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+	static vec mul(vec a, vec b) { return _mm512_mul_pd(a, b); }
+	static vec set1(T s) { return _mm512_set1_pd(s); }
+	static vec dupRe(vec b) { return _mm512_mask_movedup_pd(b, 0xff, b); }
+	static vec dupIm(vec b) { return _mm512_mask_permute_pd(b, 0xff, b, 0xff); }
+	static vec swap(vec a) { return _mm512_mask_permute_pd(a, 0xff, a, 0x55); }
+	static vec flip(vec v, __m512i mask) {
+	  return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(v), mask));
+	}
+	static vec negRe(vec v) { 
+	  return flip(v, _mm512_set4_epi64(0, (long long)0x8000000000000000ULL, 0, (long long)0x8000000000000000ULL));
+	}
+	static vec negIm(vec v) { 
+	  return flip(v, _mm512_set4_epi64((long long)0x8000000000000000ULL, 0, (long long)0x8000000000000000ULL, 0));
+	}
+      };
+    }
+
+    Table getAVX512Table() {
+      return makeTable<AVX512Float, AVX512Double>();
+    }
+  }
+}
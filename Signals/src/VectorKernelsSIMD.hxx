@@ -0,0 +1,240 @@
+#pragma once
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+///
+///  @file VectorKernelsSIMD.hxx
+///  @brief Private to the VectorKernels implementation: the dispatch
+///  table, the scalar reference loops, and the generic SIMD loops that
+///  each ISA specific file instantiates.
+///
+///  Everything that gets compiled into code lives in an anonymous
+///  namespace.  Each ISA file is compiled with its own -m flags, and
+///  we don't want the linker to pick the AVX-512 copy of a scalar loop
+///  for a machine that can't run it.
+///
+///  @author M. H. Reilly (kb1vc)
+///  @date   Oct, 2026
+///
+
+#include <cstddef>
+
+namespace SoDa {
+  namespace VectorKernelsImpl {
+    /// The kernels for one instruction set.  Complex vectors
+    /// are passed as interleaved re/im arrays, and the lengths of
+    /// the mul functions count complex elements. 
+    struct Table {
+      void (*mul_f)(const float * a, const float * b, float * out, size_t n);
+      void (*mul_d)(const double * a, const double * b, double * out, size_t n);
+      void (*mul_conj_f)(const float * a, const float * b, float * out, size_t n);
+      void (*mul_conj_d)(const double * a, const double * b, double * out, size_t n);
+      void (*mul_acc_f)(const float * a, const float * b, float * acc, size_t n);
+      void (*mul_acc_d)(const double * a, const double * b, double * acc, size_t n);
+      /// s is a single complex value (re, im)
+      void (*mul_acc_s_f)(const float * a, const float * s, float * acc, size_t n);
+      void (*mul_acc_s_d)(const double * a, const double * s, double * acc, size_t n);
+      /// n counts reals from here down
+      void (*mul_acc_r_f)(const float * a, float s, float * acc, size_t n);
+      void (*mul_acc_r_d)(const double * a, double s, double * acc, size_t n);
+      void (*scale_f)(const float * a, float s, float * out, size_t n);
+      void (*scale_d)(const double * a, double s, double * out, size_t n);
+    };
+
+    /// defined in VectorKernelsSSE2.cxx, VectorKernelsAVX2.cxx, and VectorKernelsAVX512.cxx
+    Table getSSE2Table();
+    Table getAVX2Table();
+    Table getAVX512Table();
+    
+    namespace {
+      // The scalar versions are the reference.  The SIMD versions
+      // use them to finish off the last partial vector. 
+      template<typename T>
+      void mulScalar(const T * a, const T * b, T * out, size_t n) {
+	for(size_t i = 0; i < 2 * n; i += 2) {
+	  T ar = a[i], ai = a[i + 1], br = b[i], bi = b[i + 1];
+	  out[i] = ar * br - ai * bi;
+	  out[i + 1] = ai * br + ar * bi;
+	}
+      }
+
+      template<typename T>
+      void mulConjScalar(const T * a, const T * b, T * out, size_t n) {
+	for(size_t i = 0; i < 2 * n; i += 2) {
+	  T ar = a[i], ai = a[i + 1], br = b[i], bi = b[i + 1];
+	  out[i] = ar * br + ai * bi;
+	  out[i + 1] = ai * br - ar * bi;
+	}
+      }
+
+      template<typename T>
+      void mulAccScalar(const T * a, const T * b, T * acc, size_t n) {
+	for(size_t i = 0; i < 2 * n; i += 2) {
+	  T ar = a[i], ai = a[i + 1], br = b[i], bi = b[i + 1];
+	  T pr = ar * br - ai * bi;
+	  T pi = ai * br + ar * bi; 
+	  acc[i] = acc[i] + pr;
+	  acc[i + 1] = acc[i + 1] + pi;
+	}
+      }
+
+      template<typename T>
+      void mulAccSScalar(const T * a, const T * s, T * acc, size_t n) {
+	T sr = s[0], si = s[1];
+	for(size_t i = 0; i < 2 * n; i += 2) {
+	  T ar = a[i], ai = a[i + 1];
+	  T pr = ar * sr - ai * si;
+	  T pi = ai * sr + ar * si; 
+	  acc[i] = acc[i] + pr;
+	  acc[i + 1] = acc[i + 1] + pi;
+	}
+      }
+
+      template<typename T>
+      void mulAccRScalar(const T * a, T s, T * acc, size_t n) {
+	for(size_t i = 0; i < n; i++) {
+	  acc[i] = acc[i] + a[i] * s; 
+	}
+      }
+      
+      template<typename T>
+      void scaleScalar(const T * a, T s, T * out, size_t n) {
+	for(size_t i = 0; i < n; i++) {
+	  out[i] = a[i] * s; 
+	}
+      }
+
+      // The SIMD loops.  V describes a vector register holding V::C
+      // complex values:
+      //   V::T -- float or double
+      //   V::vec -- the register type
+      //   load, store, add, mul, set1 -- the obvious
+      //   dupRe(b) -- [br, br, ...]  dupIm(b) -- [bi, bi, ...]
+      //   swap(a) -- [ai, ar, ...]
+      //   negRe(v), negIm(v) -- flip the sign of the even/odd lanes
+      //
+      // a * b = a * dupRe(b) + negRe(swap(a) * dupIm(b))
+      // a * conj(b) = a * dupRe(b) + negIm(swap(a) * dupIm(b))
+      //
+      // x + (-y) is exactly x - y, so these match the scalar loops bit for bit.
+      template<typename V>
+      inline typename V::vec cmul(typename V::vec a, typename V::vec b) {
+	return V::add(V::mul(a, V::dupRe(b)), V::negRe(V::mul(V::swap(a), V::dupIm(b))));
+      }
+
+      template<typename V>
+      inline typename V::vec cmulConj(typename V::vec a, typename V::vec b) {
+	return V::add(V::mul(a, V::dupRe(b)), V::negIm(V::mul(V::swap(a), V::dupIm(b))));
+      }
+      
+      template<typename V>
+      void mulSIMD(const typename V::T * a, const typename V::T * b, typename V::T * out, size_t n) {
+	size_t i = 0;
+	for( ; i + V::C <= n; i += V::C) {
+	  V::store(out + 2 * i, cmul<V>(V::load(a + 2 * i), V::load(b + 2 * i)));
+	}
+	mulScalar(a + 2 * i, b + 2 * i, out + 2 * i, n - i);
+      }
+
+      template<typename V>
+      void mulConjSIMD(const typename V::T * a, const typename V::T * b, typename V::T * out, size_t n) {
+	size_t i = 0;
+	for( ; i + V::C <= n; i += V::C) {
+	  V::store(out + 2 * i, cmulConj<V>(V::load(a + 2 * i), V::load(b + 2 * i)));
+	}
+	mulConjScalar(a + 2 * i, b + 2 * i, out + 2 * i, n - i);
+      }
+
+      template<typename V>
+      void mulAccSIMD(const typename V::T * a, const typename V::T * b, typename V::T * acc, size_t n) {
+	size_t i = 0;
+	for( ; i + V::C <= n; i += V::C) {
+	  auto p = cmul<V>(V::load(a + 2 * i), V::load(b + 2 * i));
+	  V::store(acc + 2 * i, V::add(V::load(acc + 2 * i), p));
+	}
+	mulAccScalar(a + 2 * i, b + 2 * i, acc + 2 * i, n - i);
+      }
+
+      template<typename V>
+      void mulAccSSIMD(const typename V::T * a, const typename V::T * s, typename V::T * acc, size_t n) {
+	size_t i = 0;
+	// make a vector of [sr, si, sr, si, ...]
+	typename V::T sv[2 * V::C];
+	for(size_t j = 0; j < 2 * V::C; j += 2) {
+	  sv[j] = s[0];
+	  sv[j + 1] = s[1];
+	}
+	auto vs = V::load(sv);
+	for( ; i + V::C <= n; i += V::C) {
+	  auto p = cmul<V>(V::load(a + 2 * i), vs);
+	  V::store(acc + 2 * i, V::add(V::load(acc + 2 * i), p));
+	}
+	mulAccSScalar(a + 2 * i, s, acc + 2 * i, n - i);
+      }
+
+      template<typename V>
+      void mulAccRSIMD(const typename V::T * a, typename V::T s, typename V::T * acc, size_t n) {
+	size_t i = 0;
+	auto vs = V::set1(s);
+	for( ; i + 2 * V::C <= n; i += 2 * V::C) {
+	  V::store(acc + i, V::add(V::load(acc + i), V::mul(V::load(a + i), vs)));
+	}
+	mulAccRScalar(a + i, s, acc + i, n - i);
+      }
+      
+      template<typename V>
+      void scaleSIMD(const typename V::T * a, typename V::T s, typename V::T * out, size_t n) {
+	size_t i = 0;
+	auto vs = V::set1(s);
+	for( ; i + 2 * V::C <= n; i += 2 * V::C) {
+	  V::store(out + i, V::mul(V::load(a + i), vs));
+	}
+	scaleScalar(a + i, s, out + i, n - i);
+      }
+
+      /// fill a table from the float and double traits for one ISA
+      template<typename VF, typename VD>
+      Table makeTable() {
+	Table t;
+	t.mul_f = mulSIMD<VF>;
+	t.mul_d = mulSIMD<VD>;
+	t.mul_conj_f = mulConjSIMD<VF>;
+	t.mul_conj_d = mulConjSIMD<VD>;
+	t.mul_acc_f = mulAccSIMD<VF>;
+	t.mul_acc_d = mulAccSIMD<VD>;
+	t.mul_acc_s_f = mulAccSSIMD<VF>;
+	t.mul_acc_s_d = mulAccSSIMD<VD>;
+	t.mul_acc_r_f = mulAccRSIMD<VF>;
+	t.mul_acc_r_d = mulAccRSIMD<VD>;
+	t.scale_f = scaleSIMD<VF>;
+	t.scale_d = scaleSIMD<VD>;
+	return t; 
+      }
+    }
+  }
+}
@@ -0,0 +1,74 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// SSE2 versions of the VectorKernels.  This file is compiled with -msse2.
+
+#include "VectorKernelsSIMD.hxx"
+#include <emmintrin.h>
+
+namespace SoDa {
+  namespace VectorKernelsImpl {
+    namespace {
+      struct SSE2Float {
+	typedef float T;
+	typedef __m128 vec;
+	static const size_t C = 2;
+	static vec load(const T * p) { return _mm_loadu_ps(p); }
+	static void store(T * p, vec v) { _mm_storeu_ps(p, v); }
+	static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+	static vec mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+	static vec set1(T s) { return _mm_set1_ps(s); }
+	static vec dupRe(vec b) { return _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0)); }
+	static vec dupIm(vec b) { return _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1)); }
+	static vec swap(vec a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)); }
+	static vec negRe(vec v) { return _mm_xor_ps(v, _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f)); }
+	static vec negIm(vec v) { return _mm_xor_ps(v, _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f)); }
+      };
+
+      struct SSE2Double {
+	typedef double T;
+	typedef __m128d vec;
+	static const size_t C = 1;
+	static vec load(const T * p) { return _mm_loadu_pd(p); }
+	static void store(T * p, vec v) { _mm_storeu_pd(p, v); }
+	static vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+	static vec mul(vec a, vec b) { return _mm_mul_pd(a, b); }
+	static vec set1(T s) { return _mm_set1_pd(s); }
+	static vec dupRe(vec b) { return _mm_unpacklo_pd(b, b); }
+	static vec dupIm(vec b) { return _mm_unpackhi_pd(b, b); }
+	static vec swap(vec a) { return _mm_shuffle_pd(a, a, 1); }
+	static vec negRe(vec v) { return _mm_xor_pd(v, _mm_setr_pd(-0.0, 0.0)); }
+	static vec negIm(vec v) { return _mm_xor_pd(v, _mm_setr_pd(0.0, -0.0)); }
+      };
+    }
+
+    Table getSSE2Table() {
+      return makeTable<SSE2Float, SSE2Double>();
+    }
+  }
+}
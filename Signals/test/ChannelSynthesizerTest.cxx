@@ -0,0 +1,211 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/ChannelSynthesizer.hxx"
+#include "../include/Channelizer.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <random>
+
+// Check the synthesis bank against the upsample-filter-mix
+// definition, and check that a Channelizer followed by a
+// ChannelSynthesizer hands back its input.
+
+static const char * modeName(SoDa::Channelizer::Mode mode) {
+  return (mode == SoDa::Channelizer::CRITICAL) ? "critical" : "2x oversampled";
+}
+
+bool checkDefinition(SoDa::Channelizer::Mode mode) {
+  unsigned int M = 16;
+  SoDa::ChannelSynthesizer synth(1.0e6, M, mode, 8);
+  std::vector<float> g;
+  synth.getPrototype(g);
+  unsigned int D = synth.getInterpolation();
+  
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  // blocks of different lengths, to check that the partial sums and
+  // the frame phase carry across calls. 
+  std::vector<unsigned int> frame_counts = { 5, 1, 17, 3 };
+  unsigned int total_frames = 0;
+  for(auto f : frame_counts) total_frames += f;
+  // y[m][k]
+  std::vector<std::vector<std::complex<float>>> y(total_frames, std::vector<std::complex<float>>(M));
+  for(auto & fr : y) for(auto & v : fr) v = std::complex<float>(dist(gen), dist(gen));
+
+  double err = 0.0;
+  unsigned int frame = 0; 
+  for(auto frames : frame_counts) {
+    std::vector<std::complex<float>> in(frames * M), out(frames * D);
+    for(unsigned int k = 0; k < M; k++) {
+      for(unsigned int f = 0; f < frames; f++) {
+	in[k * frames + f] = y[frame + f][k];
+      }
+    }
+    if(synth.apply(in, out) != frames) {
+      std::cout << modeName(mode) << " apply returned the wrong frame count\n";
+      return false; 
+    }
+    for(unsigned int i = 0; i < frames * D; i++) {
+      int n = frame * D + i; 
+      std::complex<double> ref(0.0, 0.0);
+      for(int m = 0; (m * D <= n) && (m < total_frames); m++) {
+	int l = n - m * D; 
+	if(l >= g.size()) continue; 
+	for(unsigned int k = 0; k < M; k++) {
+	  ref += double(D) * double(g[l]) * std::complex<double>(y[m][k])
+	    * std::polar(1.0, 2.0 * M_PI * double(k) * double(n) / double(M));
+	}
+      }
+      err = std::max(err, std::abs(std::complex<double>(out[i]) - ref));
+    }
+    frame += frames; 
+  }
+  if(err > 1e-4) {
+    std::cout << SoDa::Format("%0 synthesizer differs from the definition by %1\n")
+      .addS(modeName(mode)).addF(err, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkTone() {
+  unsigned int M = 32;
+  double fs = 3.2e6; 
+  auto synth = SoDa::ChannelSynthesizer::make(fs, M);
+  unsigned int frames = 64;
+  unsigned int D = synth->getInterpolation();
+  std::vector<std::complex<float>> in(frames * M), out(frames * D);
+  // a constant in channel 5 should come out as a tone at 500 kHz
+  unsigned int tk = 5; 
+  for(unsigned int f = 0; f < frames; f++) in[tk * frames + f] = std::complex<float>(1.0, 0.0);
+  double freq = synth->getChannelFrequency(tk);
+  bool ok = true; 
+  for(int b = 0; b < 3; b++) {
+    synth->apply(in, out);
+  }
+  double err = 0.0;
+  uint64_t n0 = 2 * frames * D; 
+  for(unsigned int i = 0; i < out.size(); i++) {
+    std::complex<double> ref = std::polar(1.0, 2.0 * M_PI * freq * double(n0 + i) / fs);
+    err = std::max(err, std::abs(std::complex<double>(out[i]) - ref));
+  }
+  if(err > 0.02) {
+    std::cout << SoDa::Format("Tone in channel %0 is off by %1\n").addI(tk).addF(err, 'e');
+    ok = false; 
+  }
+  return ok; 
+}
+
+bool checkReconstruction() {
+  unsigned int M = 16; 
+  double fs = 1.0e6; 
+  auto mode = SoDa::Channelizer::OVERSAMPLED_2X;
+  SoDa::Channelizer chan(fs, M, mode);
+  SoDa::ChannelSynthesizer synth(fs, M, mode);
+  unsigned int D = chan.getDecimation();
+  unsigned int frames = 32; 
+  unsigned int len = frames * D; 
+  unsigned int blocks = 24; 
+
+  // the delay through the pair is where an impulse comes out
+  std::vector<std::complex<float>> x(len * blocks), xhat(len * blocks);
+  x[0] = 1.0; 
+  std::vector<std::complex<float>> chans(frames * M);
+  for(int b = 0; b < blocks; b++) {
+    chan.apply(x.data() + b * len, len, chans.data(), chans.size());
+    synth.apply(chans.data(), chans.size(), xhat.data() + b * len, len);
+  }
+  unsigned int delay = 0; 
+  for(int i = 0; i < xhat.size(); i++) {
+    if(std::abs(xhat[i]) > std::abs(xhat[delay])) delay = i; 
+  }
+
+  chan.clear();
+  synth.clear();
+  std::mt19937 gen(5);
+  std::normal_distribution<double> dist(0.0, 1.0);
+  for(auto & v : x) v = std::complex<float>(dist(gen), dist(gen));
+  for(int b = 0; b < blocks; b++) {
+    chan.apply(x.data() + b * len, len, chans.data(), chans.size());
+    synth.apply(chans.data(), chans.size(), xhat.data() + b * len, len);
+  }
+
+  double sig = 0.0, noise = 0.0;
+  for(unsigned int i = delay; i < xhat.size(); i++) {
+    sig += std::norm(x[i - delay]);
+    noise += std::norm(xhat[i] - x[i - delay]);
+  }
+  double snr = 10.0 * log10(sig / noise);
+  if(snr < 40.0) {
+    std::cout << SoDa::Format("Reconstruction through %0 channels (delay %1) is only %2 dB clean\n")
+      .addI(M).addI(delay).addF(snr);
+    return false; 
+  }
+  return true; 
+}
+
+bool checkErrors() {
+  bool ok = true; 
+  try {
+    SoDa::ChannelSynthesizer synth(1.0e6, 15, SoDa::Channelizer::OVERSAMPLED_2X);
+    std::cout << "Odd channel count with 2x oversampling wasn't caught\n";
+    ok = false; 
+  }
+  catch (SoDa::ChannelSynthesizer::BadChannelCount & e) {
+  }
+  try {
+    SoDa::ChannelSynthesizer synth(1.0e6, 16);
+    std::vector<std::complex<float>> in(160), out(64);
+    synth.apply(in, out);
+    std::cout << "Bad buffer size wasn't caught\n";
+    ok = false; 
+  }
+  catch (SoDa::ChannelSynthesizer::BadBufferSize & e) {
+  }
+  return ok; 
+}
+
+int main() {
+  bool passed = true;
+
+  for(auto mode : { SoDa::Channelizer::CRITICAL, SoDa::Channelizer::OVERSAMPLED_2X }) {
+    passed = checkDefinition(mode) && passed;
+  }
+  passed = checkTone() && passed;
+  passed = checkReconstruction() && passed;
+  passed = checkErrors() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
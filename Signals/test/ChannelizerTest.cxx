@@ -0,0 +1,170 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/Channelizer.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <random>
+
+// Check the polyphase channelizer against the mix-filter-decimate
+// definition, and check that a tone lands in the right channel. 
+
+static const char * modeName(SoDa::Channelizer::Mode mode) {
+  return (mode == SoDa::Channelizer::CRITICAL) ? "critical" : "2x oversampled";
+}
+
+bool checkDefinition(SoDa::Channelizer::Mode mode) {
+  unsigned int M = 16;
+  SoDa::Channelizer chan(1.0e6, M, mode, 8);
+  std::vector<float> h;
+  chan.getPrototype(h);
+  unsigned int D = chan.getDecimation();
+  
+  std::mt19937 gen(31);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  // blocks of different lengths, to check that the history and
+  // the frame phase carry across calls. 
+  std::vector<unsigned int> frame_counts = { 5, 1, 17, 3 };
+  unsigned int total = 0;
+  for(auto f : frame_counts) total += f * D;
+  std::vector<std::complex<float>> x(total);
+  for(auto & v : x) v = std::complex<float>(dist(gen), dist(gen));
+
+  double err = 0.0;
+  unsigned int start = 0;
+  unsigned int frame = 0; 
+  for(auto frames : frame_counts) {
+    std::vector<std::complex<float>> in(x.begin() + start, x.begin() + start + frames * D);
+    std::vector<std::complex<float>> out(frames * M);
+    if(chan.apply(in, out) != frames) {
+      std::cout << modeName(mode) << " apply returned the wrong frame count\n";
+      return false; 
+    }
+    for(unsigned int f = 0; f < frames; f++, frame++) {
+      int n = (frame + 1) * D - 1;
+      for(unsigned int k = 0; k < M; k++) {
+	std::complex<double> ref(0.0, 0.0);
+	for(int l = 0; (l < h.size()) && (l <= n); l++) {
+	  ref += double(h[l]) * std::complex<double>(x[n - l]) 
+	    * std::polar(1.0, -2.0 * M_PI * double(k) * double(n - l) / double(M));
+	}
+	err = std::max(err, std::abs(std::complex<double>(out[k * frames + f]) - ref));
+      }
+    }
+    start += frames * D; 
+  }
+  if(err > 1e-5) {
+    std::cout << SoDa::Format("%0 channelizer differs from the definition by %1\n")
+      .addS(modeName(mode)).addF(err, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkTone(SoDa::Channelizer::Mode mode) {
+  unsigned int M = 32;
+  double fs = 3.2e6; 
+  auto chan = SoDa::Channelizer::make(fs, M, mode);
+  unsigned int frames = 64;
+  unsigned int D = chan->getDecimation();
+  std::vector<std::complex<float>> in(frames * D), out(frames * M);
+  // a tone a little off the center of channel 27 (which is -5 * spacing)
+  unsigned int tk = 27; 
+  double freq = chan->getChannelFrequency(tk) + 0.1 * fs / M;
+  bool ok = true; 
+  double ang = 0.0;
+  for(int b = 0; b < 4; b++) {
+    for(auto & v : in) {
+      v = std::polar(1.0, ang);
+      ang += 2.0 * M_PI * freq / fs; 
+    }
+    chan->apply(in, out);
+  }
+  // look at the last half of the last block, after things have settled
+  for(unsigned int k = 0; k < M; k++) {
+    double amp = 0.0;
+    for(unsigned int f = frames / 2; f < frames; f++) {
+      amp = std::max(amp, double(std::abs(out[k * frames + f])));
+    }
+    // the tone's own channel passes it at unity gain; the neighbors see the
+    // skirt of the prototype, and everything else should be quiet.
+    int dist = std::abs(int(k) - int(tk));
+    if(dist == 0) {
+      if(fabs(amp - 1.0) > 0.02) {
+	std::cout << SoDa::Format("%0: channel %1 amplitude %2, expected 1\n")
+	  .addS(modeName(mode)).addI(k).addF(amp);
+	ok = false; 
+      }
+    }
+    else if((dist > 1) && (amp > 1e-3)) {
+      std::cout << SoDa::Format("%0: channel %1 amplitude %2, expected 0\n")
+	.addS(modeName(mode)).addI(k).addF(amp, 'e');
+      ok = false; 
+    }
+  }
+  return ok; 
+}
+
+bool checkErrors() {
+  bool ok = true; 
+  try {
+    SoDa::Channelizer chan(1.0e6, 15, SoDa::Channelizer::OVERSAMPLED_2X);
+    std::cout << "Odd channel count with 2x oversampling wasn't caught\n";
+    ok = false; 
+  }
+  catch (SoDa::Channelizer::BadChannelCount & e) {
+  }
+  try {
+    SoDa::Channelizer chan(1.0e6, 16);
+    std::vector<std::complex<float>> in(100), out(96);
+    chan.apply(in, out);
+    std::cout << "Bad buffer size wasn't caught\n";
+    ok = false; 
+  }
+  catch (SoDa::Channelizer::BadBufferSize & e) {
+  }
+  return ok; 
+}
+
+int main() {
+  bool passed = true;
+
+  for(auto mode : { SoDa::Channelizer::CRITICAL, SoDa::Channelizer::OVERSAMPLED_2X }) {
+    passed = checkDefinition(mode) && passed;
+    passed = checkTone(mode) && passed;
+  }
+  passed = checkErrors() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
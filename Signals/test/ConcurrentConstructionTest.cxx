@@ -0,0 +1,134 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <thread>
+#include <atomic>
+
+// Build and run FFT, OSFilter, and ReSampler objects from lots of
+// threads at once, and check that each gets the same answer as
+// an object that was built and run all by itself.
+
+static const unsigned int num_threads = 8;
+static const unsigned int num_blocks = 3; 
+
+struct Result {
+  std::vector<std::complex<float>> fft_out; 
+  std::vector<std::complex<float>> osf_out;
+  std::vector<float> rs_out;
+};
+
+static void fillInput(std::vector<std::complex<float>> & v, int start) {
+  for(int i = 0; i < v.size(); i++) {
+    int j = i + start; 
+    v[i] = std::complex<float>(cos(0.031 * j), sin(0.0077 * j) + 0.5 * cos(1.1 * j));
+  }
+}
+
+// each thread gets one of a few sizes, so several threads
+// ask for the same plans at the same time. 
+static void runOne(unsigned int idx, Result & res) {
+  unsigned int fft_len = 1000 + 24 * (idx % 3);
+  SoDa::FFT fft(fft_len);
+  SoDa::OSFilter osf(-2000.0 - 100.0 * (idx % 2), 2000.0, 200.0, 48000.0, 1200);
+  SoDa::ReSampler rs(48000.0, 8000.0, 0.03);
+
+  std::vector<std::complex<float>> fin(fft_len);
+  res.fft_out.resize(fft_len);
+  fillInput(fin, idx);
+  fft.fft(fin, res.fft_out);
+
+  std::vector<std::complex<float>> oin(1200), oout(1200);
+  std::vector<float> rin(rs.getInputBufferSize()), rout(rs.getOutputBufferSize());
+  std::vector<std::complex<float>> rtmp(rin.size());
+  for(int b = 0; b < num_blocks; b++) {
+    fillInput(oin, b * 1200 + idx);
+    osf.apply(oin, oout);
+    res.osf_out.insert(res.osf_out.end(), oout.begin(), oout.end());
+
+    fillInput(rtmp, b * rin.size() + idx);
+    for(int i = 0; i < rin.size(); i++) rin[i] = rtmp[i].real();
+    rs.apply(rin, rout);
+    res.rs_out.insert(res.rs_out.end(), rout.begin(), rout.end());
+  }
+}
+
+template<typename T>
+static bool same(const std::vector<T> & a, const std::vector<T> & b) {
+  if(a.size() != b.size()) return false;
+  for(int i = 0; i < a.size(); i++) {
+    if(std::abs(a[i] - b[i]) > 1e-5) return false; 
+  }
+  return true; 
+}
+
+int main() {
+  // first, the reference answers, one at a time. 
+  std::vector<Result> ref(num_threads);
+  for(int i = 0; i < num_threads; i++) {
+    runOne(i, ref[i]);
+  }
+
+  // now start from scratch so that the threads have to make their own plans. 
+  SoDa::FFT::clearPlanCache();
+
+  std::vector<Result> res(num_threads);
+  std::vector<std::thread> threads;
+  std::atomic<bool> go(false);
+  for(int i = 0; i < num_threads; i++) {
+    threads.push_back(std::thread([i, &res, &go]() {
+	  while(!go) std::this_thread::yield();
+	  runOne(i, res[i]); 
+	}));
+  }
+  go = true; 
+  for(auto & t : threads) t.join();
+
+  bool passed = true; 
+  for(int i = 0; i < num_threads; i++) {
+    bool ok = same(ref[i].fft_out, res[i].fft_out) && 
+      same(ref[i].osf_out, res[i].osf_out) && 
+      same(ref[i].rs_out, res[i].rs_out);
+    if(!ok) {
+      std::cout << SoDa::Format("Thread %0 got a different answer than the reference\n").addI(i);
+      passed = false; 
+    }
+  }
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,279 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include "../include/Filter.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include "../include/Periodogram.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check the double precision paths against the float paths, and
+// make sure the double transforms really are more accurate. 
+
+template<typename T>
+static void fillComplex(std::vector<std::complex<T>> & v, int start) {
+  for(int i = 0; i < v.size(); i++) {
+    int j = i + start; 
+    v[i] = std::complex<T>(cos(0.031 * j) + 0.25 * cos(2.1 * j), 
+			   sin(0.031 * j) + 0.5 * sin(0.77 * j));
+  }
+}
+
+template<typename T>
+static void fillReal(std::vector<T> & v, int start) {
+  for(int i = 0; i < v.size(); i++) {
+    int j = i + start; 
+    v[i] = cos(0.031 * j) + 0.5 * sin(0.77 * j) + 0.25 * cos(2.1 * j);
+  }
+}
+
+static bool report(const std::string & what, double err, double limit) {
+  if(err > limit) {
+    std::cout << SoDa::Format("%0: error %1 exceeds %2\n")
+      .addS(what).addF(err, 'e').addF(limit, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkTransform(unsigned int len) {
+  SoDa::FFT fft(len);
+
+  std::vector<std::complex<float>> xf(len), Xf(len), xrf(len);
+  std::vector<std::complex<double>> xd(len), Xd(len), xrd(len);
+
+  fillComplex(xf, 0);
+  fillComplex(xd, 0);
+
+  fft.fft(xf, Xf);
+  fft.fft(xd, Xd);
+  fft.ifft(Xf, xrf);
+  fft.ifft(Xd, xrd);
+
+  // the float and double transforms should agree to float precision
+  double diff = 0.0;
+  for(int i = 0; i < len; i++) {
+    diff = std::max(diff, std::abs(std::complex<double>(Xf[i]) - Xd[i]));
+  }
+
+  // and the double round trip should be a lot better than the float round trip.
+  double ferr = 0.0, derr = 0.0;
+  for(int i = 0; i < len; i++) {
+    ferr = std::max(ferr, std::abs(std::complex<double>(xrf[i]) / double(len)
+				   - std::complex<double>(xf[i])));
+    derr = std::max(derr, std::abs(xrd[i] / double(len) - xd[i]));
+  }
+
+  std::string lstr = SoDa::Format("length %0").addI(len).str();
+  bool ok = report("float vs double fft " + lstr, diff, 1e-3);
+  ok = report("double round trip " + lstr, derr, 1e-9) && ok;
+  ok = report("double round trip vs float round trip " + lstr, derr, 1e-3 * ferr) && ok;
+  return ok; 
+}
+
+bool checkRealTransform(unsigned int len) {
+  SoDa::FFT fft(len);
+  std::vector<double> x(len), xr(len);
+  std::vector<std::complex<double>> XH(fft.getHalfSpectrumSize());
+
+  fillReal(x, 0); 
+  fft.rfft(x, XH);
+  fft.irfft(XH, xr);
+
+  double err = 0.0;
+  for(int i = 0; i < len; i++) {
+    err = std::max(err, std::abs(xr[i] / double(len) - x[i]));
+  }
+  return report(SoDa::Format("double rfft/irfft length %0").addI(len).str(), err, 1e-9);
+}
+
+bool checkFilter() {
+  unsigned int len = 1000; 
+  SoDa::Filter filt(-2000.0, 2000.0, 200.0, 48000.0, 121, len);
+
+  std::vector<std::complex<float>> xf(len), yf(len);
+  std::vector<std::complex<double>> xd(len), yd(len);
+  std::vector<float> rf(len), ryf(len);
+  std::vector<double> rd(len), ryd(len);
+  fillComplex(xf, 0);
+  fillComplex(xd, 0);
+  fillReal(rf, 0);
+  fillReal(rd, 0); 
+
+  filt.apply(xf, yf);
+  filt.apply(xd, yd);
+  filt.apply(rf, ryf);
+  filt.apply(rd, ryd);
+
+  double err = 0.0, rerr = 0.0; 
+  for(int i = 0; i < len; i++) {
+    err = std::max(err, std::abs(std::complex<double>(yf[i]) - yd[i]));
+    rerr = std::max(rerr, std::abs(double(ryf[i]) - ryd[i]));
+  }
+  bool ok = report("Filter complex", err, 1e-4);
+  return report("Filter real", rerr, 1e-4) && ok;
+}
+
+bool checkOSFilter() {
+  unsigned int len = 1200; 
+  SoDa::OSFilter filt(-2000.0, 2000.0, 200.0, 48000.0, len);
+
+  std::vector<std::complex<float>> xf(len), yf(len);
+  std::vector<std::complex<double>> xd(len), yd(len);
+  std::vector<float> rf(len), ryf(len);
+  std::vector<double> rd(len), ryd(len);
+
+  double err = 0.0, rerr = 0.0; 
+  for(int b = 0; b < 5; b++) {
+    fillComplex(xf, b * len);
+    fillComplex(xd, b * len);
+    fillReal(rf, b * len);
+    fillReal(rd, b * len);
+    // each sample type keeps its own overlap state, so we
+    // can interleave them here. 
+    filt.apply(xf, yf);
+    filt.apply(xd, yd);
+    filt.apply(rf, ryf);
+    filt.apply(rd, ryd);
+    for(int i = 0; i < len; i++) {
+      err = std::max(err, std::abs(std::complex<double>(yf[i]) - yd[i]));
+      rerr = std::max(rerr, std::abs(double(ryf[i]) - ryd[i]));
+    }
+  }
+  bool ok = report("OSFilter complex", err, 1e-4);
+  return report("OSFilter real", rerr, 1e-4) && ok;
+}
+
+bool checkReSampler(float fs_in, float fs_out) {
+  SoDa::ReSampler rs(fs_in, fs_out, 0.05);
+
+  unsigned int in_len = rs.getInputBufferSize();
+  unsigned int out_len = rs.getOutputBufferSize();
+  std::vector<std::complex<float>> xf(in_len), yf(out_len);
+  std::vector<std::complex<double>> xd(in_len), yd(out_len);
+  std::vector<float> rf(in_len), ryf(out_len);
+  std::vector<double> rd(in_len), ryd(out_len);
+  
+  double err = 0.0, rerr = 0.0, maxval = 0.0; 
+  for(int b = 0; b < 4; b++) {
+    fillComplex(xf, b * in_len);
+    fillComplex(xd, b * in_len);
+    fillReal(rf, b * in_len);
+    fillReal(rd, b * in_len);
+    rs.apply(xf, yf);
+    rs.apply(xd, yd);
+    rs.apply(rf, ryf);
+    rs.apply(rd, ryd);
+    for(int i = 0; i < out_len; i++) {
+      err = std::max(err, std::abs(std::complex<double>(yf[i]) - yd[i]));
+      rerr = std::max(rerr, std::abs(double(ryf[i]) - ryd[i]));
+      maxval = std::max(maxval, std::abs(yd[i]));
+    }
+  }
+  std::string rstr = SoDa::Format("ReSampler %0 -> %1").addF(fs_in).addF(fs_out).str();
+  bool ok = report(rstr + " complex", err, 1e-3 * maxval);
+  return report(rstr + " real", rerr, 1e-3 * maxval) && ok;
+}
+
+bool checkPeriodogram() {
+  unsigned int seg = 1024;
+  SoDa::Periodogram pgram(seg);
+
+  // a strong tone and one 200 dB below it, both centered in a bin
+  // and as far apart as they can be, so the window's leakage doesn't
+  // reach from one to the other.  The float accumulator's floor is
+  // around -180 dB, so only the double path can see the weak tone. 
+  unsigned int strong_bin = 100, weak_bin = strong_bin + seg / 2;
+  double weak_amp = 1e-10;
+  unsigned int len = 16 * seg; 
+  std::vector<std::complex<float>> xf(len);
+  std::vector<std::complex<double>> xd(len);
+  for(int i = 0; i < len; i++) {
+    double sang = 2.0 * M_PI * double((strong_bin * i) % seg) / double(seg);
+    double wang = 2.0 * M_PI * double((weak_bin * i) % seg) / double(seg);
+    xd[i] = std::polar(1.0, sang) + std::polar(weak_amp, wang);
+    xf[i] = std::complex<float>(xd[i]);
+  }
+
+  // feed the samples in odd sized chunks to exercise the save buffer
+  for(int i = 0; i < len; i += 1000) {
+    unsigned int clen = std::min(1000u, len - i); 
+    pgram.accumulate(xf.data() + i, clen);
+    pgram.accumulate(xd.data() + i, clen);
+  }
+
+  std::vector<float> pf;
+  std::vector<double> pd;
+  pgram.get(pf);
+  pgram.get(pd);
+
+  // get shifts DC to the center
+  unsigned int sidx = (strong_bin + seg / 2) % seg;
+  unsigned int widx = (weak_bin + seg / 2) % seg;
+
+  // the two accumulators should agree on the strong tone
+  bool ok = report("Periodogram float vs. double", 
+		   std::abs(double(pf[sidx]) - pd[sidx]), 1e-5 * pd[sidx]);
+
+  // and the double accumulator should resolve the weak one. 
+  double ratio = pd[widx] / pd[sidx];
+  ok = report("Periodogram double weak tone", 
+	      std::abs(ratio - weak_amp), 1e-3 * weak_amp) && ok;
+
+  // each accumulator counts its own segments for the scale factor.
+  // Segments overlap by half, so 2 * seg samples make 3 segments. 
+  SoDa::Periodogram spgram(seg, 1.0);
+  spgram.accumulate(xf.data(), 2 * seg);
+  spgram.accumulate(xd.data(), seg);
+  ok = report("Periodogram float scale factor", 
+	      std::abs(spgram.getScaleFactor<float>() - 1.0 / 3.0), 1e-7) && ok;
+  return report("Periodogram double scale factor", 
+		std::abs(spgram.getScaleFactor<double>() - 1.0), 1e-15) && ok;
+}
+
+int main() {
+  bool passed = checkTransform(720);
+  passed = checkTransform(999) && passed;
+  passed = checkRealTransform(720) && passed;
+  passed = checkRealTransform(999) && passed;
+  passed = checkFilter() && passed;
+  passed = checkOSFilter() && passed;
+  passed = checkReSampler(48000.0, 8000.0) && passed;
+  passed = checkReSampler(8000.0, 48000.0) && passed;
+  passed = checkPeriodogram() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,112 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check that the batched transforms get the same answer as
+// transforming each channel on its own.
+
+bool checkBatch(unsigned int len, unsigned int num_channels, SoDa::FFT::BatchLayout layout) {
+  SoDa::FFT fft(len);
+
+  unsigned int total = len * num_channels; 
+  std::vector<std::complex<float>> in(total), out(total), back(total);
+  std::vector<std::complex<float>> chan_in(len), chan_out(len);
+
+  // where does sample i of channel c live? 
+  auto idx = [&](unsigned int c, unsigned int i) {
+    return (layout == SoDa::FFT::CHANNEL_MAJOR) ? (c * len + i) : (i * num_channels + c);
+  };
+  
+  for(int c = 0; c < num_channels; c++) {
+    for(int i = 0; i < len; i++) {
+      in[idx(c, i)] = std::complex<float>(cos(0.01 * (c + 1) * i), sin(0.07 * c * i + 0.3));
+    }
+  }
+
+  fft.fftBatch(in, out, num_channels, layout);
+
+  float maxerr = 0.0;
+  for(int c = 0; c < num_channels; c++) {
+    for(int i = 0; i < len; i++) {
+      chan_in[i] = in[idx(c, i)];
+    }
+    fft.fft(chan_in, chan_out);
+    for(int i = 0; i < len; i++) {
+      maxerr = std::max(maxerr, std::abs(chan_out[i] - out[idx(c, i)]));
+    }
+  }
+
+  // and back again
+  fft.ifftBatch(out, back, num_channels, layout);
+  for(int i = 0; i < total; i++) {
+    maxerr = std::max(maxerr, std::abs(back[i] / float(len) - in[i]));
+  }
+
+  if(maxerr > 1e-2) {
+    std::cout << SoDa::Format("Batch of %0 channels of length %1 (%2) differs from per-channel by %3\n")
+      .addI(num_channels).addI(len)
+      .addS((layout == SoDa::FFT::CHANNEL_MAJOR) ? "channel major" : "interleaved")
+      .addF(maxerr, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkBadSize() {
+  SoDa::FFT fft(100);
+  std::vector<std::complex<float>> in(250), out(250);
+  try {
+    fft.fftBatch(in, out, 3);
+  }
+  catch (SoDa::FFT::BadSize & e) {
+    return true; 
+  }
+  std::cout << "fftBatch accepted a buffer of the wrong size\n";
+  return false; 
+}
+
+int main() {
+  bool passed = true;
+  for(auto layout : { SoDa::FFT::CHANNEL_MAJOR, SoDa::FFT::INTERLEAVED }) {
+    passed = checkBatch(720, 8, layout) && passed;
+    passed = checkBatch(999, 3, layout) && passed;
+    passed = checkBatch(256, 1, layout) && passed;
+  }
+  passed = checkBadSize() && passed; 
+
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,159 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include "../include/Filter.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check that FFT objects of the same size share plans through the
+// process-wide plan cache, and that buffers that aren't SIMD aligned
+// get the same answer as buffers that are, as do threaded plans.
+
+// an allocator that hands out storage one element past an aligned boundary. 
+template<typename T>
+struct SkewedAllocator {
+  typedef T value_type;
+  SkewedAllocator() { }
+  template<typename U> SkewedAllocator(const SkewedAllocator<U> &) { }
+  T * allocate(std::size_t n) { return alloc.allocate(n + 1) + 1; }
+  void deallocate(T * p, std::size_t n) { alloc.deallocate(p - 1, n + 1); }
+  template<typename U> bool operator==(const SkewedAllocator<U> &) const { return true; }
+  template<typename U> bool operator!=(const SkewedAllocator<U> &) const { return false; }
+  SoDa::AlignedAllocator<T> alloc; 
+};
+
+bool checkSharing() {
+  SoDa::FFT::clearPlanCache();
+  
+  SoDa::FFT f0(1000);
+  auto base = SoDa::FFT::getPlanCacheSize();
+  if(base != 2) {
+    std::cout << SoDa::Format("Expected 2 plans after first FFT, got %0\n").addI(base);
+    return false; 
+  }
+  
+  auto f1 = SoDa::FFT::make(1000);
+  SoDa::FFT f2(1000, SoDa::FFT::ESTIMATE);
+  if(SoDa::FFT::getPlanCacheSize() != base) {
+    std::cout << SoDa::Format("Plan cache grew from %0 to %1 for same-size FFTs\n")
+      .addI(base).addI(SoDa::FFT::getPlanCacheSize());
+    return false; 
+  }
+
+  // a second filter with the same dimensions shouldn't need any new plans.
+  SoDa::Filter filt0(-1000.0, 1000.0, 100.0, 48000.0, 121, 1000);
+  auto after_filter = SoDa::FFT::getPlanCacheSize();
+  SoDa::Filter filt1(-1000.0, 1000.0, 100.0, 48000.0, 121, 1000);
+  if(SoDa::FFT::getPlanCacheSize() != after_filter) {
+    std::cout << SoDa::Format("Plan cache grew from %0 to %1 for identical filters\n")
+      .addI(after_filter).addI(SoDa::FFT::getPlanCacheSize());
+    return false; 
+  }
+
+  return true; 
+}
+
+bool checkAlignment() {
+  unsigned int len = 720; 
+  SoDa::FFT fft(len);
+  
+  SoDa::AlignedVector<std::complex<float>> in(len), out(len);
+  std::vector<std::complex<float>, SkewedAllocator<std::complex<float>>> skew_in(len), skew_out(len);
+
+  for(int i = 0; i < len; i++) {
+    in[i] = std::complex<float>(cos(0.1 * i), sin(0.37 * i));
+    skew_in[i] = in[i]; 
+  }
+
+  fft.fft(in, out);
+
+  // both skewed, aligned to skewed, skewed to aligned
+  SoDa::AlignedVector<std::complex<float>> out2(len);
+  fft.fft(skew_in, skew_out);
+  fft.fft(skew_in, out2);
+
+  float maxerr = 0.0; 
+  for(int i = 0; i < len; i++) {
+    maxerr = std::max(maxerr, std::abs(out[i] - skew_out[i]));
+    maxerr = std::max(maxerr, std::abs(out[i] - out2[i]));
+  }
+
+  fft.fft(in, skew_out);
+  for(int i = 0; i < len; i++) {
+    maxerr = std::max(maxerr, std::abs(out[i] - skew_out[i]));
+  }
+  
+  if(maxerr > 1e-3) {
+    std::cout << SoDa::Format("Aligned and unaligned transforms differ by %0\n").addF(maxerr, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkThreads() {
+  unsigned int len = 4096; 
+  SoDa::FFT f1(len, SoDa::FFT::ESTIMATE, 1);
+  SoDa::FFT f4(len, SoDa::FFT::ESTIMATE, 4);
+
+  if(f4.getThreads() != (SoDa::FFT::threadsAvailable() ? 4 : 1)) {
+    std::cout << SoDa::Format("Asked for 4 threads, got %0\n").addI(f4.getThreads());
+    return false; 
+  }
+  
+  SoDa::AlignedVector<std::complex<float>> in(len), out1(len), out4(len);
+  for(int i = 0; i < len; i++) {
+    in[i] = std::complex<float>(cos(0.2 * i), sin(0.013 * i));
+  }
+  f1.fft(in, out1);
+  f4.fft(in, out4);
+  
+  float maxerr = 0.0; 
+  for(int i = 0; i < len; i++) {
+    maxerr = std::max(maxerr, std::abs(out1[i] - out4[i]));
+  }
+  if(maxerr > 1e-3) {
+    std::cout << SoDa::Format("Threaded and single threaded transforms differ by %0\n").addF(maxerr, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+int main() {
+  bool passed = checkSharing();
+  passed = checkAlignment() && passed; 
+  passed = checkThreads() && passed; 
+
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,130 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check the in-place shift and ishift methods against the
+// modulo-indexed definition, and fftShifted against fft + shift.
+
+template<typename T>
+static void fill(std::vector<std::complex<T>> & v) {
+  for(int i = 0; i < v.size(); i++) {
+    v[i] = std::complex<T>(i, -i);
+  }
+}
+
+template<typename T>
+bool checkShift(unsigned int len) {
+  SoDa::FFT fft(len);
+  std::vector<std::complex<T>> in(len), out(len), inplace(len), ref(len);
+  fill(in);
+
+  bool ok = true; 
+  // shift: out[(mid + i) % len] = in[i] with mid = len / 2
+  for(int i = 0; i < len; i++) ref[(len / 2 + i) % len] = in[i];
+  fft.shift(in, out);
+  inplace = in; 
+  fft.shift(inplace, inplace);
+  if((out != ref) || (inplace != ref)) {
+    std::cout << SoDa::Format("shift failed for length %0\n").addI(len);
+    ok = false; 
+  }
+
+  // ishift: out[(mid + i) % len] = in[i] with mid = (len + 1) / 2
+  for(int i = 0; i < len; i++) ref[((len + 1) / 2 + i) % len] = in[i];
+  fft.ishift(in, out);
+  inplace = in; 
+  fft.ishift(inplace, inplace);
+  if((out != ref) || (inplace != ref)) {
+    std::cout << SoDa::Format("ishift failed for length %0\n").addI(len);
+    ok = false; 
+  }
+
+  // and ishift undoes shift
+  inplace = in;
+  fft.shift(inplace, inplace);
+  fft.ishift(inplace, inplace);
+  if(inplace != in) {
+    std::cout << SoDa::Format("ishift(shift(x)) != x for length %0\n").addI(len);
+    ok = false; 
+  }
+
+  return ok; 
+}
+
+template<typename T>
+bool checkFFTShifted(unsigned int len) {
+  SoDa::FFT fft(len);
+  std::vector<std::complex<T>> in(len), X(len), XS(len);
+  for(int i = 0; i < len; i++) {
+    in[i] = std::complex<T>(cos(0.1 * i), sin(0.37 * i));
+  }
+  fft.fft(in, X);
+  fft.shift(X, X);
+  fft.fftShifted(in, XS);
+  // and again, in place
+  fft.fftShifted(in, in);
+
+  // even lengths fold the shift into the transform, so the rounding
+  // isn't identical to fft + shift.  Compare relative to the peak. 
+  T err = 0.0, ierr = 0.0, maxval = 0.0; 
+  for(int i = 0; i < len; i++) {
+    err = std::max(err, std::abs(X[i] - XS[i]));
+    ierr = std::max(ierr, std::abs(X[i] - in[i]));
+    maxval = std::max(maxval, std::abs(X[i]));
+  }
+  T limit = (sizeof(T) == sizeof(float) ? 1e-6 : 1e-13) * std::max(maxval, T(1)); 
+  if((err > limit) || (ierr > limit)) {
+    std::cout << SoDa::Format("fftShifted and fft + shift differ by %0 (in place %1) for length %2\n")
+      .addF(err, 'e').addF(ierr, 'e').addI(len);
+    return false; 
+  }
+  return true; 
+}
+
+int main() {
+  bool passed = true; 
+  for(auto len : {1, 2, 7, 8, 720, 999}) {
+    passed = checkShift<float>(len) && passed;
+    passed = checkShift<double>(len) && passed;
+  }
+  for(auto len : {2, 7, 8, 720, 999}) {
+    passed = checkFFTShifted<float>(len) && passed;
+    passed = checkFFTShifted<double>(len) && passed;
+  }
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <unistd.h>
+#include <Utils/include/Format.hxx>
+
+// Check the measured size selection and the timing table file.
+
+static bool isSmooth(uint32_t v) {
+  for(auto f : {2, 3, 5, 7}) {
+    while((v % f) == 0) v = v / f;
+  }
+  return v == 1; 
+}
+
+bool checkFastest(uint32_t min_size) {
+  uint32_t sz = SoDa::FFT::findFastestSize(min_size);
+  uint32_t p2 = 1;
+  while(p2 < min_size) p2 *= 2; 
+  if((sz < min_size) || (sz > p2) || !isSmooth(sz)) {
+    std::cout << SoDa::Format("findFastestSize(%0) returned inadmissible size %1\n")
+      .addI(min_size).addI(sz);
+    return false; 
+  }
+  // nothing in the table should beat the chosen size
+  double best = SoDa::FFT::getTransformCost(sz);
+  if(best > SoDa::FFT::getTransformCost(p2)) {
+    std::cout << SoDa::Format("findFastestSize(%0) chose %1 but %2 is faster\n")
+      .addI(min_size).addI(sz).addI(p2);
+    return false; 
+  }
+  return true; 
+}
+
+int main() {
+  bool passed = true; 
+  auto path = std::filesystem::temp_directory_path() / 
+    ("FFTSizeTest_" + std::to_string(getpid()));
+  std::filesystem::remove(path);
+
+  // by default we pick the smallest good size
+  if(SoDa::FFT::measuredSizesEnabled() || (SoDa::FFT::findGoodSize(1001) != 1008)) {
+    std::cout << "Measured sizes should be off by default\n";
+    passed = false; 
+  }
+
+  // there's no table yet. 
+  if(SoDa::FFT::enableMeasuredSizes(path.string())) {
+    std::cout << "enableMeasuredSizes claimed to load a table that isn't there\n";
+    passed = false; 
+  }
+
+  // timing the candidates shouldn't leave their plans behind
+  SoDa::FFT::clearPlanCache();
+  for(auto ms : {1001, 1500, 4000, 4097}) {
+    passed = checkFastest(ms) && passed; 
+  }
+  if(SoDa::FFT::getPlanCacheSize() != 0) {
+    std::cout << SoDa::Format("Measuring sizes left %0 plans in the plan cache\n")
+      .addI(SoDa::FFT::getPlanCacheSize());
+    passed = false; 
+  }
+
+  // findGoodSize should follow the measurements now. 
+  if(SoDa::FFT::findGoodSize(1500) != SoDa::FFT::findFastestSize(1500)) {
+    std::cout << "findGoodSize doesn't follow the measurements\n";
+    passed = false; 
+  }
+
+  // and so should the filters. 
+  SoDa::OSFilter osf(-2000.0, 2000.0, 200.0, 48000.0, 1000);
+  if(!isSmooth(osf.getInternalSize())) {
+    std::cout << SoDa::Format("OSFilter internal size %0 isn't a good size\n").addI(osf.getInternalSize());
+    passed = false; 
+  }
+  SoDa::ReSampler rs(48000.0, 8000.0, 0.05);
+  if(rs.getInputBufferSize() < 2400) {
+    std::cout << "ReSampler buffer is shorter than the requested time span\n";
+    passed = false; 
+  }
+
+  // the measurements should be in the table file
+  std::ifstream tf(path);
+  int entries = 0;
+  std::string line; 
+  while(std::getline(tf, line)) {
+    if((line.size() > 0) && (line[0] != '#')) entries++; 
+  }
+  if(entries == 0) {
+    std::cout << "The timing table wasn't written\n";
+    passed = false; 
+  }
+
+  // and we should be able to load it again. 
+  SoDa::FFT::disableMeasuredSizes();
+  if(!SoDa::FFT::enableMeasuredSizes(path.string())) {
+    std::cout << "Couldn't reload the timing table\n";
+    passed = false; 
+  }
+  SoDa::FFT::disableMeasuredSizes();
+  if(SoDa::FFT::findGoodSize(1001) != 1008) {
+    std::cout << "disableMeasuredSizes didn't restore the smallest good size\n";
+    passed = false; 
+  }
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(path.string() + ".lock");
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -35,6 +35,7 @@
 #include <chrono>
 #include <string>
 #include <cstring>
+#include <thread>
 #include "../include/FFT.hxx"
 
 std::random_device dev;
@@ -109,6 +110,87 @@ void doTest(int size, SoDa::FFT::FFTOpt opt_flag) {
   std::cout.flush();
 }
 
+// time a callable over enough iterations to take about a second. 
+// returns seconds per call. 
+template<typename F>
+double timeIt(F f) {
+  auto st_t1 = std::chrono::steady_clock::now();
+  for(int i = 0; i < 8; i++) f();
+  auto en_t1 = std::chrono::steady_clock::now();
+  double tdur = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(en_t1 - st_t1).count();
+  unsigned int iters = std::max(1u, (unsigned int) floor(8e9 / tdur));
+
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iters; i++) f();
+  auto end = std::chrono::steady_clock::now();
+  double dur = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return 1e-9 * dur / ((double) iters);
+}
+
+// compare a loop of per-channel transforms to the batched transforms
+void doBatchTest(int size, int num_channels, SoDa::FFT::FFTOpt opt_flag) {
+  int total = size * num_channels; 
+  std::vector<std::complex<float>> test_in(total);
+  std::vector<std::complex<float>> test_out(total);
+  std::vector<std::complex<float>> chan_in(size), chan_out(size);
+  
+  for(int i = 0; i < total; i++) {
+    test_in[i] = std::complex<float>(distr(rng), distr(rng));
+  }
+
+  SoDa::FFT fft(size, opt_flag);
+
+  // the per-channel loop has to pull each channel out of the
+  // block and put it back, just like an application would. 
+  double loop_time = timeIt([&]() {
+      for(int c = 0; c < num_channels; c++) {
+	auto base = test_in.begin() + c * size; 
+	std::copy(base, base + size, chan_in.begin());
+	fft.fft(chan_in, chan_out);
+	std::copy(chan_out.begin(), chan_out.end(), test_out.begin() + c * size);
+      }
+    });
+
+  double cm_time = timeIt([&]() {
+      fft.fftBatch(test_in, test_out, num_channels, SoDa::FFT::CHANNEL_MAJOR); 
+    });
+  
+  double il_time = timeIt([&]() {
+      fft.fftBatch(test_in, test_out, num_channels, SoDa::FFT::INTERLEAVED); 
+    });
+
+  std::cout << SoDa::Format("%0 %1 %2 %3 %4 %5\n")
+    .addI(size)
+    .addI(num_channels)
+    .addF(loop_time, 'e', 4, 4)
+    .addF(cm_time, 'e', 4, 4)
+    .addF(il_time, 'e', 4, 4)
+    .addF(loop_time / cm_time, 'f', 6, 2);
+  std::cout.flush();
+}
+
+// how does a transform scale with the number of threads?
+void doThreadTest(int size, SoDa::FFT::FFTOpt opt_flag) {
+  std::vector<std::complex<float>> test_in(size);
+  std::vector<std::complex<float>> test_out(size);
+  for(int i = 0; i < size; i++) {
+    test_in[i] = std::complex<float>(distr(rng), distr(rng));
+  }
+
+  unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  double one_thread_time = 0.0; 
+  for(unsigned int nt = 1; nt <= max_threads; nt = nt * 2) {
+    SoDa::FFT fft(size, opt_flag, nt);
+    double t = timeIt([&]() { fft.fft(test_in, test_out); });
+    if(nt == 1) one_thread_time = t; 
+    std::cout << SoDa::Format("%0 %1 %2 %3\n")
+      .addI(size)
+      .addI(nt)
+      .addF(t, 'e', 4, 4)
+      .addF(one_thread_time / t, 'f', 6, 2);
+    std::cout.flush();
+  }
+}
 
 int main(int argc, char * argv[])
 {
@@ -134,6 +216,50 @@ int main(int argc, char * argv[])
       break; 
     }
   }
+  if((argc >= 3) && (argv[2][0] == 'T')) {
+    // thread mode: scaling by size and thread count
+    if(!SoDa::FFT::threadsAvailable()) {
+      std::cout << "# SoDa::FFT was built without the threaded FFTW library -- all runs are single threaded\n";
+    }
+    std::cout << "# size threads time speedup\n";
+    for(int p2 = (1 << 12); p2 <= (1 << 22); p2 = p2 * 4) {
+      doThreadTest(p2, opt_flag);
+      doThreadTest(p2 * 3 * 5 / 4, opt_flag);
+    }
+    return 0; 
+  }
+
+  if((argc >= 3) && (argv[2][0] == 'S')) {
+    // size mode: the smallest good size vs. the measured fastest size.
+    std::cout << "# min_size smallest_size smallest_time fastest_size fastest_time speedup\n";
+    for(int min_size : { 1000, 1500, 2100, 3000, 4500, 5000, 9000, 13000, 20000, 40000, 70000 }) {
+      auto small = SoDa::FFT::findGoodSize(min_size);
+      auto fast = SoDa::FFT::findFastestSize(min_size);
+      double small_time = 1e-9 * SoDa::FFT::getTransformCost(small);
+      double fast_time = 1e-9 * SoDa::FFT::getTransformCost(fast);
+      std::cout << SoDa::Format("%0 %1 %2 %3 %4 %5\n")
+	.addI(min_size)
+	.addI(small)
+	.addF(small_time, 'e', 4, 4)
+	.addI(fast)
+	.addF(fast_time, 'e', 4, 4)
+	.addF(small_time / fast_time, 'f', 6, 2);
+      std::cout.flush();
+    }
+    return 0; 
+  }
+
+  if((argc >= 3) && (argv[2][0] == 'B')) {
+    // batch mode: per-channel loop vs. batched transforms
+    std::cout << "# size channels loop_time channel_major_time interleaved_time speedup\n";
+    for(int size : { 256, 1024, 1000, 4096, 4800, 16384 }) {
+      for(int num_channels : { 8, 16, 32, 64 }) {
+	doBatchTest(size, num_channels, opt_flag);
+      }
+    }
+    return 0; 
+  }
+  
   // do powers of 2 from 8 to 18
   // and powers of 3 from 0 to 3
   // and powers of 5 from 0 to 3
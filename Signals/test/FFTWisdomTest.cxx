@@ -0,0 +1,134 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+#include <Utils/include/Format.hxx>
+
+// Save and restore FFTW wisdom, and make sure that garbage in a
+// wisdom file doesn't keep us from planning. 
+
+int main() {
+  bool passed = true;
+
+  std::string base = SoDa::Format("/tmp/SoDaFFTWisdomTest_%0").addI(getpid()).str();
+  std::string good_path = base + "/wisdom";
+  std::string bad_path = base + "_bad";
+
+  // learn something, then save it. 
+  SoDa::FFT f0(1536, SoDa::FFT::MEASURE);
+  if(!SoDa::FFT::saveWisdom(good_path)) {
+    std::cout << "Could not save wisdom to " << good_path << "\n";
+    passed = false; 
+  }
+
+  if(!SoDa::FFT::loadWisdom(good_path)) {
+    std::cout << "Could not reload wisdom from " << good_path << "\n";
+    passed = false; 
+  }
+
+  // now a file that isn't wisdom at all. 
+  {
+    std::ofstream bf(bad_path);
+    bf << "this is not wisdom\n";
+  }
+  if(SoDa::FFT::loadWisdom(bad_path)) {
+    std::cout << "Accepted a garbage wisdom file\n";
+    passed = false; 
+  }
+  if(SoDa::FFT::loadWisdom(base + "/does_not_exist")) {
+    std::cout << "Accepted a missing wisdom file\n";
+    passed = false; 
+  }
+
+  // the automatic cache should pick up new plans. 
+  std::string cache_path = base + "/cache";
+  SoDa::FFT::enableWisdomCache(cache_path);
+  SoDa::FFT f1(2000, SoDa::FFT::MEASURE);
+  SoDa::FFT::disableWisdomCache();
+  if(!SoDa::FFT::loadWisdom(cache_path)) {
+    std::cout << "Wisdom cache was not written to " << cache_path << "\n";
+    passed = false; 
+  }
+
+  // A plan that comes straight from wisdom we already have teaches
+  // us nothing, so it shouldn't rewrite the cache. 
+  SoDa::FFT::enableWisdomCache(cache_path);
+  std::remove(cache_path.c_str());
+  SoDa::FFT::clearPlanCache();
+  {
+    SoDa::FFT f2(2000, SoDa::FFT::MEASURE);
+  }
+  if(access(cache_path.c_str(), F_OK) == 0) {
+    std::cout << "A plan made from wisdom rewrote the wisdom cache\n";
+    passed = false; 
+  }
+  // but a new plan should.
+  {
+    SoDa::FFT f3(2400, SoDa::FFT::MEASURE);
+  }
+  if(access(cache_path.c_str(), F_OK) != 0) {
+    std::cout << "A new plan didn't write the wisdom cache\n";
+    passed = false; 
+  }
+  SoDa::FFT::disableWisdomCache();
+  
+  // and we can still plan after all that. 
+  std::vector<std::complex<float>> in(2000), out(2000);
+  in[1] = std::complex<float>(1.0, 0.0);
+  f1.fft(in, out);
+  if(std::abs(std::abs(out[100]) - 1.0) > 1e-4) {
+    std::cout << "FFT gave the wrong answer after loading wisdom\n";
+    passed = false; 
+  }
+  
+  // each wisdom file has a double precision partner, and each of
+  // those has a lock file.  The directory has to be empty before
+  // it will go away. 
+  for(auto & path : {good_path, cache_path}) {
+    for(auto & suffix : {"", ".lock", ".double", ".double.lock"}) {
+      std::remove((path + suffix).c_str());
+    }
+  }
+  std::remove(base.c_str());
+  std::remove(bad_path.c_str());
+  if(access(base.c_str(), F_OK) == 0) {
+    std::cout << "Left the wisdom directory " << base << " behind\n";
+    passed = false; 
+  }
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
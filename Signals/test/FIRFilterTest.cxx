@@ -0,0 +1,216 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FIRFilter.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/StreamFilter.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <random>
+
+// Check the direct form FIR filter against a plain convolution with
+// its own taps, check that its passband and stopband are where the
+// spec says they are, and check that StreamFilter::make picks
+// the direct form for tiny filters.
+
+static SoDa::FilterSpec makeSpec(unsigned int taps) {
+  SoDa::FilterSpec spec(48000.0, taps);
+  spec.add(-24000.0, 0.0).add(-8000.0, 0.0).add(-4000.0, 1.0)
+    .add(4000.0, 1.0).add(8000.0, 0.0).add(24000.0, 0.0);
+  return spec; 
+}
+
+// y[n] = sum_k h[k] x[n - k], with x[n] = 0 for n < 0
+template<typename T>
+static std::complex<double> convolve(const std::vector<std::complex<float>> & h, 
+				     const std::vector<T> & x, 
+				     int n, bool real_taps) {
+  std::complex<double> acc(0.0, 0.0);
+  for(int k = 0; (k < h.size()) && (k <= n); k++) {
+    std::complex<double> hk = h[k];
+    if(real_taps) hk = hk.real();
+    acc += hk * std::complex<double>(x[n - k]);
+  }
+  return acc; 
+}
+
+template<typename T>
+bool checkConvolution(const std::string & name, bool real_taps, double tol) {
+  unsigned int bsize = 256;
+  auto spec = makeSpec(31);
+  SoDa::FIRFilter fir(spec, bsize);
+  std::vector<std::complex<float>> h;
+  fir.getImpulseResponse(h);
+  if(h.size() != 31) {
+    std::cout << SoDa::Format("%0: expected 31 taps, got %1\n").addS(name).addI(h.size());
+    return false; 
+  }
+  
+  std::mt19937 gen(99);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  unsigned int blocks = 5; 
+  std::vector<T> x(bsize * blocks);
+  for(auto & v : x) {
+    if constexpr (std::is_floating_point<T>::value) v = dist(gen);
+    else v = T(dist(gen), dist(gen));
+  }
+
+  double err = 0.0; 
+  std::vector<T> in(bsize), out(bsize);
+  for(int b = 0; b < blocks; b++) {
+    for(int i = 0; i < bsize; i++) in[i] = x[b * bsize + i];
+    // the odd blocks go through the pointer interface, in place
+    if(b & 1) {
+      out = in; 
+      fir.apply(out.data(), out.data(), bsize);
+    }
+    else {
+      fir.apply(in, out);
+    }
+    for(int i = 0; i < bsize; i++) {
+      auto ref = convolve(h, x, b * bsize + i, real_taps);
+      err = std::max(err, std::abs(std::complex<double>(out[i]) - ref));
+    }
+  }
+  if(err > tol) {
+    std::cout << SoDa::Format("%0: FIR output differs from convolution by %1\n")
+      .addS(name).addF(err, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+// amplitude of the output, after the filter has settled, for a unit tone at freq
+static double toneGain(SoDa::StreamFilter & filt, double freq, unsigned int bsize, float gain = 1.0) {
+  std::vector<std::complex<float>> in(bsize), out(bsize);
+  double ang = 0.0;
+  double dang = 2.0 * M_PI * freq / 48000.0; 
+  double amp = 0.0; 
+  for(int b = 0; b < 4; b++) {
+    for(auto & v : in) {
+      v = std::polar(1.0f, float(ang));
+      ang += dang; 
+    }
+    filt.apply(in, out, gain);
+  }
+  for(auto & v : out) amp = std::max(amp, double(std::abs(v)));
+  return amp; 
+}
+
+bool checkResponse() {
+  bool ok = true; 
+  unsigned int bsize = 512;
+  auto spec = makeSpec(63);
+  SoDa::FIRFilter fir(spec, bsize);
+  SoDa::OSFilter osf(spec, bsize);
+
+  // The direct and overlap-and-save filters should agree (more or less --
+  // they don't have the same number of taps) on the pass and stop bands.
+  for(auto f : { -2000.0, 0.0, 1000.0, 3000.0 }) {
+    double fg = toneGain(fir, f, bsize);
+    double og = toneGain(osf, f, bsize);
+    if((fabs(fg - 1.0) > 0.05) || (fabs(og - 1.0) > 0.05)) {
+      std::cout << SoDa::Format("Passband gain at %0 Hz: FIR %1  OSFilter %2\n")
+	.addF(f).addF(fg).addF(og);
+      ok = false; 
+    }
+  }
+  for(auto f : { -16000.0, 12000.0, 20000.0 }) {
+    double fg = toneGain(fir, f, bsize);
+    if(fg > 0.01) {
+      std::cout << SoDa::Format("Stopband gain at %0 Hz: FIR %1\n").addF(f).addF(fg);
+      ok = false; 
+    }
+  }
+  double g2 = toneGain(fir, 1000.0, bsize, 2.0);
+  if(fabs(g2 - 2.0) > 0.1) {
+    std::cout << SoDa::Format("Gain argument ignored: got %0, expected 2\n").addF(g2);
+    ok = false; 
+  }
+  return ok; 
+}
+
+bool checkBadBuffer() {
+  auto spec = makeSpec(15);
+  SoDa::FIRFilter fir(spec, 128);
+  std::vector<float> in(127), out(127);
+  try {
+    fir.apply(in, out);
+  }
+  catch (SoDa::FIRFilter::BadBufferSize & e) {
+    return true; 
+  }
+  std::cout << "Bad buffer size wasn't caught\n";
+  return false; 
+}
+
+bool checkFactory() {
+  bool ok = true;
+  // three taps on a big buffer is never worth an FFT
+  auto small = makeSpec(3);
+  auto sf = SoDa::StreamFilter::make(small, 4096);
+  if(dynamic_cast<SoDa::FIRFilter*>(sf.get()) == nullptr) {
+    std::cout << SoDa::Format("3 taps, 4096 buffer: got an OSFilter (tap cost %0 ns)\n")
+      .addF(SoDa::FIRFilter::getTapCost(), 'e');
+    ok = false; 
+  }
+  // For long filters the answer depends on how fast the FFT library
+  // is, so just check that make follows directIsFaster.
+  auto big = makeSpec(2001);
+  bool direct = SoDa::FIRFilter::directIsFaster(2001, 16384);
+  auto bf = SoDa::StreamFilter::make(big, 16384);
+  if((dynamic_cast<SoDa::FIRFilter*>(bf.get()) != nullptr) != direct) {
+    std::cout << "2001 taps, 16384 buffer: make and directIsFaster disagree\n";
+    ok = false; 
+  }
+  if(!SoDa::FIRFilter::directIsFaster(5, 1024)) {
+    std::cout << "directIsFaster thinks 5 taps is too many\n";
+    ok = false; 
+  }
+  return ok; 
+}
+
+int main() {
+  bool passed = true;
+
+  passed = checkConvolution<std::complex<float>>("complex float", false, 1e-5) && passed;
+  passed = checkConvolution<float>("real float", true, 1e-5) && passed;
+  passed = checkConvolution<std::complex<double>>("complex double", false, 1e-9) && passed;
+  passed = checkConvolution<double>("real double", true, 1e-9) && passed;
+  passed = checkResponse() && passed;
+  passed = checkBadBuffer() && passed;
+  passed = checkFactory() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,160 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/Filter.hxx"
+#include "../include/FilterSpec.hxx"
+#include "../include/OSFilter.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <thread>
+
+// Check that clones share their coefficients, that each clone has
+// its own scratch space, and that an OSFilter clone starts a fresh
+// stream.
+
+static void fillSignal(std::vector<std::complex<double>> & v, double f1, double f2) {
+  for(int i = 0; i < v.size(); i++) {
+    v[i] = std::complex<double>(cos(f1 * i), sin(f2 * i));
+  }
+}
+
+bool checkFilterClone() {
+  bool passed = true; 
+  unsigned int buffer_size = 4096; 
+  SoDa::FilterSpec spec(48000.0, 127, SoDa::FilterSpec::COMPLEX);
+  spec.add(-6000.0, 0.0).add(-5000.0, 1.0).add(3000.0, 1.0).add(4000.0, 0.0);
+
+  SoDa::Filter orig(spec, buffer_size, 1.0, SoDa::Filter::HANN);
+  auto cl = orig.clone();
+  SoDa::Filter other(spec, buffer_size, 1.0, SoDa::Filter::HAMMING);
+
+  if(!orig.sharesDesign(*cl) || !cl->sharesDesign(orig)) {
+    std::cout << "Clone doesn't share its coefficients\n";
+    passed = false; 
+  }
+  if(orig.sharesDesign(other)) {
+    std::cout << "Different designs share coefficients\n";
+    passed = false; 
+  }
+
+  std::vector<std::complex<float>> ho, hc;
+  orig.getImpulseResponse(ho);
+  cl->getImpulseResponse(hc);
+  if(ho != hc) {
+    std::cout << "Clone has a different impulse response\n";
+    passed = false; 
+  }
+
+  // run two different signals through each, interleaved, in double
+  // precision (which builds the shared double image.)  If the
+  // scratch space were shared, the results would be mixed up.
+  std::vector<std::complex<double>> a(buffer_size), b(buffer_size);
+  fillSignal(a, 0.1, 0.3);
+  fillSignal(b, 0.7, 0.2);
+  std::vector<std::complex<double>> oa(buffer_size), ob(buffer_size), ca(buffer_size), cb(buffer_size);
+  orig.apply(a, oa);
+  cl->apply(b, cb);
+  orig.apply(b, ob);
+  cl->apply(a, ca);
+  if((oa != ca) || (ob != cb)) {
+    std::cout << "Clone and original give different results\n";
+    passed = false; 
+  }
+
+  // clones in separate threads
+  std::vector<std::shared_ptr<SoDa::Filter>> bank;
+  for(int i = 0; i < 4; i++) bank.push_back(orig.clone());
+  std::vector<std::vector<std::complex<double>>> outs(bank.size());
+  std::vector<std::thread> threads;
+  for(int i = 0; i < bank.size(); i++) {
+    threads.push_back(std::thread([&, i]() {
+	  outs[i].resize(buffer_size);
+	  std::vector<std::complex<double>> in(i & 1 ? b : a);
+	  for(int j = 0; j < 20; j++) {
+	    bank[i]->apply(in, outs[i]);
+	  }
+	}));
+  }
+  for(auto & t : threads) t.join();
+  for(int i = 0; i < bank.size(); i++) {
+    if(outs[i] != ((i & 1) ? ob : oa)) {
+      std::cout << SoDa::Format("Clone %0 in its own thread gave the wrong answer\n").addI(i);
+      passed = false; 
+    }
+  }
+  
+  return passed; 
+}
+
+bool checkOSFilterClone() {
+  bool passed = true; 
+  unsigned int buffer_size = 1000;
+  auto orig = SoDa::OSFilter::make(-4000.0, 4000.0, 1000.0, 48000.0, buffer_size, 60.0);
+  auto fresh = SoDa::OSFilter::make(-4000.0, 4000.0, 1000.0, 48000.0, buffer_size, 60.0);
+
+  std::vector<std::complex<float>> in(buffer_size), out_o(buffer_size), out_c(buffer_size), out_f(buffer_size);
+  // give the original some history
+  for(int i = 0; i < buffer_size; i++) in[i] = std::complex<float>(cos(0.05 * i), sin(0.05 * i));
+  orig->apply(in, out_o);
+
+  auto cl = orig->clone();
+  if(cl->getTaps() != orig->getTaps()) {
+    std::cout << SoDa::Format("OSFilter clone has %0 taps, original has %1\n")
+      .addI(cl->getTaps()).addI(orig->getTaps());
+    passed = false; 
+  }
+
+  // the clone should act like a brand new filter. 
+  for(int blk = 0; blk < 3; blk++) {
+    for(int i = 0; i < buffer_size; i++) {
+      in[i] = std::complex<float>(cos(0.3 * (i + blk * buffer_size)), 0.0);
+    }
+    cl->apply(in, out_c);
+    fresh->apply(in, out_f);
+    if(out_c != out_f) {
+      std::cout << SoDa::Format("OSFilter clone doesn't match a new filter in block %0\n").addI(blk);
+      passed = false; 
+    }
+  }
+  
+  return passed; 
+}
+
+int main() {
+  bool passed = checkFilterClone();
+  passed = checkOSFilterClone() && passed;
+
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+  return 0; 
+}
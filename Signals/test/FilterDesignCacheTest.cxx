@@ -0,0 +1,278 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/Filter.hxx"
+#include "../include/FilterSpec.hxx"
+#include "../include/ReSampler.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
+
+// Check that filters built from the same recipe come from the
+// design cache, that different recipes don't, and that design files
+// are used only when they match.
+
+static bool sameFilter(SoDa::Filter & a, SoDa::Filter & b) {
+  std::vector<std::complex<float>> ha, hb;
+  a.getImpulseResponse(ha);
+  b.getImpulseResponse(hb);
+  if(ha != hb) return false;
+
+  // and the images should match
+  std::vector<std::complex<float>> in(4096), outa(4096), outb(4096);
+  for(int i = 0; i < in.size(); i++) in[i] = std::complex<float>(cos(0.1 * i), sin(0.37 * i));
+  a.apply(in, outa, SoDa::Filter::InOutMode(true, true));
+  b.apply(in, outb, SoDa::Filter::InOutMode(true, true));
+  return outa == outb; 
+}
+
+bool checkCache() {
+  bool ok = true; 
+  SoDa::Filter::clearDesignCache();
+  if(SoDa::Filter::getDesignCacheSize() != 0) {
+    std::cout << "Design cache isn't empty after clearDesignCache\n";
+    ok = false; 
+  }
+
+  SoDa::FilterSpec spec(48000.0, -3000.0, 3000.0, 500.0);
+  spec.setTaps(201);
+  SoDa::Filter f0(spec, 4096, 1.0, SoDa::Filter::BLACKMAN);
+  SoDa::Filter f1(spec, 4096, 1.0, SoDa::Filter::BLACKMAN);
+  if(SoDa::Filter::getDesignCacheSize() != 1) {
+    std::cout << SoDa::Format("Two identical filters left %0 designs in the cache\n")
+      .addI(SoDa::Filter::getDesignCacheSize());
+    ok = false; 
+  }
+  if(!sameFilter(f0, f1)) {
+    std::cout << "The filter from the cache doesn't match the original\n";
+    ok = false; 
+  }
+  if(!f0.sharesDesign(f1)) {
+    std::cout << "The filter from the cache doesn't share the original's coefficients\n";
+    ok = false; 
+  }
+
+  // anything different is a different design
+  SoDa::Filter g(spec, 4096, 2.0, SoDa::Filter::BLACKMAN);
+  SoDa::Filter w(spec, 4096, 1.0, SoDa::Filter::HANN);
+  SoDa::Filter b(spec, 8192, 1.0, SoDa::Filter::BLACKMAN);
+  spec.setTaps(203);
+  SoDa::Filter t(spec, 4096, 1.0, SoDa::Filter::BLACKMAN);
+  SoDa::FilterSpec spec2(48000.0, -3000.0, 3100.0, 500.0);
+  spec2.setTaps(201);
+  SoDa::Filter c(spec2, 4096, 1.0, SoDa::Filter::BLACKMAN);
+  if(SoDa::Filter::getDesignCacheSize() != 6) {
+    std::cout << SoDa::Format("Expected 6 designs in the cache, found %0\n")
+      .addI(SoDa::Filter::getDesignCacheSize());
+    ok = false; 
+  }
+
+  // ReSamplers share their filters too. 
+  SoDa::ReSampler rs0(48000.0, 8000.0, 0.05);
+  auto with_one = SoDa::Filter::getDesignCacheSize();
+  SoDa::ReSampler rs1(48000.0, 8000.0, 0.05);
+  if(SoDa::Filter::getDesignCacheSize() != with_one) {
+    std::cout << "A second ReSampler added a design to the cache\n";
+    ok = false; 
+  }
+
+  // An equiripple design is slow. A cached one isn't. 
+  SoDa::FilterSpec espec(48000.0, -3000.0, 3000.0, 400.0, SoDa::FilterSpec::COMPLEX, 70.0);
+  espec.setTaps(401);
+  auto start = std::chrono::steady_clock::now();
+  SoDa::Filter e0(espec, 4096, 1.0, SoDa::Filter::EQUIRIPPLE);
+  auto mid = std::chrono::steady_clock::now();
+  SoDa::Filter e1(espec, 4096, 1.0, SoDa::Filter::EQUIRIPPLE);
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> design_time = mid - start;
+  std::chrono::duration<double, std::milli> cached_time = end - mid;
+  if(!sameFilter(e0, e1) || (cached_time.count() > 0.5 * design_time.count())) {
+    std::cout << SoDa::Format("Equiripple design took %0 ms, the cached copy took %1 ms\n")
+      .addF(design_time.count()).addF(cached_time.count());
+    ok = false; 
+  }
+
+  SoDa::Filter::clearDesignCache();
+  if(SoDa::Filter::getDesignCacheSize() != 0) {
+    std::cout << "Design cache isn't empty after clearDesignCache\n";
+    ok = false; 
+  }
+  return ok; 
+}
+
+// The cache should throw out the least recently used design, not
+// the oldest one. 
+bool checkEviction() {
+  SoDa::Filter::clearDesignCache();
+  SoDa::FilterSpec spec(48000.0, -3000.0, 3000.0, 2000.0);
+  spec.setTaps(31);
+  
+  // fill the cache, with "hot" as the oldest entry
+  SoDa::Filter hot(spec, 256, 1.0, SoDa::Filter::HANN);
+  for(int i = 1; i < SoDa::Filter::DESIGN_CACHE_LIMIT; i++) {
+    SoDa::Filter cold(spec, 256, 1.0 + i, SoDa::Filter::HANN);
+  }
+  // use hot again, then push one more design in
+  SoDa::Filter hot_again(spec, 256, 1.0, SoDa::Filter::HANN);
+  SoDa::Filter extra(spec, 256, 1000.0, SoDa::Filter::HANN);
+
+  SoDa::Filter hot_later(spec, 256, 1.0, SoDa::Filter::HANN);
+  bool ok = hot_later.sharesDesign(hot) 
+    && (SoDa::Filter::getDesignCacheSize() == SoDa::Filter::DESIGN_CACHE_LIMIT);
+  if(!ok) {
+    std::cout << "The design cache evicted a recently used design\n";
+  }
+  SoDa::Filter::clearDesignCache();
+  return ok; 
+}
+
+// poke a value into a design file
+template<typename T>
+static void poke(const std::string & path, long offset, T val) {
+  FILE * f = fopen(path.c_str(), "r+b");
+  fseek(f, offset, SEEK_SET);
+  fwrite(&val, sizeof(T), 1, f);
+  fclose(f);
+}
+
+template<typename T>
+static T peek(const std::string & path, long offset) {
+  T ret; 
+  FILE * f = fopen(path.c_str(), "rb");
+  fseek(f, offset, SEEK_SET);
+  if(fread(&ret, sizeof(T), 1, f) != 1) ret = T(0); 
+  fclose(f);
+  return ret; 
+}
+
+bool checkFiles() {
+  bool ok = true; 
+  auto dir = std::filesystem::temp_directory_path() / 
+    ("FilterDesignCacheTest_" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+
+  if(!SoDa::Filter::enableDesignFiles(dir.string())) {
+    std::cout << "Couldn't create the design directory\n";
+    return false; 
+  }
+  SoDa::Filter::clearDesignCache();
+  
+  SoDa::FilterSpec spec(48000.0, -3000.0, 3000.0, 500.0);
+  spec.setTaps(201);
+  SoDa::Filter f0(spec, 4096, 1.0, SoDa::Filter::HANN);
+  std::vector<std::complex<float>> h0;
+  f0.getImpulseResponse(h0);
+
+  std::vector<std::string> files; 
+  for(auto & e : std::filesystem::directory_iterator(dir)) files.push_back(e.path().string());
+  if(files.size() != 1) {
+    std::cout << SoDa::Format("Expected one design file, found %0\n").addI(files.size());
+    std::filesystem::remove_all(dir);
+    return false; 
+  }
+  auto path = files[0];
+
+  // Find the first tap: after the 16 byte magic, version, byte order
+  // mark, hash, recipe length, recipe, tap count, image size, and scale
+  uint32_t key_len = peek<uint32_t>(path, 32);
+  long tap0 = 36 + key_len + 16; 
+
+  // Change the first tap in the file. If the next filter comes from
+  // the file, it will have the new tap.
+  poke(path, tap0, std::complex<float>(42.0, 0.0));
+  SoDa::Filter::clearDesignCache();
+  SoDa::Filter f1(spec, 4096, 1.0, SoDa::Filter::HANN);
+  std::vector<std::complex<float>> h1;
+  f1.getImpulseResponse(h1);
+  if((h1[0] == h0[0]) || !std::equal(h1.begin() + 1, h1.end(), h0.begin() + 1)) {
+    std::cout << "The design wasn't read from the design file\n";
+    ok = false; 
+  }
+
+  // A file from another version isn't used, and gets replaced
+  poke(path, 16, uint32_t(SoDa::Filter::DESIGN_VERSION + 1));
+  SoDa::Filter::clearDesignCache();
+  SoDa::Filter f2(spec, 4096, 1.0, SoDa::Filter::HANN);
+  std::vector<std::complex<float>> h2;
+  f2.getImpulseResponse(h2);
+  if((h2 != h0) || (peek<uint32_t>(path, 16) != SoDa::Filter::DESIGN_VERSION)) {
+    std::cout << "A design file with the wrong version was used, or wasn't replaced\n";
+    ok = false; 
+  }
+
+  // So is a file with the wrong hash (renamed from another recipe)
+  poke(path, tap0, std::complex<float>(42.0, 0.0));
+  poke(path, 24, peek<uint64_t>(path, 24) ^ 1);
+  SoDa::Filter::clearDesignCache();
+  SoDa::Filter f3(spec, 4096, 1.0, SoDa::Filter::HANN);
+  std::vector<std::complex<float>> h3;
+  f3.getImpulseResponse(h3);
+  if(h3 != h0) {
+    std::cout << "A design file with the wrong hash was used\n";
+    ok = false; 
+  }
+
+  // And so is a file whose image doesn't fit the buffer size in
+  // the recipe. 
+  poke(path, tap0, std::complex<float>(42.0, 0.0));
+  poke(path, 36 + key_len + 4, uint32_t(2048));
+  SoDa::Filter::clearDesignCache();
+  SoDa::Filter f4(spec, 4096, 1.0, SoDa::Filter::HANN);
+  std::vector<std::complex<float>> h4;
+  f4.getImpulseResponse(h4);
+  if(h4 != h0) {
+    std::cout << "A design file with the wrong image size was used\n";
+    ok = false; 
+  }
+
+  SoDa::Filter::disableDesignFiles();
+  SoDa::Filter::clearDesignCache();
+  std::filesystem::remove_all(dir);
+  return ok; 
+}
+
+int main() {
+  bool passed = true;
+
+  passed = checkCache() && passed;
+  passed = checkEviction() && passed;
+  passed = checkFiles() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,186 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/Filter.hxx"
+#include "../include/FilterSpec.hxx"
+#include "../include/ReSampler.hxx"
+#include "../include/NCO.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check the Kaiser window, and check that a filter with a Kaiser
+// window and a Kaiser tap estimate meets its stop band spec with
+// fewer taps than the usual estimate asks for.
+
+bool checkWindow() {
+  bool ok = true; 
+  struct { float A, beta; } betas[] = { { 60.0, 5.65326 }, { 40.0, 3.39532 }, { 20.0, 0.0 } };
+  for(auto & b : betas) {
+    float beta = SoDa::Filter::kaiserBeta(b.A);
+    if(fabs(beta - b.beta) > 1e-4) {
+      std::cout << SoDa::Format("kaiserBeta(%0) = %1, expected %2\n")
+	.addF(b.A).addF(beta).addF(b.beta);
+      ok = false; 
+    }
+  }
+
+  // symmetric, 1 in the middle, 1/I0(beta) at the ends. 
+  std::vector<float> w(101);
+  SoDa::Filter::kaiserWindow(w, 5.65326);
+  float i0 = 1.0 / 49.0485; // 1 / I0(5.65326)
+  if((fabs(w[50] - 1.0) > 1e-6) || (fabs(w[0] - i0) > 1e-4) || (fabs(w[100] - i0) > 1e-4)) {
+    std::cout << SoDa::Format("Kaiser window center %0 ends %1 %2, expected 1 and %3\n")
+      .addF(w[50]).addF(w[0]).addF(w[100]).addF(i0);
+    ok = false; 
+  }
+  for(int i = 0; i < 50; i++) {
+    if(fabs(w[i] - w[100 - i]) > 1e-6) {
+      std::cout << SoDa::Format("Kaiser window isn't symmetric at %0\n").addI(i);
+      ok = false; 
+      break; 
+    }
+  }
+  return ok; 
+}
+
+// |H(f)| in dB from the impulse response
+static double responseDB(const std::vector<std::complex<float>> & h, double f, double fs) {
+  std::complex<double> acc(0.0, 0.0);
+  for(int i = 0; i < h.size(); i++) {
+    acc += std::complex<double>(h[i]) * std::polar(1.0, -2.0 * M_PI * f * double(i) / fs);
+  }
+  return 20.0 * log10(std::abs(acc) + 1e-30);
+}
+
+// the worst response in the stop band, and the worst passband ripple
+static std::pair<double, double> measure(SoDa::FilterSpec & spec, SoDa::Filter::WindowChoice window, 
+					 float lo, float hi, float skirt, float fs) {
+  SoDa::Filter filt(spec, 16384, 1.0, window);
+  std::vector<std::complex<float>> h;
+  filt.getImpulseResponse(h);
+
+  // The prototype steps at the low pass corner and at the high stop
+  // corner (see FilterSpec::fillHproto), so the stop band starts one
+  // skirt width beyond each step.
+  double worst_stop = -1000.0; 
+  double worst_pass = 0.0; 
+  for(double f = -0.5 * fs; f < 0.5 * fs; f += 25.0) {
+    double db = responseDB(h, f, fs);
+    if((f <= lo - skirt) || (f >= hi + 2 * skirt)) {
+      worst_stop = std::max(worst_stop, db);
+    }
+    else if((f >= lo + skirt) && (f <= hi)) {
+      worst_pass = std::max(worst_pass, fabs(db));
+    }
+  }
+  return std::make_pair(worst_stop, worst_pass);
+}
+
+bool checkDesign(float A) {
+  float fs = 48000.0;
+  float lo = -3000.0, hi = 3000.0, skirt = 500.0;
+  SoDa::FilterSpec spec(fs, lo, hi, skirt, SoDa::FilterSpec::COMPLEX, A);
+  unsigned int taps = spec.estimateTaps(3, 20001, SoDa::FilterSpec::KAISER);
+  SoDa::FilterSpec hspec(fs, lo, hi, skirt, SoDa::FilterSpec::COMPLEX, A);
+  unsigned int harris_taps = hspec.estimateTaps(3, 20001);
+  bool ok = true; 
+  if(taps >= harris_taps) {
+    std::cout << SoDa::Format("%0 dB: the Kaiser estimate (%1 taps) should be shorter than the usual one (%2 taps)\n")
+      .addF(A).addI(taps).addI(harris_taps);
+    ok = false; 
+  }
+
+  // The Kaiser design should meet the spec (give or take a dB)
+  auto kaiser = measure(spec, SoDa::Filter::KAISER, lo, hi, skirt, fs);
+  if((kaiser.first > -(A - 1.0)) || (kaiser.second > 0.1)) {
+    std::cout << SoDa::Format("%0 dB Kaiser design with %1 taps gets %2 dB down in the stop band with %3 dB of passband ripple\n")
+      .addF(A).addI(taps).addF(kaiser.first).addF(kaiser.second);
+    ok = false; 
+  }
+
+  // and the fixed windows shouldn't do as well with the same number
+  // of taps -- they'd need more to get there.
+  for(auto w : { SoDa::Filter::HANN, SoDa::Filter::BLACKMAN }) {
+    auto other = measure(spec, w, lo, hi, skirt, fs);
+    if(other.first < kaiser.first) {
+      std::cout << SoDa::Format("%0 dB with %1 taps: window %2 gets %3 dB down, better than Kaiser's %4 dB\n")
+	.addF(A).addI(taps).addI(int(w)).addF(other.first).addF(kaiser.first);
+      ok = false; 
+    }
+  }
+  return ok; 
+}
+
+// power of the steady state output for a tone, relative to the input
+static double toneGainDB(SoDa::ReSampler & rs, double fs, double freq) {
+  SoDa::NCO osc(fs, freq);
+  std::vector<std::complex<float>> in(rs.getInputBufferSize()), out(rs.getOutputBufferSize());
+  double pow = 0.0; 
+  for(int b = 0; b < 4; b++) {
+    osc.get(in);
+    rs.apply(in, out);
+  }
+  for(auto & v : out) pow += std::norm(v);
+  return 10.0 * log10(pow / double(out.size()) + 1e-30);
+}
+
+bool checkReSampler() {
+  bool ok = true; 
+  SoDa::ReSampler hann(48000.0, 8000.0, 0.05);
+  SoDa::ReSampler kaiser(48000.0, 8000.0, 0.05, SoDa::Filter::KAISER);
+  if(kaiser.getFilterLength() >= hann.getFilterLength()) {
+    std::cout << SoDa::Format("Kaiser ReSampler filter has %0 taps, the Hann filter has %1\n")
+      .addI(kaiser.getFilterLength()).addI(hann.getFilterLength());
+    ok = false; 
+  }
+  double pass = toneGainDB(kaiser, 48000.0, 1000.0);
+  double stop = toneGainDB(kaiser, 48000.0, 7000.0);
+  if((fabs(pass) > 0.2) || (stop > -55.0)) {
+    std::cout << SoDa::Format("Kaiser ReSampler passes 1 kHz at %0 dB and 7 kHz at %1 dB\n")
+      .addF(pass).addF(stop);
+    ok = false; 
+  }
+  return ok; 
+}
+
+int main() {
+  bool passed = true;
+
+  passed = checkWindow() && passed;
+  passed = checkDesign(60.0) && passed;
+  passed = checkDesign(80.0) && passed;
+  passed = checkReSampler() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,118 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/OSFilter.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <random>
+#include "TestSignals.hxx"
+
+// The overlap-and-add engine should match the overlap-and-save
+// engine to rounding, for buffers longer and shorter than the
+// filter, on bursty streams as well as busy ones.
+
+using SoDa::TestSignals::sample;
+
+template<typename ST>
+static bool checkMatch(const std::string & what, unsigned int buffer_size, float skirt, 
+		       bool bursty, double tolerance) {
+  auto os = SoDa::OSFilter::make(-4000.0, 4000.0, skirt, 48000.0, buffer_size, 60.0, 1.0, 
+				 SoDa::Filter::HANN, SoDa::OSFilter::OVERLAP_SAVE);
+  auto oa = SoDa::OSFilter::make(-4000.0, 4000.0, skirt, 48000.0, buffer_size, 60.0, 1.0, 
+				 SoDa::Filter::HANN, SoDa::OSFilter::OVERLAP_ADD);
+  // and one more to check push/pull through the overlap-add engine
+  auto op = oa->clone();
+  
+  if((os->getMethod() != SoDa::OSFilter::OVERLAP_SAVE) || 
+     (oa->getMethod() != SoDa::OSFilter::OVERLAP_ADD) ||
+     (op->getMethod() != SoDa::OSFilter::OVERLAP_ADD)) {
+    std::cout << SoDa::Format("%0: getMethod is wrong\n").addS(what);
+    return false; 
+  }
+  
+  // enough blocks to flush a filter several buffers long
+  unsigned int num_blocks = 20 + 4 * os->getTaps() / buffer_size; 
+  std::vector<ST> in(buffer_size), out_s(buffer_size), out_a(buffer_size), out_p(buffer_size); 
+  std::mt19937 rng(4321);
+  double max_err = 0.0, max_mag = 0.0;
+  bool identical = true; 
+  for(int blk = 0; blk < num_blocks; blk++) {
+    // a bursty stream is silent, except now and then
+    bool silent = bursty && ((rng() % 4) != 0);
+    for(int i = 0; i < buffer_size; i++) {
+      in[i] = silent ? ST(0.0) : sample<ST>(blk * buffer_size + i);
+    }
+    os->apply(in.data(), out_s.data(), buffer_size, 2.0);
+    oa->apply(in.data(), out_a.data(), buffer_size, 2.0);
+    op->push(in.data(), buffer_size / 3);
+    op->push(in.data() + buffer_size / 3, buffer_size - buffer_size / 3);
+    op->pull(out_p.data(), buffer_size, 2.0);
+    identical = identical && (out_a == out_p);
+    for(int i = 0; i < buffer_size; i++) {
+      max_err = std::max(max_err, double(std::abs(out_s[i] - out_a[i])));
+      max_mag = std::max(max_mag, double(std::abs(out_s[i])));
+    }
+  }
+
+  bool ok = true; 
+  if(max_err > tolerance * max_mag) {
+    std::cout << SoDa::Format("%0: overlap-add and overlap-save differ by %1 (largest output %2)\n")
+      .addS(what).addF(max_err, 'e').addF(max_mag, 'e');
+    ok = false; 
+  }
+  if(!identical) {
+    std::cout << SoDa::Format("%0: push/pull and apply differ in overlap-add mode\n").addS(what);
+    ok = false; 
+  }
+  return ok; 
+}
+
+int main() {
+  bool passed = true;
+
+  // buffers longer than the filter
+  passed = checkMatch<std::complex<float>>("complex float, long buffer", 1000, 1000.0, false, 1e-5) && passed;
+  passed = checkMatch<float>("float, long buffer", 1000, 1000.0, false, 1e-5) && passed;
+  passed = checkMatch<std::complex<double>>("complex double, long buffer", 1000, 1000.0, false, 1e-12) && passed;
+  passed = checkMatch<double>("double, long buffer", 1000, 1000.0, false, 1e-12) && passed;
+  // and shorter -- the tail spans several blocks
+  passed = checkMatch<std::complex<float>>("complex float, short buffer", 64, 200.0, false, 1e-5) && passed;
+  passed = checkMatch<double>("double, short buffer", 64, 200.0, false, 1e-12) && passed;
+  // mostly silence, so the overlap-add engine skips most transforms
+  passed = checkMatch<std::complex<float>>("complex float, bursty", 1000, 1000.0, true, 1e-5) && passed;
+  passed = checkMatch<std::complex<double>>("complex double, bursty, short buffer", 64, 200.0, true, 1e-12) && passed;
+
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+  return 0; 
+}
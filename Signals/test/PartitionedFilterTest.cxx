@@ -0,0 +1,147 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/PartitionedFilter.hxx"
+#include "../include/FIRFilter.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <random>
+
+// A partitioned filter should produce exactly what a direct form
+// filter with the same taps does, for any partition size. Check that
+// against a FIRFilter built from the same spec.
+
+static SoDa::FilterSpec makeSpec(unsigned int taps) {
+  SoDa::FilterSpec spec(48000.0, taps);
+  spec.add(-24000.0, 0.0).add(-3300.0, 0.0).add(-3000.0, 1.0)
+    .add(3000.0, 1.0).add(3300.0, 0.0).add(24000.0, 0.0);
+  return spec; 
+}
+
+template<typename T>
+bool checkAgainstFIR(const std::string & name, unsigned int taps, unsigned int bsize, double tol) {
+  auto spec = makeSpec(taps);
+  SoDa::PartitionedFilter pf(spec, bsize);
+  auto fspec = makeSpec(taps);
+  SoDa::FIRFilter fir(fspec, bsize);
+
+  unsigned int expected_parts = (taps + bsize - 1) / bsize;
+  if((pf.getTaps() != taps) || (pf.getNumPartitions() != expected_parts) || (pf.getLatency() != bsize)) {
+    std::cout << SoDa::Format("%0: taps %1 partitions %2 latency %3, expected %4 %5 %6\n")
+      .addS(name).addI(pf.getTaps()).addI(pf.getNumPartitions()).addI(pf.getLatency())
+      .addI(taps).addI(expected_parts).addI(bsize);
+    return false; 
+  }
+  
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  // enough blocks to run all the way through the delay line and then some
+  unsigned int blocks = expected_parts + 3; 
+  std::vector<T> x(bsize), y(bsize), yref(bsize);
+  double err = 0.0, peak = 0.0; 
+  for(unsigned int b = 0; b < blocks; b++) {
+    for(auto & v : x) {
+      if constexpr (std::is_floating_point<T>::value) v = dist(gen);
+      else v = T(dist(gen), dist(gen));
+    }
+    pf.apply(x, y);
+    fir.apply(x, yref);
+    for(unsigned int i = 0; i < bsize; i++) {
+      err = std::max(err, double(std::abs(y[i] - yref[i])));
+      peak = std::max(peak, double(std::abs(yref[i])));
+    }
+  }
+  if(err > tol * peak) {
+    std::cout << SoDa::Format("%0: %1 taps in %2 sample partitions is off by %3 (peak %4)\n")
+      .addS(name).addI(taps).addI(bsize).addF(err, 'e').addF(peak, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkGain() {
+  unsigned int bsize = 128; 
+  auto spec = makeSpec(513);
+  SoDa::PartitionedFilter pf(spec, bsize);
+  auto pf2 = SoDa::PartitionedFilter::make(spec, bsize, 2.0);
+  std::vector<std::complex<float>> x(bsize), y(bsize), y2(bsize), y3(bsize);
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  double err = 0.0; 
+  for(int b = 0; b < 8; b++) {
+    for(auto & v : x) v = std::complex<float>(dist(gen), dist(gen));
+    pf.apply(x, y, 3.0);
+    pf2->apply(x.data(), y2.data(), bsize, 1.5);
+    for(int i = 0; i < bsize; i++) err = std::max(err, double(std::abs(y[i] - y2[i])));
+  }
+  if(err > 1e-4) {
+    std::cout << SoDa::Format("Design gain and apply gain don't agree: error %0\n").addF(err, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkBufferSize() {
+  SoDa::PartitionedFilter pf(-3000.0, 3000.0, 300.0, 48000.0, 256);
+  std::vector<std::complex<float>> x(256), y(128);
+  try {
+    pf.apply(x, y);
+  }
+  catch (SoDa::PartitionedFilter::BadBufferSize & e) {
+    return true; 
+  }
+  std::cout << "Bad buffer size wasn't caught\n";
+  return false; 
+}
+
+int main() {
+  bool passed = true;
+
+  // partitions shorter than, a little bigger than, and longer than
+  // the filter. 
+  for(auto bsize : { 64u, 250u, 1024u, 2048u }) {
+    passed = checkAgainstFIR<std::complex<float>>("complex float", 1025, bsize, 1e-4) && passed;
+  }
+  passed = checkAgainstFIR<float>("real float", 1025, 256, 1e-4) && passed;
+  // 2 * 257 isn't a good FFT size, so these get padded out to 525
+  // (an odd length, which the real transforms have to cope with too).
+  passed = checkAgainstFIR<std::complex<float>>("complex float", 1025, 257, 1e-4) && passed;
+  passed = checkAgainstFIR<float>("real float", 1025, 257, 1e-4) && passed;
+  passed = checkAgainstFIR<std::complex<double>>("complex double", 1025, 256, 1e-9) && passed;
+  passed = checkAgainstFIR<double>("real double", 1025, 256, 1e-9) && passed;
+  passed = checkGain() && passed;
+  passed = checkBufferSize() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
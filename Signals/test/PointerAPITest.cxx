@@ -0,0 +1,234 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include "../include/Filter.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include "../include/NCO.hxx"
+#include "../include/Periodogram.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check the pointer+length entry points against the vector versions.
+// The pointer versions are fed from the middle of a big "ring" buffer,
+// one sample off of any nice alignment, the way a DMA buffer might be. 
+
+static void fill(std::complex<float> * v, unsigned int len, int start) {
+  for(int i = 0; i < len; i++) {
+    int j = i + start; 
+    v[i] = std::complex<float>(cos(0.031 * j) + 0.25 * cos(2.1 * j), 
+			       sin(0.031 * j) + 0.5 * sin(0.77 * j));
+  }
+}
+
+static void fill(float * v, unsigned int len, int start) {
+  for(int i = 0; i < len; i++) {
+    int j = i + start; 
+    v[i] = cos(0.031 * j) + 0.5 * sin(0.77 * j) + 0.25 * cos(2.1 * j);
+  }
+}
+
+template<typename T>
+static float maxDiff(const std::vector<T> & a, const T * b) {
+  float ret = 0.0; 
+  for(int i = 0; i < a.size(); i++) {
+    ret = std::max(ret, float(std::abs(a[i] - b[i])));
+  }
+  return ret; 
+}
+
+static bool report(const std::string & what, float err, float limit) {
+  if(err > limit) {
+    std::cout << SoDa::Format("%0: pointer and vector versions differ by %1\n")
+      .addS(what).addF(err, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkFFT(unsigned int len) {
+  SoDa::FFT fft(len);
+  std::vector<std::complex<float>> x(len), X(len), ring(3 * len + 1);
+  std::complex<float> * xp = ring.data() + 1;
+  std::complex<float> * Xp = xp + len; 
+  fill(x.data(), len, 0);
+  fill(xp, len, 0); 
+
+  fft.fft(x, X);
+  const std::complex<float> * cxp = xp; 
+  fft.fft(cxp, Xp, len);
+  bool ok = report("fft", maxDiff(X, Xp), 1e-3);
+
+  fft.ifft(X, x);
+  fft.ifft(Xp, xp, len);
+  ok = report("ifft", maxDiff(x, xp), 1e-2) && ok;
+
+  std::vector<float> r(len), rring(len + 1);
+  std::vector<std::complex<float>> R(fft.getHalfSpectrumSize());
+  fill(r.data(), len, 0);
+  fill(rring.data() + 1, len, 0);
+  fft.rfft(r, R);
+  const float * rp = rring.data() + 1; 
+  fft.rfft(rp, xp, len);
+  ok = report("rfft", maxDiff(R, xp), 1e-3) && ok;
+  return ok; 
+}
+
+bool checkFilter() {
+  unsigned int len = 1000; 
+  SoDa::Filter filt(-2000.0, 2000.0, 200.0, 48000.0, 121, len);
+
+  std::vector<std::complex<float>> x(len), y(len), ring(2 * len + 1);
+  std::complex<float> * xp = ring.data() + 1;
+  std::complex<float> * yp = xp + len; 
+  fill(x.data(), len, 0);
+  fill(xp, len, 0);
+  filt.apply(x, y);
+  filt.apply(xp, yp, len);
+  bool ok = report("Filter complex", maxDiff(y, yp), 1e-4);
+
+  // a frequency domain input goes in through a const pointer, and
+  // comes out of apply untouched. 
+  SoDa::FFT fft(len);
+  std::vector<std::complex<float>> X(len);
+  fft.fft(x, X);
+  std::vector<std::complex<float>> X_save(X);
+  const std::complex<float> * Xp = X.data(); 
+  filt.apply(Xp, yp, len, SoDa::Filter::InOutMode(false, true));
+  ok = report("Filter spectrum in", maxDiff(y, yp), 1e-4) && ok;
+  if(X != X_save) {
+    std::cout << "Filter apply wrote to its frequency domain input\n";
+    ok = false; 
+  }
+
+  std::vector<float> r(len), ry(len), rring(2 * len + 1);
+  fill(r.data(), len, 0);
+  fill(rring.data() + 1, len, 0);
+  filt.apply(r, ry);
+  const float * rp = rring.data() + 1; 
+  filt.apply(rp, rring.data() + 1 + len, len);
+  return report("Filter real", maxDiff(ry, rring.data() + 1 + len), 1e-4) && ok;
+}
+
+bool checkOSFilter() {
+  unsigned int len = 1200; 
+  // separate filters, as each one keeps its overlap state
+  SoDa::OSFilter vfilt(-2000.0, 2000.0, 200.0, 48000.0, len);
+  SoDa::OSFilter pfilt(-2000.0, 2000.0, 200.0, 48000.0, len);
+
+  std::vector<std::complex<float>> x(len), y(len), ring(5 * len + 1);
+  std::vector<std::complex<float>> yp(len);
+  float err = 0.0;
+  for(int b = 0; b < 5; b++) {
+    fill(x.data(), len, b * len);
+    fill(ring.data() + 1 + b * len, len, b * len);
+    vfilt.apply(x, y);
+    pfilt.apply(ring.data() + 1 + b * len, yp.data(), len);
+    err = std::max(err, maxDiff(y, yp.data()));
+  }
+  return report("OSFilter", err, 1e-4);
+}
+
+bool checkReSampler() {
+  SoDa::ReSampler vrs(48000.0, 8000.0, 0.05);
+  SoDa::ReSampler prs(48000.0, 8000.0, 0.05);
+  unsigned int in_len = vrs.getInputBufferSize();
+  unsigned int out_len = vrs.getOutputBufferSize();
+  std::vector<std::complex<float>> x(in_len), y(out_len), yp(out_len), ring(in_len + 1);
+
+  float err = 0.0;
+  for(int b = 0; b < 3; b++) {
+    fill(x.data(), in_len, b * in_len);
+    fill(ring.data() + 1, in_len, b * in_len);
+    vrs.apply(x, y);
+    prs.apply(ring.data() + 1, in_len, yp.data(), out_len);
+    err = std::max(err, maxDiff(y, yp.data()));
+  }
+  bool ok = report("ReSampler", err, 1e-4);
+
+  // the pointer version should be just as fussy about sizes
+  bool caught = false; 
+  try {
+    prs.apply(ring.data(), in_len - 1, yp.data(), out_len);
+  }
+  catch (SoDa::ReSampler::BadBufferSize & e) {
+    caught = true; 
+  }
+  if(!caught) {
+    std::cout << "ReSampler pointer apply didn't notice a bad input length\n";
+  }
+  return ok && caught;
+}
+
+bool checkNCO() {
+  unsigned int len = 1000; 
+  SoDa::NCO vnco(48000.0, 1234.0);
+  SoDa::NCO pnco(48000.0, 1234.0);
+  std::vector<std::complex<float>> v(len), p(len);
+  vnco.get(v);
+  pnco.get(p.data(), len);
+  vnco.get(v, SoDa::NCO::ADD);
+  pnco.get(p.data(), len, SoDa::NCO::ADD);
+  return report("NCO", maxDiff(v, p.data()), 0.0);
+}
+
+bool checkPeriodogram() {
+  unsigned int len = 4096; 
+  SoDa::Periodogram vp(512, 1.0);
+  SoDa::Periodogram pp(512, 1.0);
+  std::vector<std::complex<float>> x(len);
+  fill(x.data(), len, 0);
+  vp.accumulate(x);
+  // feed the pointer version in odd sized pieces
+  for(unsigned int i = 0; i < len; i += 1000) {
+    pp.accumulate(x.data() + i, std::min(1000u, len - i));
+  }
+  std::vector<float> vres, pres;
+  vp.get(vres);
+  pp.get(pres);
+  return report("Periodogram", maxDiff(vres, pres.data()), 0.0);
+}
+
+int main() {
+  bool passed = checkFFT(720);
+  passed = checkFFT(999) && passed;
+  passed = checkFilter() && passed;
+  passed = checkOSFilter() && passed;
+  passed = checkReSampler() && passed;
+  passed = checkNCO() && passed;
+  passed = checkPeriodogram() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
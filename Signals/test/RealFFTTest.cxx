@@ -0,0 +1,170 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include "../include/Filter.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check the real-to-complex transforms and the real valued
+// filter and resampler paths against their complex cousins.
+
+static void fillReal(std::vector<float> & v, int start) {
+  for(int i = 0; i < v.size(); i++) {
+    int j = i + start; 
+    v[i] = cos(0.031 * j) + 0.5 * sin(0.77 * j) + 0.25 * cos(2.1 * j);
+  }
+}
+
+static void toComplex(std::vector<float> & in, std::vector<std::complex<float>> & out) {
+  for(int i = 0; i < in.size(); i++) {
+    out[i] = std::complex<float>(in[i], 0.0);
+  }
+}
+
+static bool report(const std::string & what, float maxerr, float limit) {
+  if(maxerr > limit) {
+    std::cout << SoDa::Format("%0: real and complex paths differ by %1\n")
+      .addS(what).addF(maxerr, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+bool checkTransform(unsigned int len) {
+  SoDa::FFT fft(len);
+
+  std::vector<float> x(len), xr(len);
+  std::vector<std::complex<float>> xc(len), XC(len);
+  std::vector<std::complex<float>> XH(fft.getHalfSpectrumSize());
+
+  fillReal(x, 0);
+  toComplex(x, xc); 
+  
+  fft.fft(xc, XC);
+  fft.rfft(x, XH);
+
+  float maxerr = 0.0;
+  for(int i = 0; i < XH.size(); i++) {
+    maxerr = std::max(maxerr, std::abs(XH[i] - XC[i]));
+  }
+
+  // and back again
+  fft.irfft(XH, xr);
+  for(int i = 0; i < len; i++) {
+    maxerr = std::max(maxerr, std::abs(xr[i] / float(len) - x[i]));
+  }
+
+  return report(SoDa::Format("rfft/irfft length %0").addI(len).str(), maxerr, 1e-2);
+}
+
+bool checkFilter() {
+  unsigned int len = 1000; 
+  SoDa::Filter filt(-2000.0, 2000.0, 200.0, 48000.0, 121, len);
+
+  std::vector<float> x(len), y(len);
+  std::vector<std::complex<float>> xc(len), yc(len);
+  fillReal(x, 0);
+  toComplex(x, xc);
+
+  filt.apply(x, y);
+  filt.apply(xc, yc);
+  
+  float maxerr = 0.0;
+  for(int i = 0; i < len; i++) {
+    maxerr = std::max(maxerr, std::abs(y[i] - yc[i].real()));
+  }
+  return report("Filter", maxerr, 1e-4);
+}
+
+bool checkOSFilter() {
+  unsigned int len = 1200; 
+  SoDa::OSFilter filt(-2000.0, 2000.0, 200.0, 48000.0, len);
+
+  std::vector<float> x(len), y(len);
+  std::vector<std::complex<float>> xc(len), yc(len);
+  float maxerr = 0.0;
+  for(int b = 0; b < 5; b++) {
+    fillReal(x, b * len);
+    toComplex(x, xc);
+    filt.apply(x, y);
+    filt.apply(xc, yc);
+    for(int i = 0; i < len; i++) {
+      maxerr = std::max(maxerr, std::abs(y[i] - yc[i].real()));
+    }
+  }
+  return report("OSFilter", maxerr, 1e-4);
+}
+
+bool checkReSampler(float fs_in, float fs_out) {
+  // the real and complex paths keep separate state, but we'll use
+  // two resamplers anyway, to be sure. 
+  SoDa::ReSampler rs_r(fs_in, fs_out, 0.05);
+  SoDa::ReSampler rs_c(fs_in, fs_out, 0.05);
+
+  unsigned int in_len = rs_r.getInputBufferSize();
+  unsigned int out_len = rs_r.getOutputBufferSize();
+  std::vector<float> x(in_len), y(out_len);
+  std::vector<std::complex<float>> xc(in_len), yc(out_len);
+  
+  float maxerr = 0.0;
+  float maxval = 0.0; 
+  for(int b = 0; b < 4; b++) {
+    fillReal(x, b * in_len);
+    toComplex(x, xc);
+    rs_r.apply(x, y);
+    rs_c.apply(xc, yc);
+    for(int i = 0; i < out_len; i++) {
+      maxerr = std::max(maxerr, std::abs(y[i] - yc[i].real()));
+      maxval = std::max(maxval, std::abs(yc[i].real()));
+    }
+  }
+  // the two paths treat the Nyquist bin a little differently, but it
+  // is way out in the stop band.
+  return report(SoDa::Format("ReSampler %0 -> %1").addF(fs_in).addF(fs_out).str(),
+		maxerr, 1e-3 * maxval);
+}
+
+int main() {
+  bool passed = checkTransform(720);
+  passed = checkTransform(999) && passed;
+  passed = checkFilter() && passed;
+  passed = checkOSFilter() && passed;
+  passed = checkReSampler(48000.0, 8000.0) && passed;
+  passed = checkReSampler(8000.0, 48000.0) && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
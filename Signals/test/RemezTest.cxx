@@ -0,0 +1,295 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/Filter.hxx"
+#include "../include/FilterSpec.hxx"
+#include "../include/Remez.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include "../include/NCO.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check the equiripple designer: it should meet the spec, with fewer
+// taps than a Kaiser window, and one length shorter should not.
+
+static const float fs = 48000.0;
+
+// |H(f)| in dB from the impulse response
+static double responseDB(const std::vector<std::complex<float>> & h, double f) {
+  std::complex<double> acc(0.0, 0.0);
+  for(int i = 0; i < h.size(); i++) {
+    acc += std::complex<double>(h[i]) * std::polar(1.0, -2.0 * M_PI * f * double(i) / fs);
+  }
+  return 20.0 * log10(std::abs(acc) + 1e-30);
+}
+
+struct Response {
+  double stop; ///< the highest point in the stop band (dB)
+  double ripple; ///< peak-to-peak ripple in the pass band (dB)
+};
+
+// measure a filter that passes lo...hi and stops everything more than a skirt away.
+static Response measure(const std::vector<std::complex<float>> & h, float lo, float hi, float skirt) {
+  Response r;
+  r.stop = -1000.0;
+  double pmax = -1000.0, pmin = 1000.0; 
+  for(double f = -0.5 * fs; f < 0.5 * fs; f += 10.0) {
+    double db = responseDB(h, f);
+    if((f <= lo - skirt) || (f >= hi + skirt)) {
+      r.stop = std::max(r.stop, db);
+    }
+    else if((f >= lo) && (f <= hi)) {
+      pmax = std::max(pmax, db);
+      pmin = std::min(pmin, db);
+    }
+  }
+  // measure the stop band from the middle of the pass band
+  r.stop = r.stop - 0.5 * (pmax + pmin); 
+  r.ripple = pmax - pmin; 
+  return r; 
+}
+
+static bool checkResponse(const std::string & what, const std::vector<std::complex<float>> & h, 
+			  float lo, float hi, float skirt, float A) {
+  auto r = measure(h, lo, hi, skirt);
+  // allow a little for the finite design grid
+  if((r.stop > -(A - 0.2)) || (r.ripple > 0.11)) {
+    std::cout << SoDa::Format("%0 with %1 taps: stop band %2 dB, pass band ripple %3 dB\n")
+      .addS(what).addI(h.size()).addF(r.stop).addF(r.ripple);
+    return false; 
+  }
+  return true; 
+}
+
+bool checkLowPass(float A) {
+  bool ok = true; 
+  float lo = -3000.0, hi = 3000.0, skirt = 500.0;
+  SoDa::FilterSpec spec(fs, lo, hi, skirt, SoDa::FilterSpec::COMPLEX, A);
+  unsigned int taps = spec.estimateTaps(3, 2001, SoDa::FilterSpec::EQUIRIPPLE);
+  // A window design reaches the stop band a skirt width past the
+  // stop corner (see FilterSpec::fillHproto), so give the Kaiser
+  // filter half the skirt. Then the transition bands are the same width. 
+  SoDa::FilterSpec kspec(fs, lo, hi, 0.5 * skirt, SoDa::FilterSpec::COMPLEX, A);
+  unsigned int kaiser_taps = kspec.estimateTaps(3, 2001, SoDa::FilterSpec::KAISER);
+  if((taps % 2) != 1) {
+    std::cout << SoDa::Format("%0 dB: equiripple estimate should be odd, got %1\n").addF(A).addI(taps);
+    ok = false; 
+  }
+  if(double(taps) > 0.85 * double(kaiser_taps)) {
+    std::cout << SoDa::Format("%0 dB: the equiripple design needs %1 taps, the Kaiser window %2 taps\n")
+      .addF(A).addI(taps).addI(kaiser_taps);
+    ok = false; 
+  }
+
+  // build it as a Filter and check the response
+  SoDa::Filter filt(spec, 4096, 1.0, SoDa::Filter::EQUIRIPPLE);
+  std::vector<std::complex<float>> h;
+  filt.getImpulseResponse(h);
+  if(h.size() != taps) {
+    std::cout << SoDa::Format("Filter has %0 taps, expected %1\n").addI(h.size()).addI(taps);
+    ok = false; 
+  }
+  ok = checkResponse(SoDa::Format("%0 dB low pass").addF(A).str(), h, lo, hi, skirt, A) && ok;
+
+  // it should be linear phase, and real (the spec is symmetric)
+  for(int i = 0; i < h.size(); i++) {
+    if((std::abs(h[i] - h[h.size() - 1 - i]) > 1e-5) || (fabs(h[i].imag()) > 1e-5)) {
+      std::cout << SoDa::Format("%0 dB low pass: tap %1 = (%2, %3) tap %4 = (%5, %6)\n")
+	.addF(A).addI(i).addF(h[i].real()).addF(h[i].imag())
+	.addI(h.size() - 1 - i).addF(h[h.size() - 1 - i].real()).addF(h[h.size() - 1 - i].imag());
+      ok = false;
+      break; 
+    }
+  }
+  
+  // and it should be the shortest one that does the job
+  SoDa::Remez remez(spec);
+  double err = remez.design(taps, h);
+  double shorter_err = remez.design(taps - 2, h);
+  if((err > 1.0) || (shorter_err <= 1.0)) {
+    std::cout << SoDa::Format("%0 dB low pass: relative error with %1 taps is %2, with %3 taps it is %4\n")
+      .addF(A).addI(taps).addF(err).addI(taps - 2).addF(shorter_err);
+    ok = false; 
+  }
+  
+  return ok; 
+}
+
+// An upper sideband filter isn't symmetric about zero, so the taps are complex.
+bool checkSideband() {
+  bool ok = true; 
+  float A = 70.0; 
+  SoDa::FilterSpec spec(fs, 1, SoDa::FilterSpec::COMPLEX);
+  spec.setStopBandAttenuation(A);
+  spec.add(-0.5 * fs, 0.0).add(100.0, 0.0).add(300.0, 1.0).add(2800.0, 1.0).add(3000.0, 0.0).add(0.5 * fs, 0.0);
+  spec.estimateTaps(3, 2001, SoDa::FilterSpec::EQUIRIPPLE);
+  SoDa::Filter filt(spec, 4096, 1.0, SoDa::Filter::EQUIRIPPLE);
+  std::vector<std::complex<float>> h;
+  filt.getImpulseResponse(h);
+
+  double pass = responseDB(h, 1500.0);
+  double image = responseDB(h, -1500.0);
+  double low = responseDB(h, 100.0);
+  double high = responseDB(h, 3000.0);
+  if((fabs(pass) > 0.1) || ((image - pass) > -(A - 0.2)) 
+     || ((low - pass) > -(A - 0.2)) || ((high - pass) > -(A - 0.2))) {
+    std::cout << SoDa::Format("sideband filter with %0 taps: 1500 Hz %1 dB  -1500 Hz %2 dB  100 Hz %3 dB  3000 Hz %4 dB\n")
+      .addI(h.size()).addF(pass).addF(image).addF(low).addF(high);
+    ok = false; 
+  }
+  return ok; 
+}
+
+// A REAL spec describes only positive frequencies. The filter has real taps.
+bool checkReal() {
+  bool ok = true;
+  float A = 60.0; 
+  SoDa::FilterSpec spec(fs, 1, SoDa::FilterSpec::REAL);
+  spec.setStopBandAttenuation(A);
+  spec.setPassBandRipple(0.5);
+  spec.add(0.0, 1.0).add(4000.0, 1.0).add(4800.0, 0.0).add(0.5 * fs, 0.0);
+  spec.estimateTaps(3, 2001, SoDa::FilterSpec::EQUIRIPPLE);
+  SoDa::Remez remez(spec);
+  std::vector<std::complex<float>> h;
+  remez.design(spec.getTaps(), h);
+  for(auto & v : h) {
+    if(v.imag() != 0.0) {
+      std::cout << "REAL spec gave complex taps\n";
+      ok = false;
+      break; 
+    }
+  }
+  auto r = measure(h, -4000.0, 4000.0, 800.0);
+  if((r.stop > -(A - 0.2)) || (r.ripple > 0.51)) {
+    std::cout << SoDa::Format("REAL low pass with %0 taps: stop band %1 dB, pass band ripple %2 dB\n")
+      .addI(h.size()).addF(r.stop).addF(r.ripple);
+    ok = false; 
+  }
+
+  // A looser pass band needs fewer taps
+  SoDa::FilterSpec tight(fs, 1, SoDa::FilterSpec::REAL);
+  tight.setStopBandAttenuation(A);
+  tight.setPassBandRipple(0.01);
+  tight.add(0.0, 1.0).add(4000.0, 1.0).add(4800.0, 0.0).add(0.5 * fs, 0.0);
+  tight.estimateTaps(3, 2001, SoDa::FilterSpec::EQUIRIPPLE);
+  if(tight.getTaps() <= spec.getTaps()) {
+    std::cout << SoDa::Format("0.5 dB ripple took %0 taps, 0.01 dB took %1\n")
+      .addI(spec.getTaps()).addI(tight.getTaps());
+    ok = false; 
+  }
+  return ok; 
+}
+
+// power of the steady state output for a tone, relative to the input
+static double toneGainDB(SoDa::OSFilter & filt, double freq) {
+  SoDa::NCO osc(fs, freq);
+  std::vector<std::complex<float>> in(1024), out(1024);
+  double pow = 0.0; 
+  for(int b = 0; b < 4; b++) {
+    osc.get(in);
+    filt.apply(in, out);
+  }
+  for(auto & v : out) pow += std::norm(v);
+  return 10.0 * log10(pow / double(out.size()) + 1e-30);
+}
+
+bool checkOSFilter() {
+  bool ok = true; 
+  SoDa::OSFilter filt(-3000.0, 3000.0, 500.0, fs, 1024, 60.0, 1.0, SoDa::Filter::EQUIRIPPLE);
+  double pass = toneGainDB(filt, 1000.0);
+  double stop = toneGainDB(filt, 4000.0);
+  if((fabs(pass) > 0.1) || (stop > -59.8)) {
+    std::cout << SoDa::Format("equiripple OSFilter passes 1 kHz at %0 dB and 4 kHz at %1 dB\n")
+      .addF(pass).addF(stop);
+    ok = false; 
+  }
+  return ok; 
+}
+
+// the ReSampler's output power for a tone
+static double toneGainDB(SoDa::ReSampler & rs, double freq) {
+  SoDa::NCO osc(fs, freq);
+  std::vector<std::complex<float>> in(rs.getInputBufferSize()), out(rs.getOutputBufferSize());
+  double pow = 0.0; 
+  for(int b = 0; b < 4; b++) {
+    osc.get(in);
+    rs.apply(in, out);
+  }
+  for(auto & v : out) pow += std::norm(v);
+  return 10.0 * log10(pow / double(out.size()) + 1e-30);
+}
+
+// The equiripple ReSampler should be flat to 0.45 of the output rate
+// and stop anything that would alias.
+bool checkReSampler() {
+  bool ok = true; 
+  SoDa::ReSampler rs(fs, 8000.0, 0.05, SoDa::Filter::EQUIRIPPLE);
+  double pass = toneGainDB(rs, 1000.0);
+  double edge = toneGainDB(rs, 3500.0);
+  double alias = toneGainDB(rs, 4500.0);
+  if((fabs(pass) > 0.1) || (fabs(edge) > 0.1) || (alias > -59.5)) {
+    std::cout << SoDa::Format("equiripple ReSampler with %0 taps passes 1 kHz at %1 dB, 3.5 kHz at %2 dB and 4.5 kHz at %3 dB\n")
+      .addI(rs.getFilterLength()).addF(pass).addF(edge).addF(alias);
+    ok = false; 
+  }
+  return ok; 
+}
+
+bool checkBadSpec() {
+  SoDa::FilterSpec spec(fs, 101, SoDa::FilterSpec::COMPLEX);
+  spec.add(-0.5 * fs, 1.0).add(0.5 * fs, 1.0);
+  try {
+    SoDa::Remez remez(spec);
+  }
+  catch (SoDa::Remez::BadSpec & e) {
+    return true; 
+  }
+  std::cout << "A spec with no transition band didn't throw BadSpec\n";
+  return false; 
+}
+
+int main() {
+  bool passed = true;
+
+  passed = checkLowPass(60.0) && passed;
+  passed = checkLowPass(80.0) && passed;
+  passed = checkSideband() && passed;
+  passed = checkReal() && passed;
+  passed = checkOSFilter() && passed;
+  passed = checkReSampler() && passed;
+  passed = checkBadSpec() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,506 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/FFT.hxx"
+#include "../include/Filter.hxx"
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include "../include/NCO.hxx"
+#include "../include/Periodogram.hxx"
+#include "../include/ToneBank.hxx"
+#include "../include/VectorKernels.hxx"
+#include "../include/FIRFilter.hxx"
+#include "../include/PartitionedFilter.hxx"
+#include "../include/Channelizer.hxx"
+#include "../include/ChannelSynthesizer.hxx"
+#include <Utils/include/Options.hxx>
+#include <Utils/include/Format.hxx>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+#include <map>
+#include <complex>
+#include <cmath>
+
+// SoDaBench: throughput and latency for the Signals classes across a
+// matrix of sizes and rates.  Results go out as JSON or CSV, and can
+// be compared against a saved run to catch performance regressions.
+//
+//   SoDaBench --out base.json                  # save a baseline
+//   SoDaBench --baseline base.json             # compare against it
+//
+// Each case is a callable that consumes some number of input samples.
+// We time every call, so we get both throughput (input Msamples/s)
+// and the latency distribution (per call). 
+
+typedef std::vector<std::complex<float>> CVec;
+typedef std::vector<float> FVec; 
+
+struct Result {
+  std::string bench;   // which class/method
+  std::string config;  // sizes and rates
+  unsigned int calls;  // how many calls we timed
+  double msps;         // input megasamples per second
+  double p50_us, p90_us, p99_us; // per-call latency percentiles
+
+  std::string key() const { return bench + " " + config; }
+};
+
+// a short, unpadded number for the progress and regression messages
+static std::string num(double v) {
+  std::ostringstream ss;
+  ss << std::setprecision(4) << v;
+  return ss.str();
+}
+
+static std::mt19937 rng(12345);
+static std::uniform_real_distribution<float> distr(-1.0, 1.0);
+
+static void fill(CVec & v) {
+  for(auto & s : v) s = std::complex<float>(distr(rng), distr(rng));
+}
+
+static void fill(FVec & v) {
+  for(auto & s : v) s = distr(rng);
+}
+
+class Bench {
+public:
+  Bench(double seconds) : seconds(seconds) { }
+
+  void run(const std::string & bench, const std::string & config, 
+	   unsigned int samples_per_call, std::function<void()> f) {
+    // warm up -- the first call may size buffers or make plans
+    for(int i = 0; i < 3; i++) f();
+
+    std::vector<double> lat; 
+    double total = 0.0; 
+    while((total < seconds) || (lat.size() < 10)) {
+      auto st = std::chrono::steady_clock::now();
+      f();
+      std::chrono::duration<double> el = std::chrono::steady_clock::now() - st;
+      lat.push_back(el.count());
+      total += el.count();
+    }
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&lat](double p) { 
+      return 1e6 * lat[std::min(lat.size() - 1, size_t(p * lat.size()))]; 
+    };
+    
+    Result r;
+    r.bench = bench;
+    r.config = config;
+    r.calls = lat.size();
+    r.msps = 1e-6 * double(samples_per_call) * double(lat.size()) / total; 
+    r.p50_us = pct(0.5);
+    r.p90_us = pct(0.9);
+    r.p99_us = pct(0.99);
+    results.push_back(r);
+    
+    std::cerr << SoDa::Format("%0 %1: %2 Msamples/s  p50 %3 us\n")
+      .addS(bench).addS(config).addS(num(r.msps)).addS(num(r.p50_us));
+  }
+
+  std::vector<Result> results; 
+  double seconds; 
+};
+
+static void benchFFT(Bench & b, const std::vector<unsigned int> & sizes) {
+  for(auto len : sizes) {
+    SoDa::FFT fft(len);
+    SoDa::AlignedVector<std::complex<float>> x(len), X(len), Xh(fft.getHalfSpectrumSize());
+    SoDa::AlignedVector<float> xr(len);
+    for(auto & s : x) s = std::complex<float>(distr(rng), distr(rng));
+    for(auto & s : xr) s = distr(rng);
+    auto cfg = SoDa::Format("len=%0").addI(len).str();
+    b.run("FFT::fft", cfg, len, [&]() { fft.fft(x, X); });
+    b.run("FFT::rfft", cfg, len, [&]() { fft.rfft(xr, Xh); });
+  }
+}
+
+static void benchFilter(Bench & b, const std::vector<unsigned int> & sizes) {
+  for(auto len : sizes) {
+    SoDa::Filter filt(-2000.0, 2000.0, 200.0, 48000.0, 127, len);
+    CVec x(len), y(len);
+    FVec xr(len), yr(len);
+    fill(x);
+    fill(xr);
+    auto cfg = SoDa::Format("len=%0 taps=127").addI(len).str();
+    b.run("Filter::apply complex", cfg, len, [&]() { filt.apply(x, y); });
+    b.run("Filter::apply real", cfg, len, [&]() { filt.apply(xr, yr); });
+  }
+}
+
+static void benchOSFilter(Bench & b, const std::vector<unsigned int> & sizes) {
+  for(auto len : sizes) {
+    SoDa::OSFilter filt(-2000.0, 2000.0, 200.0, 48000.0, len);
+    CVec x(len), y(len);
+    FVec xr(len), yr(len);
+    fill(x);
+    fill(xr);
+    auto cfg = SoDa::Format("len=%0 taps=%1").addI(len).addI(filt.getTaps()).str();
+    b.run("OSFilter::apply complex", cfg, len, [&]() { filt.apply(x, y); });
+    b.run("OSFilter::apply real", cfg, len, [&]() { filt.apply(xr, yr); });
+  }
+}
+
+// the two OSFilter engines, over a range of buffer to filter length
+// ratios.  "bursty" input is one busy block in four, the rest silent. 
+static void benchOSFilterMethods(Bench & b, const std::vector<unsigned int> & sizes, 
+				 const std::vector<float> & skirts) {
+  for(auto len : sizes) {
+    for(auto skirt : skirts) {
+      for(auto method : { SoDa::OSFilter::OVERLAP_SAVE, SoDa::OSFilter::OVERLAP_ADD }) {
+	SoDa::OSFilter filt(-2000.0, 2000.0, skirt, 48000.0, len, 60.0, 1.0, 
+			    SoDa::Filter::HANN, method);
+	std::vector<CVec> busy(4, CVec(len)), bursty(4, CVec(len, 0.0));
+	for(auto & v : busy) fill(v);
+	fill(bursty[0]);
+	CVec y(len);
+	unsigned int k = 0; 
+	auto cfg = SoDa::Format("len=%0 taps=%1 len/taps=%2 method=%3")
+	  .addI(len).addI(filt.getTaps()).addS(num(double(len) / double(filt.getTaps())))
+	  .addS((method == SoDa::OSFilter::OVERLAP_SAVE) ? "save" : "add").str();
+	b.run("OSFilter::apply complex busy", cfg, len, [&]() { filt.apply(busy[k++ & 3], y); });
+	b.run("OSFilter::apply complex bursty", cfg, len, [&]() { filt.apply(bursty[k++ & 3], y); });
+      }
+    }
+  }
+}
+
+// short filters, direct form against overlap-and-save with the same spec
+static void benchFIRFilter(Bench & b, const std::vector<unsigned int> & taps, unsigned int len) {
+  for(auto t : taps) {
+    SoDa::FilterSpec spec(48000.0, t);
+    spec.add(-24000.0, 0.0).add(-8000.0, 0.0).add(-4000.0, 1.0)
+      .add(4000.0, 1.0).add(8000.0, 0.0).add(24000.0, 0.0);
+    SoDa::FIRFilter fir(spec, len);
+    SoDa::OSFilter osf(spec, len);
+    CVec x(len), y(len);
+    fill(x);
+    auto cfg = SoDa::Format("len=%0 taps=%1 direct_picked=%2")
+      .addI(len).addI(t).addS(SoDa::FIRFilter::directIsFaster(t, len) ? "yes" : "no").str();
+    b.run("FIRFilter::apply complex", cfg, len, [&]() { fir.apply(x, y); });
+    b.run("OSFilter::apply complex (same spec)", cfg, len, [&]() { osf.apply(x, y); });
+  }
+}
+
+// one long, sharp filter cut into partitions of different sizes: the
+// latency/throughput trade-off
+static void benchPartitionedFilter(Bench & b, unsigned int taps, const std::vector<unsigned int> & sizes) {
+  float fs = 48000.0; 
+  for(auto len : sizes) {
+    SoDa::FilterSpec spec(fs, taps);
+    spec.add(-24000.0, 0.0).add(-3300.0, 0.0).add(-3000.0, 1.0)
+      .add(3000.0, 1.0).add(3300.0, 0.0).add(24000.0, 0.0);
+    SoDa::PartitionedFilter pf(spec, len);
+    CVec x(len), y(len);
+    fill(x);
+    auto cfg = SoDa::Format("len=%0 taps=%1 partitions=%2 latency_ms=%3 est_ns_per_sample=%4")
+      .addI(len).addI(taps).addI(pf.getNumPartitions())
+      .addS(num(1000.0 * double(pf.getLatency()) / fs))
+      .addS(num(SoDa::PartitionedFilter::getSampleCost(taps, len))).str();
+    b.run("PartitionedFilter::apply complex", cfg, len, [&]() { pf.apply(x, y); });
+  }
+}
+
+static void benchReSampler(Bench & b, const std::vector<std::pair<double, double>> & rates) {
+  for(auto & r : rates) {
+    SoDa::ReSampler rs(r.first, r.second, 0.05);
+    auto in_len = rs.getInputBufferSize();
+    auto out_len = rs.getOutputBufferSize();
+    CVec x(in_len), y(out_len);
+    FVec xr(in_len), yr(out_len);
+    fill(x);
+    fill(xr);
+    auto cfg = SoDa::Format("fs_in=%0 fs_out=%1 len=%2")
+      .addI(int(r.first)).addI(int(r.second)).addI(in_len).str();
+    b.run("ReSampler::apply complex", cfg, in_len, [&]() { rs.apply(x, y); });
+    b.run("ReSampler::apply real", cfg, in_len, [&]() { rs.apply(xr, yr); });
+  }
+}
+
+static void benchNCO(Bench & b, const std::vector<unsigned int> & sizes) {
+  for(auto len : sizes) {
+    SoDa::NCO nco(48000.0, 1234.5);
+    CVec y(len);
+    auto cfg = SoDa::Format("len=%0").addI(len).str();
+    b.run("NCO::get", cfg, len, [&]() { nco.get(y); });
+  }
+}
+
+static void benchPeriodogram(Bench & b, const std::vector<unsigned int> & segs) {
+  for(auto seg : segs) {
+    SoDa::Periodogram pdg(seg, 0.1);
+    unsigned int len = 16384; 
+    CVec x(len);
+    fill(x);
+    auto cfg = SoDa::Format("segment=%0 len=%1").addI(seg).addI(len).str();
+    b.run("Periodogram::accumulate", cfg, len, [&]() { pdg.accumulate(x); });
+  }
+}
+
+// the per-bin multiply, on every instruction set this machine has
+static void benchKernels(Bench & b, const std::vector<unsigned int> & sizes) {
+  typedef SoDa::VectorKernels VK; 
+  auto best = VK::getISA();
+  for(auto isa : { VK::SCALAR, VK::SSE2, VK::AVX2, VK::AVX512 }) {
+    if(!VK::setISA(isa)) continue; 
+    for(auto len : sizes) {
+      CVec x(len), h(len), y(len);
+      fill(x);
+      fill(h);
+      auto cfg = SoDa::Format("isa=%0 len=%1").addS(VK::getISAName(isa)).addI(len).str();
+      b.run("VectorKernels::mul", cfg, len, [&]() { VK::mul(x.data(), h.data(), y.data(), len); });
+    }
+  }
+  VK::setISA(best);
+}
+
+// A handful of tones out of a block is the case where a ToneBank
+// should beat a Periodogram of the same segment length.
+static void benchToneBank(Bench & b, const std::vector<unsigned int> & blocks) {
+  std::vector<float> freqs = { 697.0, 770.0, 852.0, 941.0, 1209.0 };
+  for(auto block : blocks) {
+    unsigned int len = 16384; 
+    CVec x(len);
+    fill(x);
+    auto cfg = SoDa::Format("tones=%0 block=%1 len=%2")
+      .addI(freqs.size()).addI(block).addI(len).str();
+    SoDa::ToneBank gtz(48000.0, freqs, block, SoDa::ToneBank::GOERTZEL);
+    b.run("ToneBank::apply goertzel", cfg, len, [&]() { gtz.apply(x); });
+    SoDa::ToneBank sdft(48000.0, freqs, block, SoDa::ToneBank::SLIDING_DFT);
+    b.run("ToneBank::apply sliding", cfg, len, [&]() { sdft.apply(x); });
+  }
+}
+
+// split a wideband stream into channels, both sampling modes
+static void benchChannelizer(Bench & b, const std::vector<unsigned int> & channels) {
+  for(auto M : channels) {
+    for(auto mode : { SoDa::Channelizer::CRITICAL, SoDa::Channelizer::OVERSAMPLED_2X }) {
+      SoDa::Channelizer chan(1.0e6, M, mode);
+      unsigned int frames = 64; 
+      unsigned int len = frames * chan.getDecimation();
+      CVec x(len), y(frames * M);
+      fill(x);
+      auto cfg = SoDa::Format("channels=%0 mode=%1 len=%2")
+	.addI(M).addS((mode == SoDa::Channelizer::CRITICAL) ? "critical" : "2x").addI(len).str();
+      b.run("Channelizer::apply", cfg, len, [&]() { chan.apply(x, y); });
+    }
+  }
+}
+
+// and put them back together
+static void benchChannelSynthesizer(Bench & b, const std::vector<unsigned int> & channels) {
+  for(auto M : channels) {
+    SoDa::ChannelSynthesizer synth(1.0e6, M);
+    unsigned int frames = 64; 
+    unsigned int len = frames * synth.getInterpolation();
+    CVec x(frames * M), y(len);
+    fill(x);
+    auto cfg = SoDa::Format("channels=%0 mode=2x len=%1").addI(M).addI(len).str();
+    b.run("ChannelSynthesizer::apply", cfg, len, [&]() { synth.apply(x, y); });
+  }
+}
+
+static std::string jsonEscape(const std::string & s) {
+  std::string ret; 
+  for(auto c : s) {
+    if((c == '"') || (c == '\\')) ret += '\\';
+    ret += c; 
+  }
+  return ret; 
+}
+
+// one record per line, so that readBaseline doesn't need a real JSON parser
+static void writeJSON(std::ostream & os, const std::vector<Result> & results) {
+  os << std::setprecision(6);
+  os << "[\n";
+  for(int i = 0; i < results.size(); i++) {
+    auto & r = results[i];
+    os << "  {\"bench\": \"" << jsonEscape(r.bench) << "\", "
+       << "\"config\": \"" << jsonEscape(r.config) << "\", "
+       << "\"calls\": " << r.calls << ", "
+       << "\"msps\": " << r.msps << ", "
+       << "\"p50_us\": " << r.p50_us << ", "
+       << "\"p90_us\": " << r.p90_us << ", "
+       << "\"p99_us\": " << r.p99_us << "}"
+       << ((i + 1 == results.size()) ? "\n" : ",\n");
+  }
+  os << "]\n";
+}
+
+static void writeCSV(std::ostream & os, const std::vector<Result> & results) {
+  os << std::setprecision(6);
+  os << "bench,config,calls,msps,p50_us,p90_us,p99_us\n";
+  for(auto & r : results) {
+    os << r.bench << "," << r.config << "," << r.calls << "," 
+       << r.msps << "," << r.p50_us << "," << r.p90_us << "," << r.p99_us << "\n";
+  }
+}
+
+// pull "key": value out of one of our JSON records
+static std::string jsonField(const std::string & line, const std::string & key) {
+  auto pos = line.find("\"" + key + "\":");
+  if(pos == std::string::npos) return "";
+  pos = line.find_first_not_of(' ', pos + key.size() + 3);
+  if(pos == std::string::npos) return "";
+  if(line[pos] == '"') {
+    std::string ret;
+    for(pos++; (pos < line.size()) && (line[pos] != '"'); pos++) {
+      if(line[pos] == '\\') pos++;
+      ret += line[pos];
+    }
+    return ret; 
+  }
+  auto end = line.find_first_of(",}", pos);
+  return line.substr(pos, end - pos);
+}
+
+// read a baseline written by writeJSON or writeCSV: key -> msps
+static bool readBaseline(const std::string & fname, std::map<std::string, double> & baseline) {
+  std::ifstream inf(fname);
+  if(!inf) return false;
+  std::string line;
+  while(std::getline(inf, line)) {
+    if(line.find("\"bench\"") != std::string::npos) {
+      baseline[jsonField(line, "bench") + " " + jsonField(line, "config")] = 
+	atof(jsonField(line, "msps").c_str());
+    }
+    else if((line.find(',') != std::string::npos) && (line.compare(0, 6, "bench,") != 0)) {
+      std::vector<std::string> fields;
+      std::stringstream ss(line);
+      std::string f; 
+      while(std::getline(ss, f, ',')) fields.push_back(f);
+      if(fields.size() >= 4) {
+	baseline[fields[0] + " " + fields[1]] = atof(fields[3].c_str());
+      }
+    }
+  }
+  return true; 
+}
+
+int main(int argc, char * argv[]) {
+  std::string format, out_fname, baseline_fname;
+  double seconds, tolerance; 
+  bool quick; 
+  
+  SoDa::Options cmd;
+  cmd.add(&format, "format", 'f', std::string("json"), "output format: json or csv")
+    .add(&out_fname, "out", 'o', std::string(""), "write results here (default: stdout)")
+    .add(&baseline_fname, "baseline", 'b', std::string(""), "compare against results from an earlier run (json or csv)")
+    .add(&tolerance, "tolerance", 't', 0.10, "report a regression if throughput drops by more than this fraction")
+    .add(&seconds, "seconds", 's', 0.25, "time spent on each case")
+    .addP(&quick, "quick", 'q', "a short run over a small matrix (for smoke tests)")
+    .addInfo("Measure throughput and latency of the SoDa Signals classes.\n");
+
+  if(!cmd.parse(argc, argv) || ((format != "json") && (format != "csv"))) {
+    std::cout << "Bad command line\nFAILED\n";
+    exit(-1);
+  }
+
+  if(quick) seconds = std::min(seconds, 0.02);
+  Bench b(seconds);
+
+  if(quick) {
+    benchFFT(b, { 1024, 1000 });
+    benchFilter(b, { 1024 });
+    benchOSFilter(b, { 1000 });
+    benchOSFilterMethods(b, { 1000 }, { 500.0 });
+    benchFIRFilter(b, { 15 }, 256);
+    benchPartitionedFilter(b, 2049, { 256 });
+    benchReSampler(b, { {48000.0, 8000.0} });
+    benchNCO(b, { 1024 });
+    benchPeriodogram(b, { 1024 });
+    benchToneBank(b, { 1024 });
+    benchChannelizer(b, { 64 });
+    benchChannelSynthesizer(b, { 64 });
+    benchKernels(b, { 1024 });
+  }
+  else {
+    benchFFT(b, { 256, 1024, 4096, 16384, 65536, 1000, 4800, 44100 });
+    benchFilter(b, { 1024, 4096, 16384 });
+    benchOSFilter(b, { 1000, 4000, 16000 });
+    benchOSFilterMethods(b, { 256, 1000, 4000, 16000 }, { 2000.0, 500.0, 100.0 });
+    benchFIRFilter(b, { 7, 15, 31, 63, 127 }, 256);
+    benchFIRFilter(b, { 7, 15, 31, 63, 127 }, 4096);
+    benchPartitionedFilter(b, 4097, { 64, 128, 256, 512, 1024, 2048, 4096 });
+    benchReSampler(b, { {48000.0, 8000.0}, {8000.0, 48000.0}, 
+	               {625000.0, 48000.0}, {48000.0, 44100.0}, {1250000.0, 48000.0} });
+    benchNCO(b, { 1024, 16384 });
+    benchPeriodogram(b, { 1024, 4096, 16384 });
+    benchToneBank(b, { 1024, 4096, 16384 });
+    benchChannelizer(b, { 16, 64, 256 });
+    benchChannelSynthesizer(b, { 16, 64, 256 });
+    benchKernels(b, { 1024, 16384 });
+  }
+
+  std::ofstream of;
+  if(!out_fname.empty()) {
+    of.open(out_fname);
+    if(!of) {
+      std::cout << SoDa::Format("Couldn't open output file [%0]\nFAILED\n").addS(out_fname);
+      exit(-1);
+    }
+  }
+  std::ostream & os = out_fname.empty() ? std::cout : of; 
+  if(format == "json") writeJSON(os, b.results);
+  else writeCSV(os, b.results);
+  if(of.is_open()) of.close();
+
+  bool passed = true; 
+  if(!baseline_fname.empty()) {
+    std::map<std::string, double> baseline;
+    if(!readBaseline(baseline_fname, baseline)) {
+      std::cout << SoDa::Format("Couldn't read baseline file [%0]\nFAILED\n").addS(baseline_fname);
+      exit(-1);
+    }
+    for(auto & r : b.results) {
+      auto it = baseline.find(r.key());
+      if(it == baseline.end()) continue; 
+      double change = (r.msps - it->second) / it->second;
+      if(change < -tolerance) {
+	passed = false; 
+	std::cout << SoDa::Format("# REGRESSION %0: %1 Msamples/s, baseline %2 (%3%%)\n")
+	  .addS(r.key()).addS(num(r.msps)).addS(num(it->second))
+	  .addS(num(100.0 * change));
+      }
+    }
+  }
+
+  // the results may be going to stdout, so keep this looking like a comment
+  // to anybody who isn't ctest. 
+  std::cout << (passed ? "# PASSED\n" : "# FAILED\n");
+  return passed ? 0 : 1; 
+}
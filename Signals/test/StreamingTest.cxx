@@ -0,0 +1,220 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/OSFilter.hxx"
+#include "../include/ReSampler.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+#include <random>
+#include "TestSignals.hxx"
+
+// Push a stream through OSFilter and ReSampler in odd sized pieces,
+// pull the output in other odd sized pieces, and check that it
+// matches what the fixed size apply methods make.
+
+using SoDa::TestSignals::sample;
+
+// push the whole stream in random pieces, pulling random amounts
+// along the way.  Return everything that came out. 
+template<typename ST, typename Push, typename Pull>
+static std::vector<ST> stream(unsigned int len, Push push, Pull pull) {
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> piece(0, 3000);
+  std::vector<ST> in(len), out, pbuf(3001);
+  for(int i = 0; i < len; i++) in[i] = sample<ST>(i);
+
+  unsigned int in_pos = 0;
+  while(in_pos < len) {
+    unsigned int n = std::min(len - in_pos, (unsigned int) piece(rng));
+    if(push(in.data() + in_pos, n) != n) {
+      std::cout << "push didn't take all its input\n";
+    }
+    in_pos += n;
+    auto m = pull(pbuf.data(), piece(rng));
+    out.insert(out.end(), pbuf.begin(), pbuf.begin() + m);
+  }
+  // drain whatever is left
+  unsigned int m; 
+  while((m = pull(pbuf.data(), pbuf.size())) != 0) {
+    out.insert(out.end(), pbuf.begin(), pbuf.begin() + m);
+  }
+  return out;
+}
+
+// run the stream through apply, one block at a time
+template<typename ST, typename Apply>
+static std::vector<ST> blocks(unsigned int len, unsigned int in_size, unsigned int out_size, Apply apply) {
+  std::vector<ST> out, ibuf(in_size), obuf(out_size);
+  for(unsigned int b = 0; (b + 1) * in_size <= len; b++) {
+    for(int i = 0; i < in_size; i++) ibuf[i] = sample<ST>(b * in_size + i);
+    apply(ibuf, obuf);
+    out.insert(out.end(), obuf.begin(), obuf.end());
+  }
+  return out; 
+}
+
+template<typename ST>
+static bool compare(const std::string & what, const std::vector<ST> & s, const std::vector<ST> & b, unsigned int expected) {
+  if(b.size() != expected) {
+    std::cout << SoDa::Format("%0: apply made %1 samples, expected %2\n")
+      .addS(what).addI(b.size()).addI(expected);
+    return false; 
+  }
+  if(s.size() != b.size()) {
+    std::cout << SoDa::Format("%0: push/pull made %1 samples, apply made %2\n")
+      .addS(what).addI(s.size()).addI(b.size());
+    return false; 
+  }
+  for(int i = 0; i < s.size(); i++) {
+    if(s[i] != b[i]) {
+      std::cout << SoDa::Format("%0: push/pull and apply differ at sample %1\n")
+	.addS(what).addI(i);
+      return false; 
+    }
+  }
+  return true; 
+}
+
+template<typename ST>
+static bool checkOSFilter(const std::string & what, float gain) {
+  unsigned int buffer_size = 1000;
+  unsigned int len = 23456; 
+  auto fs = SoDa::OSFilter::make(-4000.0, 4000.0, 1000.0, 48000.0, buffer_size, 60.0);
+  auto fb = SoDa::OSFilter::make(-4000.0, 4000.0, 1000.0, 48000.0, buffer_size, 60.0);
+
+  auto s = stream<ST>(len, 
+		      [&](const ST * in, unsigned int n) { return fs->push(in, n); },
+		      [&](ST * out, unsigned int n) { return fs->pull(out, n, gain); });
+  auto b = blocks<ST>(len, buffer_size, buffer_size, 
+		      [&](std::vector<ST> & in, std::vector<ST> & out) { fb->apply(in, out, gain); });
+  return compare(what, s, b, (len / buffer_size) * buffer_size);
+}
+
+template<typename ST>
+static bool checkReSampler(const std::string & what, float in_rate, float out_rate) {
+  unsigned int len = 50000;
+  SoDa::ReSampler rs(in_rate, out_rate, 0.05);
+  SoDa::ReSampler rb(in_rate, out_rate, 0.05);
+  auto in_size = rb.getInputBufferSize();
+  auto out_size = rb.getOutputBufferSize();
+  
+  auto s = stream<ST>(len, 
+		      [&](const ST * in, unsigned int n) { return rs.push(in, n); },
+		      [&](ST * out, unsigned int n) { return rs.pull(out, n); });
+  auto b = blocks<ST>(len, in_size, out_size,
+		      [&](std::vector<ST> & in, std::vector<ST> & out) { rb.apply(in, out); });
+  return compare(what, s, b, (len / in_size) * out_size);
+}
+
+// apply and push share the overlap ring, so they can take turns at
+// block boundaries, but not in the middle of a block. 
+static bool checkMixed() {
+  bool ok = true; 
+  unsigned int buffer_size = 1000;
+  auto fm = SoDa::OSFilter::make(-4000.0, 4000.0, 1000.0, 48000.0, buffer_size, 60.0);
+  auto fb = SoDa::OSFilter::make(-4000.0, 4000.0, 1000.0, 48000.0, buffer_size, 60.0);
+
+  std::vector<std::complex<float>> in(buffer_size), out_m(buffer_size), out_b(buffer_size);
+  for(int blk = 0; blk < 7; blk++) {
+    for(int i = 0; i < buffer_size; i++) in[i] = sample<std::complex<float>>(blk * buffer_size + i);
+    if(blk & 1) {
+      fm->push(in.data(), 300);
+      fm->push(in.data() + 300, buffer_size - 300);
+      if(fm->pull(out_m.data(), buffer_size) != buffer_size) {
+	std::cout << SoDa::Format("Mixed stream: pull came up short in block %0\n").addI(blk);
+	ok = false; 
+      }
+    }
+    else {
+      fm->apply(in, out_m);
+    }
+    fb->apply(in, out_b);
+    if(out_m != out_b) {
+      std::cout << SoDa::Format("Mixed stream: wrong output in block %0\n").addI(blk);
+      ok = false; 
+    }
+  }
+
+  fm->push(in.data(), 10);
+  try {
+    fm->apply(in, out_m);
+    std::cout << "apply after a partial push didn't throw\n";
+    ok = false; 
+  }
+  catch (SoDa::OSFilter::BadBufferSize & e) {
+    // that's what we wanted. 
+  }
+  return ok; 
+}
+
+// the resampler has the same rule: apply after a partial push is an error
+template<typename ST>
+static bool checkReSamplerPartial(const std::string & what) {
+  SoDa::ReSampler rs(48000.0, 8000.0, 0.05);
+  std::vector<ST> in(rs.getInputBufferSize()), out(rs.getOutputBufferSize());
+  for(int i = 0; i < in.size(); i++) in[i] = sample<ST>(i);
+
+  rs.push(in.data(), 10);
+  try {
+    rs.apply(in, out);
+    std::cout << SoDa::Format("%0: apply after a partial push didn't throw\n").addS(what);
+    return false; 
+  }
+  catch (SoDa::ReSampler::BadBufferSize & e) {
+    // that's what we wanted. 
+  }
+  return true; 
+}
+
+int main() {
+  bool passed = true;
+
+  passed = checkOSFilter<std::complex<float>>("OSFilter complex float", 1.0) && passed;
+  passed = checkOSFilter<float>("OSFilter float", 2.0) && passed;
+  passed = checkOSFilter<std::complex<double>>("OSFilter complex double", 0.5) && passed;
+  passed = checkOSFilter<double>("OSFilter double", 1.0) && passed;
+
+  passed = checkReSampler<std::complex<float>>("ReSampler complex float down", 48000.0, 8000.0) && passed;
+  passed = checkReSampler<std::complex<float>>("ReSampler complex float up", 8000.0, 48000.0) && passed;
+  passed = checkReSampler<float>("ReSampler float", 48000.0, 44100.0) && passed;
+  passed = checkReSampler<std::complex<double>>("ReSampler complex double", 48000.0, 8000.0) && passed;
+  passed = checkReSampler<double>("ReSampler double", 8000.0, 48000.0) && passed;
+
+  passed = checkMixed() && passed;
+  passed = checkReSamplerPartial<std::complex<float>>("ReSampler complex float") && passed;
+  passed = checkReSamplerPartial<double>("ReSampler double") && passed;
+
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+  return 0; 
+}
@@ -0,0 +1,197 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/ToneBank.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cmath>
+
+// Check the Goertzel and sliding DFT tone banks against a direct
+// evaluation of the DFT at each tone frequency.
+
+static std::vector<std::complex<double>> directDFT(const std::vector<std::complex<double>> & x,
+						   unsigned int start, unsigned int N,
+						   double fs, const std::vector<float> & freqs) {
+  std::vector<std::complex<double>> ret;
+  for(auto f : freqs) {
+    double w = 2.0 * M_PI * f / fs;
+    std::complex<double> acc(0.0, 0.0);
+    for(unsigned int m = 0; m < N; m++) {
+      acc += x[start + m] * std::polar(1.0, -w * m);
+    }
+    ret.push_back(acc);
+  }
+  return ret; 
+}
+
+static bool compare(const std::string & what, 
+		    const std::vector<std::complex<float>> & got,
+		    const std::vector<std::complex<double>> & ref,
+		    unsigned int N) {
+  double err = 0.0;
+  for(int i = 0; i < ref.size(); i++) {
+    err = std::max(err, std::abs(std::complex<double>(got[i]) - ref[i]));
+  }
+  // relative to the largest possible bin value
+  if((err / N) > 1e-5) {
+    std::cout << SoDa::Format("%0 differs from direct DFT by %1\n")
+      .addS(what).addF(err / N, 'e');
+    return false; 
+  }
+  return true; 
+}
+
+template<typename ST>
+bool checkBank(bool is_real, SoDa::ToneBank::Method method) {
+  double fs = 48000.0;
+  unsigned int N = 500;
+  unsigned int len = 4 * N + 137;
+  // on-bin, off-bin, DC, and (for complex input) negative frequencies
+  std::vector<float> freqs = { 960.0, 1234.5, 0.0, 12000.0, 23000.0 };
+  if(!is_real) {
+    freqs.push_back(-5432.1);
+    freqs.push_back(-24000.0);
+  }
+
+  std::vector<ST> in(len);
+  std::vector<std::complex<double>> x(len);
+  for(int i = 0; i < len; i++) {
+    double a = cos(2.0 * M_PI * 1234.5 * i / fs) + 0.25 * sin(0.0321 * i * i / len) + 0.1;
+    double b = is_real ? 0.0 : sin(2.0 * M_PI * -5432.1 * i / fs) - 0.05;
+    x[i] = std::complex<double>(a, b);
+    if constexpr (std::is_same<ST, float>::value) in[i] = a;
+    else in[i] = ST(a, b);
+  }
+
+  std::string name = SoDa::Format("%0 %1")
+    .addS(method == SoDa::ToneBank::GOERTZEL ? "Goertzel" : "Sliding DFT")
+    .addS(is_real ? "real" : "complex").str();
+  
+  auto bank = SoDa::ToneBank::make(fs, freqs, N, method);
+  std::vector<std::complex<float>> got;
+  bool ok = true;
+
+  if(method == SoDa::ToneBank::GOERTZEL) {
+    // feed it in odd sized chunks, and check after each block.
+    unsigned int chunk = 77;
+    unsigned int blocks = 0; 
+    for(unsigned int i = 0; i < len; i += chunk) {
+      unsigned int l = std::min(chunk, len - i);
+      unsigned int before = (i / N);
+      blocks += bank->apply(in.data() + i, l);
+      if(blocks != (i + l) / N) {
+	std::cout << SoDa::Format("%0 reported %1 blocks after %2 samples\n")
+	  .addS(name).addI(blocks).addI(i + l);
+	ok = false; 
+      }
+      if(blocks > before) {
+	bank->get(got);
+	ok = compare(name, got, directDFT(x, (blocks - 1) * N, N, fs, freqs), N) && ok;
+      }
+    }
+  }
+  else {
+    // one sample at a time, so we can check every window
+    unsigned int updates = 0; 
+    for(unsigned int i = 0; i < len; i++) {
+      updates += bank->apply(in.data() + i, 1);
+      if((i + 1) >= N) {
+	bank->get(got);
+	ok = compare(name, got, directDFT(x, i + 1 - N, N, fs, freqs), N) && ok;
+	if(!ok) break; 
+      }
+    }
+    if(updates != len - N + 1) {
+      std::cout << SoDa::Format("%0 reported %1 updates, expected %2\n")
+	.addS(name).addI(updates).addI(len - N + 1);
+      ok = false;       
+    }
+  }
+
+  // clear should zero everything
+  bank->clear();
+  bank->get(got);
+  for(auto & v : got) {
+    if(v != std::complex<float>(0.0, 0.0)) {
+      std::cout << name << " clear didn't zero the tones\n";
+      ok = false;
+      break; 
+    }
+  }
+  
+  return ok; 
+}
+
+bool checkMagnitude() {
+  // a unit amplitude exponential on a bin center reads 1.0
+  double fs = 8000.0;
+  unsigned int N = 256; 
+  float f = fs * 10 / N; 
+  std::vector<std::complex<float>> in(N);
+  for(int i = 0; i < N; i++) {
+    in[i] = std::polar(1.0f, float(2.0 * M_PI * f * i / fs));
+  }
+  SoDa::ToneBank bank(fs, { f, float(fs * 20 / N) }, N);
+  bank.apply(in);
+  std::vector<float> mag;
+  bank.getMagnitude(mag);
+  if((fabs(mag[0] - 1.0) > 1e-4) || (mag[1] > 1e-4)) {
+    std::cout << SoDa::Format("getMagnitude returned %0 and %1, expected 1 and 0\n")
+      .addF(mag[0]).addF(mag[1]);
+    return false; 
+  }
+  return true; 
+}
+
+bool checkBadFrequency() {
+  try {
+    SoDa::ToneBank bank(48000.0, { 1000.0, 25000.0 }, 128);
+  }
+  catch (SoDa::ToneBank::BadFrequency & e) {
+    return true; 
+  }
+  std::cout << "Out of bounds frequency wasn't caught\n";
+  return false; 
+}
+
+int main() {
+  bool passed = true;
+  for(auto method : { SoDa::ToneBank::GOERTZEL, SoDa::ToneBank::SLIDING_DFT }) {
+    passed = checkBank<std::complex<float>>(false, method) && passed;
+    passed = checkBank<float>(true, method) && passed;
+  }
+  passed = checkMagnitude() && passed;
+  passed = checkBadFrequency() && passed;
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}
@@ -0,0 +1,194 @@
+/*
+ *  BSD 2-Clause License
+ *  
+ *  Copyright (c) 2025, kb1vc
+ *  All rights reserved.
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/VectorKernels.hxx"
+#include "../include/Filter.hxx"
+#include <iostream>
+#include <Utils/include/Format.hxx>
+#include <cstring>
+#include <random>
+
+// Every SIMD kernel must produce exactly the same bits as the scalar
+// kernel, for any length and any alignment.  And the scalar kernel
+// must actually compute the product. 
+
+typedef SoDa::VectorKernels VK; 
+
+template<typename T>
+static void fill(std::vector<std::complex<T>> & v, std::mt19937 & gen) {
+  std::uniform_real_distribution<T> dist(-4.0, 4.0);
+  for(auto & e : v) {
+    e = std::complex<T>(dist(gen), dist(gen));
+  }
+  // a few awkward ones
+  if(v.size() > 4) {
+    v[1] = std::complex<T>(1e-30, -0.0);
+    v[3] = std::complex<T>(-0.0, 3e20);
+  }
+}
+
+template<typename T>
+static bool same(const std::vector<std::complex<T>> & a, const std::vector<std::complex<T>> & b) {
+  return (a.size() == b.size()) && (memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+}
+
+// run every kernel on the current ISA. The offset knocks the
+// buffers off of any natural alignment.
+template<typename T>
+static void runAll(const std::vector<std::complex<T>> & a, 
+		   const std::vector<std::complex<T>> & b, 
+		   unsigned int off, unsigned int len, 
+		   std::vector<std::vector<std::complex<T>>> & res) {
+  res.assign(8, a);
+  VK::mul(a.data() + off, b.data() + off, res[0].data() + off, len);
+  VK::mulConj(a.data() + off, b.data() + off, res[1].data() + off, len);
+  res[2] = b; 
+  VK::mulAcc(a.data() + off, b.data() + off, res[2].data() + off, len);
+  VK::scale(a.data() + off, T(0.3), res[3].data() + off, len);
+  VK::scale(reinterpret_cast<const T*>(a.data()) + off, T(-1.7), 
+	    reinterpret_cast<T*>(res[4].data()) + off, len);
+  // in place
+  VK::mul(res[5].data() + off, b.data() + off, res[5].data() + off, len);
+  // multiply by a single value and accumulate
+  res[6] = b;
+  VK::mulAcc(a.data() + off, b[0], res[6].data() + off, len);
+  res[7] = b;
+  VK::mulAcc(reinterpret_cast<const T*>(a.data()) + off, T(0.7), 
+	     reinterpret_cast<T*>(res[7].data()) + off, len);
+}
+
+template<typename T>
+bool checkISA(VK::ISA isa, std::mt19937 & gen) {
+  static const char * names[] = { "mul", "mulConj", "mulAcc", "scale complex", "scale real", "mul in place",
+				  "mulAcc complex scalar", "mulAcc real scalar" };
+  bool ok = true;
+  for(unsigned int len : { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 1000, 1023 }) {
+    for(unsigned int off : { 0, 1, 3 }) {
+      std::vector<std::complex<T>> a(len + 8), b(len + 8); 
+      fill(a, gen);
+      fill(b, gen);
+      std::vector<std::vector<std::complex<T>>> ref, got; 
+      VK::setISA(VK::SCALAR);
+      runAll(a, b, off, len, ref);
+      VK::setISA(isa);
+      runAll(a, b, off, len, got);
+      for(int i = 0; i < ref.size(); i++) {
+	if(!same(ref[i], got[i])) {
+	  std::cout << SoDa::Format("%0 %1 doesn't match scalar for length %2 offset %3 (%4)\n")
+	    .addS(VK::getISAName(isa)).addS(names[i]).addI(len).addI(off)
+	    .addS(sizeof(T) == 4 ? "float" : "double");
+	  ok = false; 
+	}
+      }
+    }
+  }
+  return ok; 
+}
+
+template<typename T>
+bool checkScalar(std::mt19937 & gen) {
+  // the scalar kernels against std::complex arithmetic
+  VK::setISA(VK::SCALAR);
+  unsigned int len = 100;
+  std::vector<std::complex<T>> a(len), b(len), o(len), acc(len);
+  fill(a, gen);
+  fill(b, gen);
+  bool ok = true;
+  auto check = [&](const std::string & what, auto f) {
+    for(int i = 0; i < len; i++) {
+      auto e = f(i);
+      if(std::abs(o[i] - e) > 1e-5 * std::max(T(1.0), std::abs(e))) {
+	std::cout << "scalar " << what << " is wrong at " << i << "\n";
+	ok = false; 
+	return; 
+      }
+    }
+  };
+  VK::mul(a.data(), b.data(), o.data(), len);
+  check("mul", [&](int i) { return a[i] * b[i]; });
+  VK::mulConj(a.data(), b.data(), o.data(), len);
+  check("mulConj", [&](int i) { return a[i] * std::conj(b[i]); });
+  acc = a; 
+  o = a; 
+  VK::mulAcc(a.data(), b.data(), o.data(), len);
+  check("mulAcc", [&](int i) { return acc[i] + a[i] * b[i]; });
+  o = a; 
+  VK::mulAcc(a.data(), b[0], o.data(), len);
+  check("mulAcc scalar", [&](int i) { return acc[i] + a[i] * b[0]; });
+  VK::scale(a.data(), T(2.5), o.data(), len);
+  check("scale", [&](int i) { return a[i] * T(2.5); });
+  return ok; 
+}
+
+bool checkFilter(VK::ISA isa) {
+  // The filter output doesn't depend on the ISA at all.
+  SoDa::FilterSpec spec(48000.0, 127);
+  spec.add(-1000.0, 0.0).add(-500.0, 1.0).add(3000.0, 1.0).add(4000.0, 0.0);
+  SoDa::Filter filt(spec, 1024);
+  std::mt19937 gen(17);
+  std::vector<std::complex<float>> in(1024), ref(1024), got(1024);
+  fill(in, gen);
+  VK::setISA(VK::SCALAR);
+  filt.apply(in, ref);
+  VK::setISA(isa);
+  filt.apply(in, got);
+  if(!same(ref, got)) {
+    std::cout << VK::getISAName(isa) << " Filter::apply doesn't match scalar\n";
+    return false; 
+  }
+  return true; 
+}
+
+int main() {
+  bool passed = true;
+  std::mt19937 gen(1234);
+  auto best = VK::getISA();
+  std::cout << "# kernels use " << VK::getISAName(best) << "\n";
+
+  passed = checkScalar<float>(gen) && passed;
+  passed = checkScalar<double>(gen) && passed;
+
+  for(auto isa : { VK::SSE2, VK::AVX2, VK::AVX512 }) {
+    if(!VK::isSupported(isa)) {
+      std::cout << "# " << VK::getISAName(isa) << " not supported here, skipping\n";
+      continue; 
+    }
+    passed = checkISA<float>(isa, gen) && passed;
+    passed = checkISA<double>(isa, gen) && passed;
+    passed = checkFilter(isa) && passed;
+  }
+
+  VK::setISA(best);
+  
+  if(passed) {
+    std::cout << "PASSED\n";
+  }
+  else {
+    std::cout << "FAILED\n";
+  }
+}